@@ -0,0 +1,145 @@
+// 压缩算法基准测试：按实际的消息形状比较各压缩算法的压缩率和编解码开销
+// 用法：compress_bench [每种组合的迭代次数，默认20000]
+// 只测试编码/解码本身（ZrpcCodec），不经过网络，不需要启动服务端和ZooKeeper
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <memory>
+#include "user.pb.h"
+#include "ZrpcCodec.h"
+#include "ZrpcCompression.h"
+
+namespace {
+
+// 生成一份JSON格式的用户资料，fields控制字段数量（即消息大小）
+// 内容按固定种子随机生成：键名重复、取值各不相同，接近线上缓存值的可压缩程度
+std::string MakeProfileJson(uint32_t user_id, int fields, std::mt19937 &rng) {
+    static const char *kTags[] = {"music", "sports", "travel", "reading", "games", "movies", "food", "tech"};
+    static const char *kCities[] = {"Beijing", "Shanghai", "Shenzhen", "Hangzhou", "Chengdu", "Wuhan"};
+    std::uniform_int_distribution<int> dist(0, 1 << 20);
+
+    std::string json = "{\"id\":" + std::to_string(user_id) +
+                       ",\"name\":\"User" + std::to_string(user_id) +
+                       "\",\"age\":" + std::to_string(18 + dist(rng) % 50) +
+                       ",\"email\":\"user" + std::to_string(user_id) + "@example.com\",\"history\":[";
+    for (int i = 0; i < fields; ++i) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"order_id\":" + std::to_string(dist(rng)) +
+                ",\"city\":\"" + kCities[dist(rng) % 6] +
+                "\",\"tag\":\"" + kTags[dist(rng) % 8] +
+                "\",\"amount\":" + std::to_string(dist(rng) % 100000) +
+                ",\"status\":\"" + (dist(rng) % 4 == 0 ? "refunded" : "completed") + "\"}";
+    }
+    json += "]}";
+    return json;
+}
+
+struct Shape
+{
+    std::string name;
+    std::unique_ptr<google::protobuf::Message> message;
+};
+
+struct Result
+{
+    size_t wire_bytes = 0;
+    double encode_us = 0;
+    double decode_us = 0;
+};
+
+// 编码iterations次再解码iterations次，返回单次的平均耗时和编码后的帧长
+Result Run(const google::protobuf::Message &message, Zrpc::CompressType type, int iterations) {
+    ZrpcCompressPolicy policy;
+    policy.type = type;
+    policy.min_bytes = 0;  // 基准测试中每个消息都压缩
+    const ZrpcCompressPolicy *compress = type == Zrpc::COMPRESS_NONE ? nullptr : &policy;
+
+    Result result;
+    std::string frame;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        frame.clear();
+        ZrpcCodec::EncodeRequest("CacheServiceRpc", "Set", i, message, &frame, 3000, compress);
+    }
+    auto encoded = std::chrono::steady_clock::now();
+    result.wire_bytes = frame.size();
+
+    std::unique_ptr<google::protobuf::Message> parsed(message.New());
+    for (int i = 0; i < iterations; ++i) {
+        Zrpc::RpcHeader header;
+        const char *body = nullptr;
+        if (ZrpcCodec::DecodeRequest(frame.data(), frame.size(), &header, &body) <= 0 ||
+            !ZrpcCodec::ParseBody(header.compress_type(), body, header.args_size(), parsed.get())) {
+            std::cerr << "decode error: " << ZrpcCompression::Name(type) << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    auto decoded = std::chrono::steady_clock::now();
+
+    result.encode_us = std::chrono::duration<double, std::micro>(encoded - start).count() / iterations;
+    result.decode_us = std::chrono::duration<double, std::micro>(decoded - encoded).count() / iterations;
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    if (iterations <= 0) {
+        iterations = 20000;
+    }
+
+    // 线上的主要消息形状：写缓存的CacheSetRequest（value为用户资料JSON）和GetUserProfileResponse，按资料大小分档
+    std::mt19937 rng(20240601);
+    std::vector<Shape> shapes;
+    for (int fields : {2, 8, 32, 128}) {
+        std::string profile = MakeProfileJson(1000 + fields, fields, rng);
+
+        auto set_request = std::make_unique<Kuser::CacheSetRequest>();
+        set_request->set_key("profile:" + std::to_string(1000 + fields));
+        set_request->set_value(profile);
+        set_request->set_expire_seconds(600);
+        shapes.push_back({"CacheSetRequest/" + std::to_string(profile.size()) + "B", std::move(set_request)});
+
+        auto profile_response = std::make_unique<Kuser::GetUserProfileResponse>();
+        profile_response->mutable_result()->set_errcode(0);
+        profile_response->set_profile_data(profile);
+        profile_response->set_from_cache(true);
+        shapes.push_back({"GetUserProfileResponse/" + std::to_string(profile.size()) + "B", std::move(profile_response)});
+    }
+
+    std::vector<Zrpc::CompressType> types = {Zrpc::COMPRESS_NONE};
+    for (Zrpc::CompressType type : {Zrpc::COMPRESS_LZ4, Zrpc::COMPRESS_ZSTD, Zrpc::COMPRESS_SNAPPY}) {
+        if (ZrpcCompression::IsSupported(type)) {
+            types.push_back(type);
+        } else {
+            std::cout << ZrpcCompression::Name(type) << ": not compiled in, skipped" << std::endl;
+        }
+    }
+
+    std::cout << "iterations per case: " << iterations << std::endl;
+    std::cout << std::left << std::setw(32) << "message" << std::setw(8) << "codec"
+              << std::right << std::setw(12) << "wire bytes" << std::setw(8) << "ratio"
+              << std::setw(14) << "encode us/op" << std::setw(14) << "decode us/op" << std::endl;
+    for (const Shape &shape : shapes) {
+        size_t raw_bytes = 0;
+        for (Zrpc::CompressType type : types) {
+            Result result = Run(*shape.message, type, iterations);
+            if (type == Zrpc::COMPRESS_NONE) {
+                raw_bytes = result.wire_bytes;
+            }
+            std::cout << std::left << std::setw(32) << shape.name << std::setw(8) << ZrpcCompression::Name(type)
+                      << std::right << std::setw(12) << result.wire_bytes
+                      << std::setw(8) << std::fixed << std::setprecision(2) << static_cast<double>(result.wire_bytes) / raw_bytes
+                      << std::setw(14) << std::setprecision(3) << result.encode_us
+                      << std::setw(14) << result.decode_us << std::endl;
+        }
+    }
+    return 0;
+}
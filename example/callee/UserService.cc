@@ -18,6 +18,7 @@ void UserService::InitializeCacheClient() {
     try {
         // 创建缓存服务的内部客户端连接
         cache_channel_ = std::make_unique<ZrpcChannel>(false);
+        cache_channel_->SetCompression(Zrpc::COMPRESS_LZ4, 1024, "Set");  // 用户资料是JSON，写入缓存时压缩
         cache_stub_ = std::make_unique<Kuser::CacheServiceRpc_Stub>(cache_channel_.get());
         cache_enabled_ = true;
         
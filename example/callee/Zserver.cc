@@ -24,6 +24,15 @@ int main(int argc, char **argv) {
     std::cout << "Registering UserService with integrated cache..." << std::endl;
     provider.NotifyService(new UserService());
 
+    // JSON格式的用户资料和缓存值压缩效果好，较大时压缩后再返回，节省机架之间的带宽
+    provider.SetCompression(Zrpc::COMPRESS_LZ4, 1024, "UserServiceRpc.GetUserProfile");
+    provider.SetCompression(Zrpc::COMPRESS_LZ4, 1024, "CacheServiceRpc.Get");
+    provider.SetCompression(Zrpc::COMPRESS_LZ4, 1024, "CacheServiceRpc.BatchGet");
+
+    // 登录优先处理，统计类的后台调用再多也不会推高登录的延迟
+    provider.SetMethodPriority("UserServiceRpc.Login", Zrpc::PRIORITY_CRITICAL);
+    provider.SetMethodPriority("CacheServiceRpc.GetStats", Zrpc::PRIORITY_BACKGROUND);
+
     std::cout << "RPC服务启动成功，提供以下服务:" << std::endl;
     std::cout << "- UserService: Login, Register, SumtoN, GetUserProfile (带自动缓存)" << std::endl;
     std::cout << "- CacheService: Set, Get, Delete, Exists, BatchGet, GetStats" << std::endl;
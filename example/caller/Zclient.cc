@@ -1,6 +1,7 @@
 #include "Zrpcapplication.h"
 #include "../user.pb.h"
 #include "Zrpccontroller.h"
+#include "ZrpcFuture.h"
 #include <iostream>
 #include <atomic>
 #include <thread>
@@ -93,6 +94,7 @@ void test_cache_service(int thread_id, std::atomic<int> &success_count, std::ato
     Kuser::ResultCode set_response;
     Zrpccontroller set_controller;
     set_controller.SetTimeout(5000);
+    set_controller.SetHashKey(set_request.key());  // 相同key总是路由到同一个缓存节点
     
     cache_stub.Set(&set_controller, &set_request, &set_response, nullptr);
     
@@ -111,6 +113,7 @@ void test_cache_service(int thread_id, std::atomic<int> &success_count, std::ato
     Kuser::CacheGetResponse get_response;
     Zrpccontroller get_controller;
     get_controller.SetTimeout(5000);
+    get_controller.SetHashKey(get_request.key());  // 相同key总是路由到同一个缓存节点
     
     cache_stub.Get(&get_controller, &get_request, &get_response, nullptr);
     
@@ -134,6 +137,7 @@ void test_cache_service(int thread_id, std::atomic<int> &success_count, std::ato
     Kuser::CacheExistsResponse exists_response;
     Zrpccontroller exists_controller;
     exists_controller.SetTimeout(5000);
+    exists_controller.SetHashKey(exists_request.key());  // 相同key总是路由到同一个缓存节点
     
     cache_stub.Exists(&exists_controller, &exists_request, &exists_response, nullptr);
     
@@ -155,113 +159,121 @@ void test_integrated_business(int thread_id, std::atomic<int> &success_count, st
     // 创建用户服务和缓存服务客户端
     ZrpcChannel* user_channel = new ZrpcChannel(false);
     user_channel->EnableHeartbeat(true);
+    user_channel->EnableOverloadProtection();  // 用户服务变慢或故障时限制并发、快速失败，不让调用线程都阻塞在它上面
     Kuser::UserServiceRpc_Stub user_stub(user_channel);
     
     ZrpcChannel* cache_channel = new ZrpcChannel(false);
     cache_channel->EnableHeartbeat(true);
+    cache_channel->EnableBatching();  // 缓存请求小而多，同时发往同一实例的请求合并为一个批量帧
+    cache_channel->SetCompression(Zrpc::COMPRESS_LZ4, 1024, "Set");  // 较大的JSON缓存值压缩后再发送
     Kuser::CacheServiceRpc_Stub cache_stub(cache_channel);
     
     std::string username = "user_" + std::to_string(thread_id);
     std::string session_key = "session:" + username;
-    
-    // 1. 首先检查会话缓存
+    uint32_t user_id = 1000 + thread_id;
+    std::string profile_key = "profile:" + std::to_string(user_id);
+
+    // 1. 会话检查、用户登录、用户资料缓存查询互不依赖，同时发出，端到端延迟取决于最慢的一个而不是三者之和
     Kuser::CacheExistsRequest exists_request;
     exists_request.set_key(session_key);
-    
     Kuser::CacheExistsResponse exists_response;
     Zrpccontroller exists_controller;
     exists_controller.SetTimeout(3000);
-    
-    cache_stub.Exists(&exists_controller, &exists_request, &exists_response, nullptr);
-    
-    if (!exists_controller.Failed() && exists_response.exists()) {
-        // 会话存在，直接使用缓存
-        LOG(INFO) << "Thread " << thread_id << " found cached session for " << username;
-        success_count++;
-    } else {
-        // 2. 会话不存在，进行用户登录
-        Kuser::LoginRequest login_request;
-        login_request.set_name(username);
-        login_request.set_pwd("password123");
-        
-        Kuser::LoginResponse login_response;
-        Zrpccontroller login_controller;
-        login_controller.SetTimeout(5000);
-        
-        user_stub.Login(&login_controller, &login_request, &login_response, nullptr);
-        
-        if (!login_controller.Failed() && login_response.success()) {
-            // 3. 登录成功，创建会话缓存
-            std::string session_token = "token_" + username + "_" + std::to_string(time(nullptr));
-            
-            Kuser::CacheSetRequest set_request;
-            set_request.set_key(session_key);
-            set_request.set_value(session_token);
-            set_request.set_expire_seconds(1800);  // 30分钟过期
-            
-            Kuser::ResultCode set_response;
-            Zrpccontroller set_controller;
-            set_controller.SetTimeout(3000);
-            
-            cache_stub.Set(&set_controller, &set_request, &set_response, nullptr);
-            
-            if (!set_controller.Failed()) {
-                LOG(INFO) << "Thread " << thread_id << " login success and session cached for " << username;
-                success_count += 2;  // 登录成功 + 缓存成功
-            } else {
-                LOG(ERROR) << "Thread " << thread_id << " failed to cache session: " << set_controller.ErrorText();
-                success_count++;  // 只有登录成功
-                fail_count++;
-            }
-        } else {
-            LOG(ERROR) << "Thread " << thread_id << " login failed for " << username;
-            fail_count++;
-        }
-    }
-    
-    // 4. 测试用户资料缓存场景 - 使用真实的用户服务
-    uint32_t user_id = 1000 + thread_id;
-    std::string profile_key = "profile:" + std::to_string(user_id);
-    
-    // 检查用户资料是否在缓存中
+    exists_controller.SetHashKey(exists_request.key());
+
+    Kuser::LoginRequest login_request;
+    login_request.set_name(username);
+    login_request.set_pwd("password123");
+    Kuser::LoginResponse login_response;
+    Zrpccontroller login_controller;
+    login_controller.SetTimeout(5000);
+
     Kuser::CacheGetRequest profile_get_request;
     profile_get_request.set_key(profile_key);
-    
     Kuser::CacheGetResponse profile_get_response;
     Zrpccontroller profile_get_controller;
     profile_get_controller.SetTimeout(3000);
-    
-    cache_stub.Get(&profile_get_controller, &profile_get_request, &profile_get_response, nullptr);
-    
-    if (!profile_get_controller.Failed() && profile_get_response.exists()) {
+    profile_get_controller.SetHashKey(profile_get_request.key());
+
+    WhenAll<bool>({
+        ZrpcCallAsync(cache_stub, &Kuser::CacheServiceRpc_Stub::Exists, &exists_controller, &exists_request, &exists_response),
+        ZrpcCallAsync(user_stub, &Kuser::UserServiceRpc_Stub::Login, &login_controller, &login_request, &login_response),
+        ZrpcCallAsync(cache_stub, &Kuser::CacheServiceRpc_Stub::Get, &profile_get_controller, &profile_get_request, &profile_get_response),
+    }).Get();
+
+    bool session_cached = !exists_controller.Failed() && exists_response.exists();
+    bool login_ok = !login_controller.Failed() && login_response.success();
+    bool profile_cached = !profile_get_controller.Failed() && profile_get_response.exists();
+
+    // 2. 依赖第一步结果的调用：缓存会话、查询用户资料，两者之间同样互不依赖
+    std::vector<ZrpcFuture<bool>> second_stage;
+
+    Kuser::CacheSetRequest set_request;
+    Kuser::ResultCode set_response;
+    Zrpccontroller set_controller;
+    if (session_cached) {
+        // 会话存在，直接使用缓存
+        LOG(INFO) << "Thread " << thread_id << " found cached session for " << username;
+        success_count++;
+    } else if (login_ok) {
+        // 登录成功，创建会话缓存
+        std::string session_token = "token_" + username + "_" + std::to_string(time(nullptr));
+        set_request.set_key(session_key);
+        set_request.set_value(session_token);
+        set_request.set_expire_seconds(1800);  // 30分钟过期
+        set_controller.SetTimeout(3000);
+        set_controller.SetHashKey(set_request.key());
+        second_stage.push_back(
+            ZrpcCallAsync(cache_stub, &Kuser::CacheServiceRpc_Stub::Set, &set_controller, &set_request, &set_response));
+    } else {
+        LOG(ERROR) << "Thread " << thread_id << " login failed for " << username;
+        fail_count++;
+    }
+
+    Kuser::GetUserProfileRequest user_profile_request;
+    Kuser::GetUserProfileResponse user_profile_response;
+    Zrpccontroller user_profile_controller;
+    if (profile_cached) {
         LOG(INFO) << "Thread " << thread_id << " found cached profile for user " << user_id;
         success_count++;
     } else {
         // 缓存中没有，调用用户服务查询
-        Kuser::GetUserProfileRequest user_profile_request;
         user_profile_request.set_user_id(user_id);
-        
-        Kuser::GetUserProfileResponse user_profile_response;
-        Zrpccontroller user_profile_controller;
         user_profile_controller.SetTimeout(5000);
-        
-        user_stub.GetUserProfile(&user_profile_controller, &user_profile_request, &user_profile_response, nullptr);
-        
+        user_profile_controller.SetHedging(true);  // 只读查询是幂等的，慢实例可以由另一个实例的响应兜底
+        second_stage.push_back(ZrpcCallAsync(user_stub, &Kuser::UserServiceRpc_Stub::GetUserProfile,
+                                             &user_profile_controller, &user_profile_request, &user_profile_response));
+    }
+    WhenAll(second_stage).Get();
+
+    if (!session_cached && login_ok) {
+        if (!set_controller.Failed()) {
+            LOG(INFO) << "Thread " << thread_id << " login success and session cached for " << username;
+            success_count += 2;  // 登录成功 + 缓存成功
+        } else {
+            LOG(ERROR) << "Thread " << thread_id << " failed to cache session: " << set_controller.ErrorText();
+            success_count++;  // 只有登录成功
+            fail_count++;
+        }
+    }
+
+    // 3. 查询成功，缓存用户资料
+    if (!profile_cached) {
         if (!user_profile_controller.Failed() && user_profile_response.result().errcode() == 0) {
-            // 查询成功，缓存用户资料
             std::string profile_data = user_profile_response.profile_data();
-            
+
             Kuser::CacheSetRequest profile_set_request;
             profile_set_request.set_key(profile_key);
             profile_set_request.set_value(profile_data);
             profile_set_request.set_expire_seconds(600);  // 10分钟过期
-            
+
             Kuser::ResultCode profile_set_response;
             Zrpccontroller profile_set_controller;
             profile_set_controller.SetTimeout(3000);
-            
+            profile_set_controller.SetHashKey(profile_set_request.key());
+
             cache_stub.Set(&profile_set_controller, &profile_set_request, &profile_set_response, nullptr);
-            
+
             if (!profile_set_controller.Failed()) {
                 LOG(INFO) << "Thread " << thread_id << " queried and cached profile for user " << user_id;
                 success_count += 2;  // 查询成功 + 缓存成功
@@ -271,7 +283,7 @@ void test_integrated_business(int thread_id, std::atomic<int> &success_count, st
                 fail_count++;
             }
         } else {
-            LOG(ERROR) << "Thread " << thread_id << " failed to get user profile: " << 
+            LOG(ERROR) << "Thread " << thread_id << " failed to get user profile: " <<
                 (user_profile_controller.Failed() ? user_profile_controller.ErrorText() : user_profile_response.result().errmsg());
             fail_count++;
         }
@@ -310,6 +322,14 @@ int main(int argc, char **argv) {
 
     LOG(INFO) << "Running test mode: " << test_mode;
 
+    // 预热：开始压测前并行完成服务发现并建好连接，第一批请求不再依次等待ZooKeeper查询和建立连接
+    ZrpcChannel prewarm_channel(false);
+    ZrpcPrewarmResult prewarm = prewarm_channel.Prewarm({Kuser::UserServiceRpc::descriptor(),
+                                                         Kuser::CacheServiceRpc::descriptor()});
+    if (!prewarm.ready) {
+        LOG(WARNING) << "prewarm not ready, first calls may be slow";
+    }
+
     auto start_time = std::chrono::high_resolution_clock::now();  // 记录测试开始时间
 
     // 启动多线程进行并发测试
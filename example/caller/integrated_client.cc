@@ -2,6 +2,7 @@
 #include "../user.pb.h"
 #include "Zrpccontroller.h"
 #include "ZrpcLogger.h"
+#include "ZrpcCoroutine.h"
 #include <iostream>
 #include <memory>
 
@@ -108,6 +109,52 @@ public:
         }
     }
     
+#ifdef ZRPC_HAS_COROUTINE
+    // 协程版本的带缓存用户信息查询：三次有依赖的调用串行执行，但等待期间不占用线程
+    ZrpcTask<std::string> GetUserProfileWithCacheAsync(uint32_t user_id) {
+        std::string cache_key = "profile:" + std::to_string(user_id);
+
+        // 1. 先从缓存中查询
+        Kuser::CacheGetRequest get_request;
+        get_request.set_key(cache_key);
+        Zrpccontroller get_controller;
+        get_controller.SetTimeout(3000);
+        get_controller.SetHashKey(cache_key);
+        Kuser::CacheGetResponse get_response =
+            co_await ZrpcCall(*cache_stub_, &Kuser::CacheServiceRpc_Stub::Get, &get_controller, get_request);
+        if (!get_controller.Failed() && get_response.exists()) {
+            LOG(INFO) << "从缓存中获取用户 " << user_id << " 的信息: " << get_response.value();
+            co_return get_response.value();
+        }
+
+        // 2. 缓存未命中，调用用户服务查询
+        Kuser::GetUserProfileRequest request;
+        request.set_user_id(user_id);
+        Zrpccontroller controller;
+        controller.SetTimeout(5000);
+        Kuser::GetUserProfileResponse response =
+            co_await ZrpcCall(*user_stub_, &Kuser::UserServiceRpc_Stub::GetUserProfile, &controller, request);
+        if (controller.Failed() || response.result().errcode() != 0) {
+            LOG(ERROR) << "获取用户资料失败: "
+                       << (controller.Failed() ? controller.ErrorText() : response.result().errmsg());
+            co_return std::string();
+        }
+
+        // 3. 将查询结果缓存起来
+        Kuser::CacheSetRequest set_request;
+        set_request.set_key(cache_key);
+        set_request.set_value(response.profile_data());
+        set_request.set_expire_seconds(600);
+        Zrpccontroller set_controller;
+        set_controller.SetTimeout(3000);
+        set_controller.SetHashKey(cache_key);
+        co_await ZrpcCall(*cache_stub_, &Kuser::CacheServiceRpc_Stub::Set, &set_controller, set_request);
+
+        LOG(INFO) << "从用户服务查询用户 " << user_id << " 信息并已缓存: " << response.profile_data();
+        co_return response.profile_data();
+    }
+#endif
+
     // 用户注册（清理相关缓存）
     bool RegisterWithCacheInvalidation(uint32_t user_id, const std::string& username, const std::string& password) {
         LOG(INFO) << "=== 用户注册（缓存失效） ===";
@@ -255,6 +302,11 @@ int main(int argc, char** argv) {
     client.GetUserProfileWithCache(1001);
     client.GetUserProfileWithCache(1001); // 第二次应该命中缓存
     
+#ifdef ZRPC_HAS_COROUTINE
+    // 协程版本：在主线程上等待协程完成，协程本身在客户端reactor线程上推进
+    ZrpcSyncWait(client.GetUserProfileWithCacheAsync(1003));
+#endif
+
     // 测试场景3：用户注册（缓存失效）
     client.RegisterWithCacheInvalidation(1002, "lisi", "654321");
     
@@ -0,0 +1,68 @@
+#include "ZrpcBuffer.h"
+#include <sys/uio.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+
+ZrpcBuffer::ZrpcBuffer(size_t initial_size)
+    : m_buffer(initial_size), m_reader_index(0), m_writer_index(0) {}
+
+void ZrpcBuffer::Retrieve(size_t len) {
+    if (len < ReadableBytes()) {
+        m_reader_index += len;
+    } else {
+        RetrieveAll();
+    }
+}
+
+void ZrpcBuffer::RetrieveAll() {
+    m_reader_index = 0;
+    m_writer_index = 0;
+}
+
+void ZrpcBuffer::Append(const char *data, size_t len) {
+    EnsureWritable(len);
+    std::copy(data, data + len, BeginWrite());
+    HasWritten(len);
+}
+
+void ZrpcBuffer::EnsureWritable(size_t len) {
+    if (WritableBytes() < len) {
+        MakeSpace(len);
+    }
+}
+
+ssize_t ZrpcBuffer::ReadFd(int fd, int *saved_errno) {
+    char extrabuf[65536];
+    struct iovec vec[2];
+    const size_t writable = WritableBytes();
+    vec[0].iov_base = BeginWrite();
+    vec[0].iov_len = writable;
+    vec[1].iov_base = extrabuf;
+    vec[1].iov_len = sizeof(extrabuf);
+
+    // 缓冲区剩余空间足够大时不再使用临时空间
+    const int iovcnt = (writable < sizeof(extrabuf)) ? 2 : 1;
+    const ssize_t n = readv(fd, vec, iovcnt);
+    if (n < 0) {
+        *saved_errno = errno;
+    } else if (static_cast<size_t>(n) <= writable) {
+        HasWritten(n);
+    } else {
+        m_writer_index = m_buffer.size();
+        Append(extrabuf, n - writable);
+    }
+    return n;
+}
+
+// 先回收已读取的空间，仍不够时再扩容
+void ZrpcBuffer::MakeSpace(size_t len) {
+    if (WritableBytes() + m_reader_index < len) {
+        m_buffer.resize(m_writer_index + len);
+    } else {
+        size_t readable = ReadableBytes();
+        std::copy(m_buffer.data() + m_reader_index, m_buffer.data() + m_writer_index, m_buffer.data());
+        m_reader_index = 0;
+        m_writer_index = readable;
+    }
+}
@@ -0,0 +1,439 @@
+#include "ZrpcClientReactor.h"
+#include "ZrpcMuxConnection.h"
+#include "ZrpcLogger.h"
+#include "Zrpcapplication.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+// io_uring完成事件的user_data：高56位是注册项编号（唤醒为0），低8位是操作类型
+enum UringOp : uint64_t
+{
+    kOpWakeup = 1,
+    kOpRecv = 2,
+    kOpPoll = 3,
+    kOpSend = 4,
+    kOpCancel = 5,
+};
+
+uint64_t MakeUserData(uint64_t token, UringOp op) {
+    return (token << 8) | op;
+}
+
+}  // namespace
+
+ZrpcClientReactor &ZrpcClientReactor::GetInstance() {
+    static ZrpcClientReactor instance;
+    return instance;
+}
+
+ZrpcClientReactor::ZrpcClientReactor()
+    : m_wakeup_pending(false), m_wakeup_value(0), m_running(true), m_wakeup_at(0), m_next_uring_token(1) {
+    m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollfd < 0 || m_wakeupfd < 0) {
+        LOG(FATAL) << "ZrpcClientReactor init error: " << strerror(errno);
+    }
+
+    // 配置rpcioengine=io_uring时改用io_uring引擎，内核不支持时仍然使用epoll
+    if (ZrpcApplication::GetInstance().GetConfig().Load("rpcioengine") == "io_uring") {
+        m_uring.reset(new ZrpcUring);
+        if (!m_uring->Init(kUringEntries) || !m_uring->SetupBuffers(kUringBufferCount, kUringBufferSize)) {
+            LOG(WARNING) << "ZrpcClientReactor io_uring unavailable, fall back to epoll";
+            m_uring.reset();
+        } else if (!m_uring->SetupFiles(kUringFixedFiles)) {
+            LOG(WARNING) << "io_uring fixed files unavailable, use plain fds";
+        }
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeupfd;
+    epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_wakeupfd, &ev);
+
+    m_thread = std::thread(&ZrpcClientReactor::Loop, this);
+    LOG(INFO) << "ZrpcClientReactor started" << (m_uring ? " (io_uring)" : "");
+}
+
+ZrpcClientReactor::~ZrpcClientReactor() {
+    m_running = false;
+    Wakeup();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close(m_wakeupfd);
+    close(m_epollfd);
+}
+
+// 注册连接，关注可读事件
+bool ZrpcClientReactor::AddConnection(const std::shared_ptr<ZrpcMuxConnection> &conn, int fd) {
+    if (fd < 0) {
+        fd = conn->GetFd();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_connections[fd] = conn;
+    }
+
+    if (m_uring) {
+        // 多发接收要在reactor线程上提交
+        RunInLoop([this, conn, fd] { ArmUringEntry(conn, fd); });
+        return true;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        LOG(ERROR) << "epoll_ctl add error: " << strerror(errno);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_connections.erase(fd);
+        return false;
+    }
+    return true;
+}
+
+// 注销连接，连接对象在最后一个持有者释放时关闭fd
+void ZrpcClientReactor::RemoveConnection(int fd) {
+    if (m_uring) {
+        RunInLoop([this, fd] { DisarmUringEntry(fd); });
+    } else {
+        epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connections.erase(fd);
+}
+
+void ZrpcClientReactor::RequestSend(const std::shared_ptr<ZrpcMuxConnection> &conn) {
+    QueueInLoop([this, conn] { StartUringSend(conn); });
+}
+
+void ZrpcClientReactor::EnableWriting(int fd, bool enable) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(m_epollfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void ZrpcClientReactor::RunInLoop(Functor cb) {
+    if (IsInLoopThread()) {
+        cb();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_functors.push_back(std::move(cb));
+    }
+    Wakeup();
+}
+
+void ZrpcClientReactor::QueueInLoop(Functor cb) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_functors.push_back(std::move(cb));
+    }
+    if (!IsInLoopThread()) {
+        Wakeup();
+    }
+}
+
+ZrpcClientReactor::TimerId ZrpcClientReactor::RunAt(std::chrono::steady_clock::time_point when, Functor cb) {
+    TimerId id = m_timer_wheel.Add(when, std::move(cb));
+    // reactor会睡到计划的时刻，只有新定时器更早到期时才唤醒它重新计算等待时间；
+    // 调用超时通常远长于kPollTimeoutMs，大多数调用不需要唤醒
+    if (!IsInLoopThread() && when.time_since_epoch().count() < m_wakeup_at.load()) {
+        Wakeup();
+    }
+    return id;
+}
+
+ZrpcClientReactor::TimerId ZrpcClientReactor::RunAfter(int delay_ms, Functor cb) {
+    return RunAt(std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms > 0 ? delay_ms : 0), std::move(cb));
+}
+
+void ZrpcClientReactor::CancelTimer(TimerId id) {
+    m_timer_wheel.Cancel(id);
+}
+
+bool ZrpcClientReactor::IsInLoopThread() const {
+    return std::this_thread::get_id() == m_thread.get_id();
+}
+
+void ZrpcClientReactor::Loop() {
+    std::vector<struct epoll_event> events(64);
+    if (m_uring) {
+        m_uring->PrepareRead(m_wakeupfd, &m_wakeup_value, sizeof(m_wakeup_value), MakeUserData(0, kOpWakeup));
+    }
+
+    while (m_running) {
+        // 先标记为"即将计算等待时间"，期间新加入的定时器一律唤醒，避免错过比计划更早的到期时间
+        m_wakeup_at.store(std::numeric_limits<int64_t>::max());
+        auto now = std::chrono::steady_clock::now();
+        int timeout_ms = m_timer_wheel.NextTimeoutMs(now, kPollTimeoutMs);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_pending_functors.empty()) {
+                timeout_ms = 0;  // 上一轮中排队的任务（QueueInLoop）不等待，处理完事件后立即执行
+            }
+        }
+        m_wakeup_at.store((now + std::chrono::milliseconds(timeout_ms)).time_since_epoch().count());
+
+        if (m_uring) {
+            PollUring(timeout_ms);
+        } else {
+            PollEpoll(timeout_ms, &events);
+        }
+
+        DoPendingFunctors();
+        RunExpiredTimers();
+    }
+}
+
+void ZrpcClientReactor::PollEpoll(int timeout_ms, std::vector<struct epoll_event> *events) {
+    int n = epoll_wait(m_epollfd, events->data(), static_cast<int>(events->size()), timeout_ms);
+    if (n < 0 && errno != EINTR) {
+        LOG(ERROR) << "epoll_wait error: " << strerror(errno);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        int fd = (*events)[i].data.fd;
+        if (fd == m_wakeupfd) {
+            HandleWakeup();
+            continue;
+        }
+
+        std::shared_ptr<ZrpcMuxConnection> conn;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_connections.find(fd);
+            if (it != m_connections.end()) {
+                conn = it->second;
+            }
+        }
+        if (!conn) continue;
+
+        uint32_t revents = (*events)[i].events;
+        if (revents & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            conn->HandleRead();
+        }
+        if ((revents & EPOLLOUT) && !conn->IsClosed()) {
+            conn->HandleWrite();
+        }
+    }
+    if (n == static_cast<int>(events->size())) {
+        events->resize(events->size() * 2);  // 事件较多时扩容
+    }
+}
+
+// 本轮准备好的发送、重新提交的接收与等待合并为一次io_uring_enter，再依次处理取回的完成事件
+void ZrpcClientReactor::PollUring(int timeout_ms) {
+    m_uring->Submit(timeout_ms);
+    ZrpcUring::Completion completion;
+    while (m_uring->NextCompletion(&completion)) {
+        HandleUringCompletion(completion);
+    }
+}
+
+// reactor还没有处理上一次唤醒时不再写eventfd，同一轮中多次唤醒只有一次系统调用
+void ZrpcClientReactor::Wakeup() {
+    if (m_wakeup_pending.exchange(true)) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t n = write(m_wakeupfd, &one, sizeof(one));
+    (void)n;
+}
+
+void ZrpcClientReactor::HandleWakeup() {
+    uint64_t value = 0;
+    ssize_t n = read(m_wakeupfd, &value, sizeof(value));
+    (void)n;
+    m_wakeup_pending = false;  // 之后排队的任务需要重新唤醒；此前排队的任务在本轮事件处理之后执行
+}
+
+void ZrpcClientReactor::DoPendingFunctors() {
+    std::vector<Functor> functors;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        functors.swap(m_pending_functors);
+    }
+    for (auto &functor : functors) {
+        functor();
+    }
+}
+
+// 执行所有已到期的定时任务
+void ZrpcClientReactor::RunExpiredTimers() {
+    std::vector<Functor> expired;
+    m_timer_wheel.Advance(std::chrono::steady_clock::now(), &expired);
+    for (auto &cb : expired) {
+        cb();
+    }
+}
+
+// 注册到io_uring：套接字字节流登记到固定文件表并提交多发接收，其他fd提交多发poll
+void ZrpcClientReactor::ArmUringEntry(const std::shared_ptr<ZrpcMuxConnection> &conn, int fd) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_connections.find(fd);
+        if (it == m_connections.end() || it->second != conn) {
+            return;  // 提交之前已经注销
+        }
+    }
+    uint64_t token = m_next_uring_token++;
+    UringEntry &entry = m_uring_entries[token];
+    entry.conn = conn;
+    entry.fd = fd;
+    entry.stream = fd == conn->GetFd() && conn->IsStream();
+    entry.slot = entry.stream ? m_uring->RegisterFile(fd) : -1;
+    m_uring_tokens[fd] = token;
+    if (!ArmUringRead(token, entry)) {
+        conn->HandleClose("io_uring submission queue full: " + conn->m_endpoint);
+    }
+}
+
+bool ZrpcClientReactor::ArmUringRead(uint64_t token, UringEntry &entry) {
+    entry.armed = entry.stream ? m_uring->PrepareRecvMultishot(entry.fd, entry.slot, MakeUserData(token, kOpRecv))
+                               : m_uring->PreparePollMultishot(entry.fd, MakeUserData(token, kOpPoll));
+    return entry.armed;
+}
+
+// 注销：取消还在进行的操作，全部完成后才释放注册项（发送中的数据在那之前不能释放）
+void ZrpcClientReactor::DisarmUringEntry(int fd) {
+    auto tit = m_uring_tokens.find(fd);
+    if (tit == m_uring_tokens.end()) {
+        return;
+    }
+    uint64_t token = tit->second;
+    m_uring_tokens.erase(tit);
+    UringEntry &entry = m_uring_entries[token];
+    entry.removed = true;
+    if (entry.armed) {
+        m_uring->PrepareCancel(MakeUserData(token, entry.stream ? kOpRecv : kOpPoll), MakeUserData(0, kOpCancel));
+    }
+    if (entry.send_inflight) {
+        m_uring->PrepareCancel(MakeUserData(token, kOpSend), MakeUserData(0, kOpCancel));
+    }
+    ReleaseUringEntry(token);
+}
+
+void ZrpcClientReactor::ReleaseUringEntry(uint64_t token) {
+    auto it = m_uring_entries.find(token);
+    if (it == m_uring_entries.end() || !it->second.removed || it->second.armed || it->second.send_inflight) {
+        return;
+    }
+    m_uring->UnregisterFile(it->second.slot);
+    m_uring_entries.erase(it);
+}
+
+void ZrpcClientReactor::HandleUringCompletion(const ZrpcUring::Completion &completion) {
+    uint64_t token = completion.user_data >> 8;
+    uint64_t op = completion.user_data & 0xff;
+    if (op == kOpWakeup) {
+        m_wakeup_pending = false;
+        if (m_running) {
+            m_uring->PrepareRead(m_wakeupfd, &m_wakeup_value, sizeof(m_wakeup_value), MakeUserData(0, kOpWakeup));
+        }
+        return;
+    }
+    if (op == kOpCancel) {
+        return;
+    }
+
+    auto it = m_uring_entries.find(token);
+    if (it == m_uring_entries.end()) {
+        if (ZrpcUring::HasBuffer(completion.flags)) {
+            m_uring->RecycleBuffer(ZrpcUring::BufferId(completion.flags));
+        }
+        return;
+    }
+    // 回调中可能注册新的连接，unordered_map插入元素不会使已有元素的引用失效；本项在操作结束前也不会被释放
+    UringEntry &entry = it->second;
+    std::shared_ptr<ZrpcMuxConnection> conn = entry.conn;
+    if (op == kOpSend) {
+        HandleUringSend(token, entry, completion.res);
+        return;
+    }
+
+    if (op == kOpRecv) {
+        if (completion.res > 0 && ZrpcUring::HasBuffer(completion.flags) && !entry.removed) {
+            conn->HandleData(m_uring->Buffer(ZrpcUring::BufferId(completion.flags)), static_cast<size_t>(completion.res));
+        }
+        if (ZrpcUring::HasBuffer(completion.flags)) {
+            m_uring->RecycleBuffer(ZrpcUring::BufferId(completion.flags));
+        }
+    } else if (completion.res > 0 && !entry.removed) {
+        conn->HandleRead();  // 共享内存连接的门铃或保留的套接字可读
+    }
+
+    if (!ZrpcUring::HasMore(completion.flags)) {
+        entry.armed = false;
+        if (!entry.removed) {
+            // 接收缓冲区暂时用完或poll被内核结束时重新提交；对端关闭或接收出错时关闭连接
+            bool rearm = !entry.stream || completion.res > 0 || completion.res == -ENOBUFS;
+            if (!rearm || !ArmUringRead(token, entry)) {
+                conn->HandleClose(completion.res < 0 ? std::string("recv error: ") + strerror(-completion.res) + ": " + conn->m_endpoint
+                                                     : "connection closed: " + conn->m_endpoint);
+            }
+        }
+    }
+    ReleaseUringEntry(token);
+}
+
+// 取出连接输出缓冲区中攒下的全部请求，作为一个发送操作提交
+void ZrpcClientReactor::StartUringSend(const std::shared_ptr<ZrpcMuxConnection> &conn) {
+    auto tit = m_uring_tokens.find(conn->GetFd());
+    if (tit == m_uring_tokens.end()) {
+        return;
+    }
+    uint64_t token = tit->second;
+    UringEntry &entry = m_uring_entries[token];
+    if (entry.conn != conn || entry.removed || entry.send_inflight) {
+        return;  // 正在发送时由发送完成后接着取
+    }
+    if (!conn->TakeOutput(&entry.sending)) {
+        return;
+    }
+    entry.sending_offset = 0;
+    entry.send_inflight = m_uring->PrepareSend(entry.fd, entry.slot, entry.sending.data(), entry.sending.size(),
+                                               MakeUserData(token, kOpSend));
+    if (!entry.send_inflight) {
+        conn->HandleClose("io_uring submission queue full: " + conn->m_endpoint);
+    }
+}
+
+void ZrpcClientReactor::HandleUringSend(uint64_t token, UringEntry &entry, int res) {
+    entry.send_inflight = false;
+    std::shared_ptr<ZrpcMuxConnection> conn = entry.conn;
+    if (entry.removed) {
+        ReleaseUringEntry(token);
+        return;
+    }
+    if (res < 0) {
+        conn->HandleClose(std::string("send error: ") + strerror(-res) + ": " + conn->m_endpoint);
+        ReleaseUringEntry(token);
+        return;
+    }
+    entry.sending_offset += static_cast<size_t>(res);
+    if (entry.sending_offset < entry.sending.size()) {
+        // 只发出了一部分（内核发送缓冲区满），接着发送剩余的部分
+        entry.send_inflight = m_uring->PrepareSend(entry.fd, entry.slot, entry.sending.data() + entry.sending_offset,
+                                                   entry.sending.size() - entry.sending_offset, MakeUserData(token, kOpSend));
+        if (!entry.send_inflight) {
+            conn->HandleClose("io_uring submission queue full: " + conn->m_endpoint);
+        }
+        return;
+    }
+    entry.sending.clear();
+    StartUringSend(conn);  // 发送期间又攒下的请求
+}
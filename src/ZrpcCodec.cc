@@ -0,0 +1,253 @@
+#include "ZrpcCodec.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <string.h>
+
+namespace {
+
+// 追加到out尾部的分配函数，out只扩展一次
+ZrpcCodec::FrameAllocator AppendTo(std::string *out) {
+    return [out](size_t frame_len) {
+        size_t offset = out->size();
+        out->resize(offset + frame_len);
+        return reinterpret_cast<uint8_t *>(&(*out)[offset]);
+    };
+}
+
+// 为 header_size + header + body 分配空间，返回body的写入位置
+// 帧长预先算出，只分配一次；头部直接序列化到分配的内存中，不经过中间字符串
+uint8_t *WriteHeader(const google::protobuf::Message &header, size_t body_size, const ZrpcCodec::FrameAllocator &alloc) {
+    size_t header_size = header.ByteSizeLong();
+    if (header_size > ZrpcCodec::kMaxFrameSize || body_size > ZrpcCodec::kMaxFrameSize) {
+        return nullptr;
+    }
+    size_t varint_size = google::protobuf::io::CodedOutputStream::VarintSize32(static_cast<uint32_t>(header_size));
+    uint8_t *target = alloc(varint_size + header_size + body_size);
+    if (target == nullptr) {
+        return nullptr;
+    }
+    target = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(header_size), target);  // 写入头部长度
+    return header.SerializeWithCachedSizesToArray(target);  // 写入头部信息，ByteSizeLong已缓存各字段长度
+}
+
+// 消息体已经编码好（如批量帧中拼接的内层帧），直接拷贝到头部之后
+bool WriteFrame(const google::protobuf::Message &header,
+                const std::string &body,
+                const ZrpcCodec::FrameAllocator &alloc) {
+    uint8_t *target = WriteHeader(header, body.size(), alloc);
+    if (target == nullptr) {
+        return false;
+    }
+    if (!body.empty()) {
+        memcpy(target, body.data(), body.size());
+    }
+    return true;
+}
+
+// 消息体是protobuf消息：body_size为body.ByteSizeLong()的结果，消息直接序列化到头部之后，省去一次序列化到临时字符串再拼接的拷贝
+bool WriteFrame(const google::protobuf::Message &header,
+                const google::protobuf::Message &body,
+                size_t body_size,
+                const ZrpcCodec::FrameAllocator &alloc) {
+    uint8_t *target = WriteHeader(header, body_size, alloc);
+    if (target == nullptr) {
+        return false;
+    }
+    body.SerializeWithCachedSizesToArray(target);
+    return true;
+}
+
+// 按策略压缩消息体：序列化后的长度达到阈值、且压缩后确实变小时返回true，compressed中为压缩后的消息体
+bool CompressBody(const google::protobuf::Message &body, size_t body_size,
+                  const ZrpcCompressPolicy *policy, std::string *compressed) {
+    if (policy == nullptr || policy->type == Zrpc::COMPRESS_NONE || body_size < policy->min_bytes) {
+        return false;
+    }
+    thread_local std::string raw;  // 序列化后的原始消息体，每个线程复用
+    raw.resize(body_size);
+    body.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(&raw[0]));
+    return ZrpcCompression::Compress(policy->type, raw.data(), raw.size(), compressed) && compressed->size() < body_size;
+}
+
+// 从data中读取varint32
+// 返回值：>0 表示varint占用的字节数，0 表示数据不足，-1 表示格式错误
+int ReadVarint32(const char *data, size_t len, uint32_t *value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        if (i >= len) {
+            return 0;
+        }
+        uint8_t byte = static_cast<uint8_t>(data[i]);
+        result |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return static_cast<int>(i + 1);
+        }
+    }
+    return -1;
+}
+
+// 解析一个完整的帧：varint32(header_size) + header + body，body长度由头部的body_size_field给出
+template <typename Header>
+int DecodeFrame(const char *data, size_t len, Header *header, const char **body,
+                uint32_t (Header::*body_size_field)() const) {
+    uint32_t header_size = 0;
+    int varint_len = ReadVarint32(data, len, &header_size);
+    if (varint_len <= 0) {
+        return varint_len;
+    }
+
+    if (header_size > ZrpcCodec::kMaxFrameSize) {
+        return -1;
+    }
+
+    size_t header_end = varint_len + static_cast<size_t>(header_size);
+    if (len < header_end) {
+        return 0;  // 头部还没有收全
+    }
+    if (!header->ParseFromArray(data + varint_len, header_size)) {
+        return -1;
+    }
+
+    uint32_t body_size = (header->*body_size_field)();
+    if (body_size > ZrpcCodec::kMaxFrameSize) {
+        return -1;
+    }
+
+    size_t frame_len = header_end + body_size;
+    if (len < frame_len) {
+        return 0;  // 消息体还没有收全
+    }
+
+    *body = data + header_end;
+    return static_cast<int>(frame_len);
+}
+
+}  // namespace
+
+// 编码请求帧
+bool ZrpcCodec::EncodeRequest(const std::string &service_name,
+                              const std::string &method_name,
+                              uint64_t request_id,
+                              const google::protobuf::Message &request,
+                              std::string *out,
+                              uint32_t timeout_ms,
+                              const ZrpcCompressPolicy *compress,
+                              Zrpc::RpcPriority priority) {
+    return EncodeRequest(service_name, method_name, request_id, request, AppendTo(out), timeout_ms, compress, priority);
+}
+
+bool ZrpcCodec::EncodeRequest(const std::string &service_name,
+                              const std::string &method_name,
+                              uint64_t request_id,
+                              const google::protobuf::Message &request,
+                              const FrameAllocator &alloc,
+                              uint32_t timeout_ms,
+                              const ZrpcCompressPolicy *compress,
+                              Zrpc::RpcPriority priority) {
+    // 先计算请求参数的长度（同时缓存各字段长度），参数在写帧时直接序列化到out中
+    size_t args_size = request.ByteSizeLong();
+
+    // 定义RPC请求的头部信息
+    Zrpc::RpcHeader header;
+    header.set_service_name(service_name);  // 设置服务名
+    header.set_method_name(method_name);  // 设置方法名
+    header.set_args_size(static_cast<uint32_t>(args_size));  // 设置参数长度
+    header.set_request_id(request_id);  // 设置请求序号
+    header.set_timeout_ms(timeout_ms);  // 设置剩余时间预算
+    header.set_accept_compress(ZrpcCompression::SupportedMask());  // 告诉服务端本端能解压哪些算法
+    header.set_priority(priority);  // 调用方指定的优先级
+
+    std::string compressed;
+    if (CompressBody(request, args_size, compress, &compressed)) {
+        header.set_args_size(static_cast<uint32_t>(compressed.size()));
+        header.set_compress_type(compress->type);
+        return WriteFrame(header, compressed, alloc);
+    }
+    return WriteFrame(header, request, args_size, alloc);
+}
+
+// 编码响应帧
+bool ZrpcCodec::EncodeResponse(uint64_t request_id,
+                               const google::protobuf::Message &response,
+                               std::string *out,
+                               const ZrpcCompressPolicy *compress) {
+    return EncodeResponse(request_id, response, AppendTo(out), compress);
+}
+
+bool ZrpcCodec::EncodeResponse(uint64_t request_id,
+                               const google::protobuf::Message &response,
+                               const FrameAllocator &alloc,
+                               const ZrpcCompressPolicy *compress) {
+    size_t body_size = response.ByteSizeLong();
+
+    Zrpc::RpcResponseHeader header;
+    header.set_request_id(request_id);
+    header.set_body_size(static_cast<uint32_t>(body_size));
+    header.set_accept_compress(ZrpcCompression::SupportedMask());
+
+    std::string compressed;
+    if (CompressBody(response, body_size, compress, &compressed)) {
+        header.set_body_size(static_cast<uint32_t>(compressed.size()));
+        header.set_compress_type(compress->type);
+        return WriteFrame(header, compressed, alloc);
+    }
+    return WriteFrame(header, response, body_size, alloc);
+}
+
+// 编码失败响应帧
+bool ZrpcCodec::EncodeErrorResponse(uint64_t request_id,
+                                    Zrpc::RpcErrorCode error_code,
+                                    const std::string &error_text,
+                                    std::string *out) {
+    Zrpc::RpcResponseHeader header;
+    header.set_request_id(request_id);
+    header.set_body_size(0);
+    header.set_error_code(error_code);
+    header.set_error_text(error_text);
+    header.set_accept_compress(ZrpcCompression::SupportedMask());
+
+    return WriteFrame(header, std::string(), AppendTo(out));
+}
+
+// 编码批量请求帧
+bool ZrpcCodec::EncodeBatchRequest(const std::string &frames, uint32_t count, std::string *out) {
+    Zrpc::RpcHeader header;
+    header.set_args_size(frames.size());
+    header.set_batch_count(count);
+
+    return WriteFrame(header, frames, AppendTo(out));
+}
+
+// 编码批量响应帧
+bool ZrpcCodec::EncodeBatchResponse(const std::string &frames, uint32_t count, std::string *out) {
+    Zrpc::RpcResponseHeader header;
+    header.set_body_size(frames.size());
+    header.set_batch_count(count);
+
+    return WriteFrame(header, frames, AppendTo(out));
+}
+
+// 解析请求帧
+int ZrpcCodec::DecodeRequest(const char *data, size_t len,
+                             Zrpc::RpcHeader *header,
+                             const char **body) {
+    return DecodeFrame(data, len, header, body, &Zrpc::RpcHeader::args_size);
+}
+
+// 解析响应帧
+int ZrpcCodec::DecodeResponse(const char *data, size_t len,
+                              Zrpc::RpcResponseHeader *header,
+                              const char **body) {
+    return DecodeFrame(data, len, header, body, &Zrpc::RpcResponseHeader::body_size);
+}
+
+// 反序列化消息体
+bool ZrpcCodec::ParseBody(Zrpc::CompressType compress_type, const char *body, size_t len,
+                          google::protobuf::Message *message) {
+    if (compress_type == Zrpc::COMPRESS_NONE) {
+        return message->ParseFromArray(body, static_cast<int>(len));  // 未压缩时直接在接收缓冲区上反序列化
+    }
+    thread_local std::string raw;  // 解压后的消息体，每个线程复用
+    return ZrpcCompression::Decompress(compress_type, body, len, &raw) &&
+           message->ParseFromArray(raw.data(), static_cast<int>(raw.size()));
+}
@@ -0,0 +1,20 @@
+#include "ZrpcCodel.h"
+#include <limits>
+#include <algorithm>
+
+ZrpcCodel::ZrpcCodel(int64_t target_us, int64_t interval_us)
+    : m_target_us(target_us), m_interval_us(interval_us), m_interval_end_us(0),
+      m_min_delay_us(std::numeric_limits<int64_t>::max()), m_overloaded(false) {}
+
+bool ZrpcCodel::ShouldDrop(int64_t delay_us, int64_t now_us) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (now_us >= m_interval_end_us) {
+        // 上一个interval结束：最小排队时间都超过target才算过载，没有请求的interval不算
+        bool overloaded = m_min_delay_us != std::numeric_limits<int64_t>::max() && m_min_delay_us > m_target_us;
+        m_overloaded.store(overloaded, std::memory_order_relaxed);
+        m_min_delay_us = std::numeric_limits<int64_t>::max();
+        m_interval_end_us = now_us + m_interval_us;
+    }
+    m_min_delay_us = std::min(m_min_delay_us, delay_us);
+    return delay_us > (m_overloaded.load(std::memory_order_relaxed) ? m_target_us : m_interval_us);
+}
@@ -0,0 +1,189 @@
+#include "ZrpcCompression.h"
+#include "ZrpcCodec.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <memory>
+#include <string.h>
+#ifdef ZRPC_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef ZRPC_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef ZRPC_HAVE_SNAPPY
+#include <snappy.h>
+#endif
+
+namespace {
+
+#ifdef ZRPC_HAVE_ZSTD
+// 压缩级别取1：RPC消息小而多，更高的级别压缩率提升有限，CPU开销却成倍增加
+const int kZstdLevel = 1;
+
+// 每个线程复用自己的压缩/解压上下文，避免每次调用都重新分配
+struct ZstdContexts
+{
+    std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx *)> cctx{ZSTD_createCCtx(), ZSTD_freeCCtx};
+    std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx *)> dctx{ZSTD_createDCtx(), ZSTD_freeDCtx};
+};
+
+ZstdContexts &ThreadZstdContexts() {
+    thread_local ZstdContexts contexts;
+    return contexts;
+}
+#endif
+
+// 压缩数据可能的最大长度，0表示不支持该算法
+size_t MaxCompressedLength(Zrpc::CompressType type, size_t len) {
+    switch (type) {
+#ifdef ZRPC_HAVE_LZ4
+    case Zrpc::COMPRESS_LZ4:
+        return static_cast<size_t>(LZ4_compressBound(static_cast<int>(len)));
+#endif
+#ifdef ZRPC_HAVE_ZSTD
+    case Zrpc::COMPRESS_ZSTD:
+        return ZSTD_compressBound(len);
+#endif
+#ifdef ZRPC_HAVE_SNAPPY
+    case Zrpc::COMPRESS_SNAPPY:
+        return snappy::MaxCompressedLength(len);
+#endif
+    default:
+        (void)len;
+        return 0;
+    }
+}
+
+// 压缩到dst，返回压缩后的长度，失败返回0
+size_t CompressTo(Zrpc::CompressType type, const char *data, size_t len, char *dst, size_t capacity) {
+    switch (type) {
+#ifdef ZRPC_HAVE_LZ4
+    case Zrpc::COMPRESS_LZ4: {
+        int n = LZ4_compress_default(data, dst, static_cast<int>(len), static_cast<int>(capacity));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+#endif
+#ifdef ZRPC_HAVE_ZSTD
+    case Zrpc::COMPRESS_ZSTD: {
+        size_t n = ZSTD_compressCCtx(ThreadZstdContexts().cctx.get(), dst, capacity, data, len, kZstdLevel);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+#endif
+#ifdef ZRPC_HAVE_SNAPPY
+    case Zrpc::COMPRESS_SNAPPY: {
+        size_t n = 0;
+        snappy::RawCompress(data, len, dst, &n);
+        return n;
+    }
+#endif
+    default:
+        (void)data;
+        (void)len;
+        (void)dst;
+        (void)capacity;
+        return 0;
+    }
+}
+
+// 解压到dst，dst的长度恰好为原始长度
+bool DecompressTo(Zrpc::CompressType type, const char *data, size_t len, char *dst, size_t raw_len) {
+    switch (type) {
+#ifdef ZRPC_HAVE_LZ4
+    case Zrpc::COMPRESS_LZ4:
+        return LZ4_decompress_safe(data, dst, static_cast<int>(len), static_cast<int>(raw_len)) == static_cast<int>(raw_len);
+#endif
+#ifdef ZRPC_HAVE_ZSTD
+    case Zrpc::COMPRESS_ZSTD: {
+        size_t n = ZSTD_decompressDCtx(ThreadZstdContexts().dctx.get(), dst, raw_len, data, len);
+        return !ZSTD_isError(n) && n == raw_len;
+    }
+#endif
+#ifdef ZRPC_HAVE_SNAPPY
+    case Zrpc::COMPRESS_SNAPPY: {
+        size_t n = 0;
+        return snappy::GetUncompressedLength(data, len, &n) && n == raw_len && snappy::RawUncompress(data, len, dst);
+    }
+#endif
+    default:
+        (void)data;
+        (void)len;
+        (void)dst;
+        (void)raw_len;
+        return false;
+    }
+}
+
+}  // namespace
+
+uint32_t ZrpcCompression::SupportedMask() {
+    uint32_t mask = 0;
+#ifdef ZRPC_HAVE_LZ4
+    mask |= 1u << Zrpc::COMPRESS_LZ4;
+#endif
+#ifdef ZRPC_HAVE_ZSTD
+    mask |= 1u << Zrpc::COMPRESS_ZSTD;
+#endif
+#ifdef ZRPC_HAVE_SNAPPY
+    mask |= 1u << Zrpc::COMPRESS_SNAPPY;
+#endif
+    return mask;
+}
+
+bool ZrpcCompression::IsSupported(Zrpc::CompressType type) {
+    return type != Zrpc::COMPRESS_NONE && (SupportedMask() & (1u << type)) != 0;
+}
+
+const char *ZrpcCompression::Name(Zrpc::CompressType type) {
+    switch (type) {
+    case Zrpc::COMPRESS_NONE:
+        return "none";
+    case Zrpc::COMPRESS_LZ4:
+        return "lz4";
+    case Zrpc::COMPRESS_ZSTD:
+        return "zstd";
+    case Zrpc::COMPRESS_SNAPPY:
+        return "snappy";
+    default:
+        return "unknown";
+    }
+}
+
+// 压缩：先写原始长度，再把压缩数据直接写到out的尾部，最后截掉多预留的空间
+bool ZrpcCompression::Compress(Zrpc::CompressType type, const char *data, size_t len, std::string *out) {
+    size_t bound = MaxCompressedLength(type, len);
+    if (bound == 0 || len > ZrpcCodec::kMaxFrameSize) {
+        return false;
+    }
+
+    size_t offset = out->size();
+    uint8_t varint[5];
+    size_t varint_len = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(len), varint) - varint;
+    out->resize(offset + varint_len + bound);
+    memcpy(&(*out)[offset], varint, varint_len);
+
+    size_t n = CompressTo(type, data, len, &(*out)[offset + varint_len], bound);
+    if (n == 0) {
+        out->resize(offset);
+        return false;
+    }
+    out->resize(offset + varint_len + n);
+    return true;
+}
+
+// 解压：原始长度超过单帧上限的视为格式错误，防止异常的长度字段导致无限制地分配内存
+bool ZrpcCompression::Decompress(Zrpc::CompressType type, const char *data, size_t len, std::string *out) {
+    if (!IsSupported(type)) {
+        return false;
+    }
+    google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t *>(data), static_cast<int>(len));
+    uint32_t raw_len = 0;
+    if (!input.ReadVarint32(&raw_len) || raw_len > ZrpcCodec::kMaxFrameSize) {
+        return false;
+    }
+    size_t header_len = static_cast<size_t>(input.CurrentPosition());
+
+    out->resize(raw_len);
+    if (raw_len == 0) {
+        return true;
+    }
+    return DecompressTo(type, data + header_len, len - header_len, &(*out)[0], raw_len);
+}
@@ -0,0 +1,644 @@
+#include "ZrpcConnectionPool.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <errno.h>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// ==================== ZrpcConnection ====================
+
+ZrpcConnection::ZrpcConnection(const std::string& host, uint16_t port, const std::string& unix_path)
+    : m_host(host), m_port(port), m_unix_path(unix_path), m_socket(-1), m_connected(false),
+      m_last_used(std::chrono::steady_clock::now()), m_created_time(std::chrono::steady_clock::now()),
+      m_peer_compress_mask(0) {}
+
+ZrpcConnection::~ZrpcConnection() {
+    Close();
+}
+
+bool ZrpcConnection::Connect(int timeout_ms) {
+    Close();
+    if (!ConnectInternal(timeout_ms)) {
+        return false;
+    }
+    m_created_time = std::chrono::steady_clock::now();
+    m_last_used = m_created_time;
+    m_connected = true;
+    return true;
+}
+
+void ZrpcConnection::Close() {
+    m_connected = false;
+    if (m_socket != -1) {
+        close(m_socket);
+        m_socket = -1;
+    }
+}
+
+// 检查连接是否仍然可用：空闲连接上不应该有可读事件，可读且读到0表示对端已关闭，
+// 读到数据表示上一次调用残留了未消费的字节，这样的连接也不能再复用
+bool ZrpcConnection::IsValid() const {
+    if (!m_connected || m_socket == -1) {
+        return false;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = m_socket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, 0);
+    if (ret == 0) {
+        return true;  // 没有任何事件，连接正常
+    }
+    if (ret < 0) {
+        return errno == EINTR;
+    }
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        return false;
+    }
+
+    char byte;
+    ssize_t n = recv(m_socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+// 连接空闲超过CONNECTION_TIMEOUT_SECONDS视为过期，中间设备可能已经悄悄断开了它
+bool ZrpcConnection::IsExpired() const {
+    auto idle = std::chrono::steady_clock::now() - m_last_used;
+    return idle > std::chrono::seconds(CONNECTION_TIMEOUT_SECONDS);
+}
+
+// 等待socket就绪，直到deadline；超时或出错时关闭连接，超时时errno为ETIMEDOUT
+bool ZrpcConnection::WaitReady(short events, std::chrono::steady_clock::time_point deadline, bool has_deadline) {
+    while (true) {
+        int timeout_ms = -1;
+        if (has_deadline) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout_ms = remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+        }
+        struct pollfd pfd;
+        pfd.fd = m_socket;
+        pfd.events = events;
+        pfd.revents = 0;
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret > 0) {
+            return true;  // 出错或挂断也视为就绪，由随后的send/recv得到具体错误
+        }
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        int saved_errno = ret == 0 ? ETIMEDOUT : errno;
+        LOG(ERROR) << (ret == 0 ? "wait timeout: " : "poll error: ") << m_host << ":" << m_port;
+        Close();
+        errno = saved_errno;
+        return false;
+    }
+}
+
+bool ZrpcConnection::Send(const char* data, size_t len, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0);
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(m_socket, data + sent, len - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 发送缓冲区已满，等待可写（服务端处理不过来时不会无限阻塞）
+                if (!WaitReady(POLLOUT, deadline, timeout_ms >= 0)) {
+                    return false;
+                }
+                continue;
+            }
+            int saved_errno = errno;
+            LOG(ERROR) << "send error: " << strerror(saved_errno) << " " << m_host << ":" << m_port;
+            Close();
+            errno = saved_errno;
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+bool ZrpcConnection::Receive(char* buffer, size_t len, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0);
+    size_t received = 0;
+    while (received < len) {
+        ssize_t n = recv(m_socket, buffer + received, len - received, MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!WaitReady(POLLIN, deadline, timeout_ms >= 0)) {
+                return false;
+            }
+            continue;
+        }
+        if (n <= 0) {
+            int saved_errno = n == 0 ? ECONNRESET : errno;
+            LOG(ERROR) << "recv error: " << (n == 0 ? "connection closed by server" : strerror(saved_errno));
+            Close();
+            errno = saved_errno;
+            return false;
+        }
+        received += n;
+    }
+    return true;
+}
+
+bool ZrpcConnection::WaitReadable(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0);
+    return WaitReady(POLLIN, deadline, timeout_ms >= 0);
+}
+
+void ZrpcConnection::UpdateLastUsed() {
+    m_last_used = std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point ZrpcConnection::GetLastUsed() const {
+    return m_last_used;
+}
+
+// 同一主机上的服务端优先走Unix域套接字，连接成功后恢复为阻塞模式
+bool ZrpcConnection::ConnectInternal(int timeout_ms) {
+    if (!m_unix_path.empty()) {
+        int fd = ZrpcUnixSocket::Connect(m_unix_path, timeout_ms);
+        if (fd >= 0) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+            m_socket = fd;
+            return true;
+        }
+        LOG(WARNING) << "fall back to tcp: " << m_host << ":" << m_port;
+    }
+
+    int fd = ConnectTcp(timeout_ms);
+    if (-1 == fd) {
+        return false;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));  // 请求报文很小，关闭Nagle算法
+    m_socket = fd;
+    return true;
+}
+
+// 非阻塞connect + poll实现连接超时，返回阻塞模式的fd，失败返回-1
+int ZrpcConnection::ConnectTcp(int timeout_ms) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (-1 == fd) {
+        LOG(ERROR) << "socket error: " << strerror(errno);
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(m_port);
+    server_addr.sin_addr.s_addr = inet_addr(m_host.c_str());
+
+    bool connected = false;
+    if (connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) == 0) {
+        connected = true;
+    } else if (errno == EINPROGRESS) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, timeout_ms) > 0) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            connected = getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0;
+        }
+    }
+
+    if (!connected) {
+        LOG(ERROR) << "connect server timeout or error: " << m_host << ":" << m_port;
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, flags);  // 恢复阻塞模式
+    return fd;
+}
+
+// ==================== ZrpcConnectionPool ====================
+
+ZrpcConnectionPool& ZrpcConnectionPool::GetInstance() {
+    static ZrpcConnectionPool instance;
+    return instance;
+}
+
+ZrpcConnectionPool::~ZrpcConnectionPool() {
+    Shutdown();
+}
+
+bool ZrpcConnectionPool::Initialize(const ConnectionPoolConfig& config) {
+    std::lock_guard<std::mutex> lock(m_init_mutex);
+    if (m_initialized) {
+        return false;  // 已经初始化
+    }
+
+    m_config = config;
+    if (m_config.max_connections == 0) {
+        m_config.max_connections = 1;
+    }
+    m_config.min_connections = std::min(m_config.min_connections, m_config.max_connections);
+    m_config.initial_connections = std::min(m_config.initial_connections, m_config.max_connections);
+
+    m_shutdown = false;
+    m_cleanup_thread = std::thread(&ZrpcConnectionPool::RunCleanupLoop, this);
+    if (m_config.enable_heartbeat) {
+        m_heartbeat_thread = std::thread(&ZrpcConnectionPool::RunHeartbeatLoop, this);
+    }
+    m_initialized = true;
+    LOG(INFO) << "ZrpcConnectionPool initialized, max_connections per endpoint: " << m_config.max_connections;
+    return true;
+}
+
+void ZrpcConnectionPool::Shutdown() {
+    std::lock_guard<std::mutex> lock(m_init_mutex);
+    if (!m_initialized) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> loop_lock(m_loop_mutex);
+        m_shutdown = true;
+    }
+    m_loop_cv.notify_all();
+    if (m_cleanup_thread.joinable()) {
+        m_cleanup_thread.join();
+    }
+    if (m_heartbeat_thread.joinable()) {
+        m_heartbeat_thread.join();
+    }
+
+    // 关闭所有空闲连接；仍被借出的连接在归还时关闭
+    std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+    for (auto& item : m_pools) {
+        EndpointPool* pool = item.second.get();
+        std::lock_guard<std::mutex> pool_lock(pool->mutex);
+        while (!pool->idle_connections.empty()) {
+            DestroyConnection(pool, pool->idle_connections.front());
+            pool->idle_connections.pop();
+        }
+        pool->cv.notify_all();
+    }
+    m_initialized = false;
+    LOG(INFO) << "ZrpcConnectionPool shutdown";
+}
+
+// 借出一个连接：优先复用空闲连接，没有空闲连接且未达上限时新建，达到上限时等待其他调用归还
+std::shared_ptr<ZrpcConnection> ZrpcConnectionPool::GetConnection(const std::string& host, uint16_t port, int timeout_ms,
+                                                                  const std::string& unix_path) {
+    if (!m_initialized) {
+        Initialize();  // 未显式初始化时使用默认配置
+    }
+
+    EndpointPool* pool = GetOrCreatePool(MakeEndpoint(host, port));
+    SetUnixPath(pool, unix_path);
+    if (timeout_ms < 0 || timeout_ms > m_config.connection_timeout_ms) {
+        timeout_ms = m_config.connection_timeout_ms;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    while (true) {
+        while (!pool->idle_connections.empty()) {
+            std::shared_ptr<ZrpcConnection> conn = pool->idle_connections.front();
+            pool->idle_connections.pop();
+            if (!IsConnectionValid(conn)) {
+                DestroyConnection(pool, conn);
+                continue;
+            }
+            pool->active_connections.emplace(conn.get(), conn);
+            pool->pool_hits++;
+            pool->requests_served++;
+            return conn;
+        }
+
+        if (pool->total_connections < m_config.max_connections) {
+            pool->total_connections++;  // 先占住名额，在锁外建立连接
+            lock.unlock();
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            std::shared_ptr<ZrpcConnection> conn =
+                remaining.count() > 0 ? CreateConnection(host, port, static_cast<int>(remaining.count()), unix_path) : nullptr;
+            lock.lock();
+            if (!conn) {
+                pool->total_connections--;
+                pool->cv.notify_one();
+                return nullptr;
+            }
+            pool->active_connections.emplace(conn.get(), conn);
+            pool->pool_misses++;
+            pool->requests_served++;
+            return conn;
+        }
+
+        // 连接数已达上限，等待归还
+        if (m_shutdown) {
+            return nullptr;
+        }
+        if (pool->cv.wait_until(lock, deadline) == std::cv_status::timeout && pool->idle_connections.empty() &&
+            pool->total_connections >= m_config.max_connections) {
+            LOG(WARNING) << "connection pool exhausted: " << MakeEndpoint(host, port);
+            return nullptr;
+        }
+    }
+}
+
+// 归还连接：调用失败时调用方应先Close连接，已失效的连接直接销毁，不放回空闲队列
+void ZrpcConnectionPool::ReturnConnection(std::shared_ptr<ZrpcConnection> conn) {
+    if (!conn) {
+        return;
+    }
+
+    EndpointPool* pool = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+        auto it = m_pools.find(MakeEndpoint(conn->GetHost(), conn->GetPort()));
+        if (it != m_pools.end()) {
+            pool = it->second.get();
+        }
+    }
+    if (pool == nullptr) {
+        conn->Close();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->active_connections.erase(conn.get());
+    if (m_shutdown || !conn->IsValid()) {
+        DestroyConnection(pool, conn);
+    } else {
+        conn->UpdateLastUsed();
+        pool->idle_connections.push(conn);
+    }
+    pool->cv.notify_one();
+}
+
+// 预建连接：与后台线程的FillPool相同，只是立即执行，并由调用方决定连接数和超时
+size_t ZrpcConnectionPool::Prewarm(const std::string& host, uint16_t port, size_t count, int timeout_ms,
+                                   const std::string& unix_path) {
+    if (!m_initialized) {
+        Initialize();
+    }
+    EndpointPool* pool = GetOrCreatePool(MakeEndpoint(host, port));
+    SetUnixPath(pool, unix_path);
+    if (timeout_ms < 0 || timeout_ms > m_config.connection_timeout_ms) {
+        timeout_ms = m_config.connection_timeout_ms;
+    }
+    if (timeout_ms > 0) {
+        FillPool(pool, count, timeout_ms);
+    }
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->total_connections;
+}
+
+size_t ZrpcConnectionPool::GetTotalConnections(const std::string& endpoint) {
+    std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+    auto it = m_pools.find(endpoint);
+    if (it == m_pools.end()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(it->second->mutex);
+    return it->second->total_connections;
+}
+
+size_t ZrpcConnectionPool::GetIdleConnections(const std::string& endpoint) {
+    std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+    auto it = m_pools.find(endpoint);
+    if (it == m_pools.end()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(it->second->mutex);
+    return it->second->idle_connections.size();
+}
+
+size_t ZrpcConnectionPool::GetActiveConnections(const std::string& endpoint) {
+    std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+    auto it = m_pools.find(endpoint);
+    if (it == m_pools.end()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(it->second->mutex);
+    return it->second->active_connections.size();
+}
+
+ZrpcConnectionPool::PoolStats ZrpcConnectionPool::GetStats() const {
+    PoolStats stats;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    std::shared_lock<std::shared_mutex> pools_lock(m_pools_mutex);
+    stats.total_pools = m_pools.size();
+    for (const auto& item : m_pools) {
+        EndpointPool* pool = item.second.get();
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            stats.total_connections += pool->total_connections;
+            stats.active_connections += pool->active_connections.size();
+            stats.idle_connections += pool->idle_connections.size();
+        }
+        stats.requests_served += pool->requests_served;
+        stats.connection_creates += pool->connection_creates;
+        stats.connection_destroys += pool->connection_destroys;
+        hits += pool->pool_hits;
+        misses += pool->pool_misses;
+    }
+    if (hits + misses > 0) {
+        stats.pool_hit_rate = static_cast<double>(hits) / (hits + misses);
+    }
+    return stats;
+}
+
+std::string ZrpcConnectionPool::MakeEndpoint(const std::string& host, uint16_t port) {
+    return host + ":" + std::to_string(port);
+}
+
+// 查找端点对应的池，不存在时创建；池创建后不会被删除，可以在释放m_pools_mutex后继续使用
+ZrpcConnectionPool::EndpointPool* ZrpcConnectionPool::GetOrCreatePool(const std::string& endpoint) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_pools_mutex);
+        auto it = m_pools.find(endpoint);
+        if (it != m_pools.end()) {
+            return it->second.get();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_pools_mutex);
+    std::unique_ptr<EndpointPool>& pool = m_pools[endpoint];
+    if (!pool) {
+        pool.reset(new EndpointPool());
+        size_t idx = endpoint.rfind(':');
+        pool->host = endpoint.substr(0, idx);
+        pool->port = static_cast<uint16_t>(atoi(endpoint.substr(idx + 1).c_str()));
+    }
+    return pool.get();
+}
+
+// 记录服务发现给出的Unix域套接字路径，后台补建的连接也使用它
+void ZrpcConnectionPool::SetUnixPath(EndpointPool* pool, const std::string& unix_path) {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->unix_path = unix_path;
+}
+
+std::shared_ptr<ZrpcConnection> ZrpcConnectionPool::CreateConnection(const std::string& host, uint16_t port, int timeout_ms,
+                                                                     const std::string& unix_path) {
+    auto conn = std::make_shared<ZrpcConnection>(host, port, unix_path);
+    if (!conn->Connect(timeout_ms)) {
+        return nullptr;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(m_pools_mutex);
+    auto it = m_pools.find(MakeEndpoint(host, port));
+    if (it != m_pools.end()) {
+        it->second->connection_creates++;
+    }
+    return conn;
+}
+
+void ZrpcConnectionPool::DestroyConnection(EndpointPool* pool, std::shared_ptr<ZrpcConnection> conn) {
+    conn->Close();
+    pool->total_connections--;
+    pool->connection_destroys++;
+}
+
+// 回收空闲连接：超过min_connections的部分空闲idle_timeout_seconds后关闭，
+// 任何空闲连接超过max_idle_time_seconds都会关闭（之后由FillPool补建新连接）
+void ZrpcConnectionPool::CleanupIdleConnections() {
+    std::vector<EndpointPool*> pools;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_pools_mutex);
+        for (auto& item : m_pools) {
+            pools.push_back(item.second.get());
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (EndpointPool* pool : pools) {
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            size_t count = pool->idle_connections.size();
+            for (size_t i = 0; i < count; ++i) {
+                std::shared_ptr<ZrpcConnection> conn = pool->idle_connections.front();
+                pool->idle_connections.pop();
+
+                auto idle = now - conn->GetLastUsed();
+                bool reap = idle > std::chrono::seconds(m_config.max_idle_time_seconds) ||
+                            (pool->total_connections > m_config.min_connections &&
+                             idle > std::chrono::seconds(m_config.idle_timeout_seconds));
+                if (reap || conn->IsExpired()) {
+                    DestroyConnection(pool, conn);
+                } else {
+                    pool->idle_connections.push(conn);
+                }
+            }
+        }
+
+        // 新建的池预建initial_connections个连接，之后保持不少于min_connections个
+        size_t target = pool->warmed ? m_config.min_connections
+                                     : std::max(m_config.initial_connections, m_config.min_connections);
+        FillPool(pool, target, m_config.connection_timeout_ms);
+        pool->warmed = true;
+    }
+}
+
+// 健康检查：关闭对端已断开或残留数据的空闲连接
+void ZrpcConnectionPool::HeartbeatCheck() {
+    std::vector<EndpointPool*> pools;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_pools_mutex);
+        for (auto& item : m_pools) {
+            pools.push_back(item.second.get());
+        }
+    }
+
+    for (EndpointPool* pool : pools) {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        size_t count = pool->idle_connections.size();
+        for (size_t i = 0; i < count; ++i) {
+            std::shared_ptr<ZrpcConnection> conn = pool->idle_connections.front();
+            pool->idle_connections.pop();
+            if (IsConnectionValid(conn)) {
+                pool->idle_connections.push(conn);
+            } else {
+                LOG(WARNING) << "drop broken pooled connection " << conn->GetHost() << ":" << conn->GetPort();
+                DestroyConnection(pool, conn);
+            }
+        }
+    }
+}
+
+void ZrpcConnectionPool::FillPool(EndpointPool* pool, size_t target, int timeout_ms) {
+    while (!m_shutdown) {
+        std::string unix_path;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            if (pool->total_connections >= target || pool->total_connections >= m_config.max_connections) {
+                return;
+            }
+            pool->total_connections++;
+            unix_path = pool->unix_path;
+        }
+
+        std::shared_ptr<ZrpcConnection> conn = CreateConnection(pool->host, pool->port, timeout_ms, unix_path);
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (!conn) {
+            pool->total_connections--;
+            return;  // 服务端暂时不可达，下一轮再试
+        }
+        pool->idle_connections.push(conn);
+        pool->cv.notify_one();
+    }
+}
+
+void ZrpcConnectionPool::RunCleanupLoop() {
+    // 检查间隔不超过1秒，让新建的池尽快预建连接
+    while (WaitFor(1)) {
+        CleanupIdleConnections();
+    }
+}
+
+void ZrpcConnectionPool::RunHeartbeatLoop() {
+    while (WaitFor(m_config.heartbeat_interval_seconds)) {
+        HeartbeatCheck();
+    }
+}
+
+bool ZrpcConnectionPool::IsConnectionValid(std::shared_ptr<ZrpcConnection> conn) {
+    return conn && conn->IsValid() && !conn->IsExpired();
+}
+
+bool ZrpcConnectionPool::WaitFor(int seconds) {
+    std::unique_lock<std::mutex> lock(m_loop_mutex);
+    m_loop_cv.wait_for(lock, std::chrono::seconds(seconds > 0 ? seconds : 1), [this] { return m_shutdown.load(); });
+    return !m_shutdown;
+}
+
+// ==================== ZrpcConnectionGuard ====================
+
+ZrpcConnectionGuard::ZrpcConnectionGuard(const std::string& host, uint16_t port, int timeout_ms, const std::string& unix_path)
+    : m_connection(ZrpcConnectionPool::GetInstance().GetConnection(host, port, timeout_ms, unix_path)), m_valid(m_connection != nullptr) {}
+
+ZrpcConnectionGuard::~ZrpcConnectionGuard() {
+    if (m_connection) {
+        ZrpcConnectionPool::GetInstance().ReturnConnection(m_connection);
+    }
+}
+
+std::shared_ptr<ZrpcConnection> ZrpcConnectionGuard::GetConnection() {
+    return m_connection;
+}
+
+bool ZrpcConnectionGuard::IsValid() const {
+    return m_valid && m_connection && m_connection->GetSocket() != -1;
+}
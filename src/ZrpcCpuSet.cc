@@ -0,0 +1,48 @@
+#include "ZrpcCpuSet.h"
+#include "ZrpcLogger.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sstream>
+
+bool ZrpcCpuSet::Parse(const std::string &spec) {
+    std::vector<int> cpus;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        char *end = nullptr;
+        long first = strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (*end == '-') {
+            last = strtol(end + 1, &end, 10);
+        }
+        if (end == item.c_str() || *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+            LOG(WARNING) << "invalid cpu list: " << spec;
+            m_cpus.clear();
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    m_cpus.swap(cpus);
+    return true;
+}
+
+void ZrpcCpuSet::PinCurrentThread() {
+    if (m_cpus.empty()) {
+        return;
+    }
+    int cpu = m_cpus[m_next.fetch_add(1, std::memory_order_relaxed) % m_cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        LOG(WARNING) << "bind thread to cpu " << cpu << " error: " << strerror(err);  // 例如CPU不在容器的cpuset中
+    }
+}
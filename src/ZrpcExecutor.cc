@@ -0,0 +1,121 @@
+#include "ZrpcExecutor.h"
+#include <algorithm>
+
+ZrpcExecutor::ZrpcExecutor(int num_threads, const std::vector<uint32_t> &weights)
+    : m_num_threads(num_threads > 0 ? num_threads : 1), m_size(0), m_virtual_time(0), m_running(false) {
+    for (uint32_t weight : weights) {
+        std::unique_ptr<TaskQueue> queue(new TaskQueue);
+        queue->stride = kStrideBase / std::max<uint32_t>(weight, 1);
+        m_queues.push_back(std::move(queue));
+    }
+    if (m_queues.empty()) {
+        std::unique_ptr<TaskQueue> queue(new TaskQueue);
+        queue->stride = kStrideBase;
+        m_queues.push_back(std::move(queue));
+    }
+}
+
+ZrpcExecutor::~ZrpcExecutor() {
+    Stop();
+}
+
+void ZrpcExecutor::Start() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) {
+            return;
+        }
+        m_running = true;
+    }
+    m_threads.reserve(m_num_threads);
+    for (int i = 0; i < m_num_threads; ++i) {
+        m_threads.emplace_back(&ZrpcExecutor::WorkerLoop, this);
+    }
+}
+
+void ZrpcExecutor::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_cond.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+void ZrpcExecutor::Submit(Task task, int cls) {
+    TaskQueue &queue = *m_queues[std::min(std::max(cls, 0), ClassNum() - 1)];
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) {
+            if (queue.tasks.empty()) {
+                queue.pass = std::max(queue.pass, m_virtual_time);
+            }
+            queue.tasks.push_back(std::move(task));
+            m_size++;
+            task = nullptr;
+        }
+    }
+    if (task) {
+        task();  // 线程池已经停止，任务中的响应仍然要发出去
+        return;
+    }
+    m_cond.notify_one();
+}
+
+void ZrpcExecutor::SetLifo(int cls, bool lifo) {
+    if (cls >= 0 && cls < ClassNum()) {
+        m_queues[cls]->lifo.store(lifo, std::memory_order_relaxed);
+    }
+}
+
+size_t ZrpcExecutor::QueueSize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+bool ZrpcExecutor::PopTask(Task *task) {
+    TaskQueue *selected = nullptr;
+    for (auto &queue : m_queues) {
+        if (!queue->tasks.empty() && (selected == nullptr || queue->pass < selected->pass)) {
+            selected = queue.get();
+        }
+    }
+    if (selected == nullptr) {
+        return false;
+    }
+    m_virtual_time = selected->pass;
+    selected->pass += selected->stride;
+    if (selected->lifo.load(std::memory_order_relaxed)) {
+        *task = std::move(selected->tasks.back());
+        selected->tasks.pop_back();
+    } else {
+        *task = std::move(selected->tasks.front());
+        selected->tasks.pop_front();
+    }
+    m_size--;
+    return true;
+}
+
+// 停止后仍把队列中剩下的任务执行完，每个请求都能得到响应
+void ZrpcExecutor::WorkerLoop() {
+    if (m_thread_init_callback) {
+        m_thread_init_callback();
+    }
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return !m_running || m_size > 0; });
+            if (!PopTask(&task)) {
+                return;
+            }
+        }
+        task();
+    }
+}
@@ -0,0 +1,28 @@
+#include "ZrpcLatencyTracker.h"
+#include <algorithm>
+
+ZrpcLatencyTracker::ZrpcLatencyTracker() : m_next(0) {
+    m_samples.reserve(kCapacity);
+}
+
+void ZrpcLatencyTracker::Record(int64_t latency_us) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_samples.size() < kCapacity) {
+        m_samples.push_back(latency_us);
+    } else {
+        m_samples[m_next] = latency_us;
+    }
+    m_next = (m_next + 1) % kCapacity;
+}
+
+int64_t ZrpcLatencyTracker::Percentile(double percentile) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_samples.size() < kMinSamples) {
+        return -1;
+    }
+    percentile = std::min(std::max(percentile, 0.0), 1.0);
+    m_scratch.assign(m_samples.begin(), m_samples.end());
+    size_t rank = static_cast<size_t>(percentile * (m_scratch.size() - 1) + 0.5);
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + rank, m_scratch.end());
+    return m_scratch[rank];
+}
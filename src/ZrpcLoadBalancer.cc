@@ -0,0 +1,307 @@
+#include "ZrpcLoadBalancer.h"
+#include <unordered_map>
+#include <mutex>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+std::mutex g_stats_mutex;  // 保护统计表，只在实例列表变化时访问
+std::unordered_map<std::string, std::shared_ptr<ZrpcEndpointStats>> g_endpoint_stats;  // ip:port -> 调用统计
+
+// 每个线程独立的随机数发生器，避免加锁
+uint64_t RandomIndex(uint64_t n) {
+    thread_local std::mt19937_64 engine(std::random_device{}());
+    return std::uniform_int_distribution<uint64_t>(0, n - 1)(engine);
+}
+
+// 64位整数混合函数（splitmix64的终结步骤），把key哈希与地址哈希组合成均匀分布的得分
+uint64_t Mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+}  // namespace
+
+std::shared_ptr<ZrpcEndpointStats> ZrpcEndpointStats::ForAddress(const std::string &address) {
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    std::shared_ptr<ZrpcEndpointStats> &stats = g_endpoint_stats[address];
+    if (!stats) {
+        stats = std::make_shared<ZrpcEndpointStats>();
+    }
+    return stats;
+}
+
+void ZrpcEndpointStats::OnCallStart() {
+    m_outstanding.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 准入检查：熔断器打开时拒绝（到期后只放行一个探测请求），在途请求数达到并发上限时拒绝
+ZrpcEndpointStats::Admission ZrpcEndpointStats::TryStart() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_circuit != CLOSED) {
+        if (m_probe_inflight || std::chrono::steady_clock::now() < m_open_until) {
+            return CIRCUIT_OPEN;
+        }
+        m_circuit = HALF_OPEN;
+        m_probe_inflight = true;  // 探测请求不受并发上限限制
+    } else if (m_outstanding.load(std::memory_order_relaxed) >= m_limit.load(std::memory_order_relaxed)) {
+        return LIMITED;
+    }
+    m_outstanding.fetch_add(1, std::memory_order_relaxed);
+    return ADMITTED;
+}
+
+void ZrpcEndpointStats::OnCallFinish(int64_t latency_us, Zrpc::RpcErrorCode code) {
+    m_outstanding.fetch_sub(1, std::memory_order_relaxed);
+    bool failed = IsEndpointFailure(code);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = std::chrono::steady_clock::now();
+        UpdateLimit(code == Zrpc::RPC_OK ? latency_us : 0, failed, now);
+        UpdateCircuit(failed, now);
+    }
+    if (code != Zrpc::RPC_OK) {
+        return;  // 失败请求的耗时不代表实例的真实延迟
+    }
+    // 并发更新时偶尔丢失一个样本不影响趋势，这里不使用CAS循环
+    int64_t old_value = m_ewma_latency_us.load(std::memory_order_relaxed);
+    int64_t new_value = old_value == 0
+                            ? latency_us
+                            : static_cast<int64_t>(old_value + kEwmaAlpha * (latency_us - old_value));
+    m_ewma_latency_us.store(new_value > 0 ? new_value : 1, std::memory_order_relaxed);
+}
+
+void ZrpcEndpointStats::OnCallCanceled() {
+    m_outstanding.fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_circuit == HALF_OPEN) {
+        m_probe_inflight = false;  // 探测请求被放弃，允许下一个请求探测
+    }
+}
+
+bool ZrpcEndpointStats::IsCircuitOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_circuit != CLOSED && (m_probe_inflight || std::chrono::steady_clock::now() < m_open_until);
+}
+
+bool ZrpcEndpointStats::IsEndpointFailure(Zrpc::RpcErrorCode code) {
+    return code == Zrpc::RPC_DEADLINE_EXCEEDED || code == Zrpc::RPC_UNAVAILABLE ||
+           code == Zrpc::RPC_INTERNAL_ERROR || code == Zrpc::RPC_OVERLOADED;
+}
+
+// 梯度算法：窗口平均延迟高出基线说明请求开始在实例上排队，按比例降低上限；延迟正常时每个窗口增加约sqrt(limit)的余量
+// 按窗口而不是按单个样本调整：单个样本的延迟抖动太大，窗口平均后才能看出排队
+void ZrpcEndpointStats::UpdateLimit(int64_t latency_us, bool failed, std::chrono::steady_clock::time_point now) {
+    if (m_sample_count == 0 && !m_sample_failed) {
+        m_sample_start = now;
+    }
+    if (failed) {
+        m_sample_failed = true;
+    } else if (latency_us > 0) {
+        m_sample_rtt_sum += latency_us;
+        m_sample_count++;
+    }
+    // 统计时已经减去了本次调用，加回来才是调用进行期间的在途请求数
+    m_sample_max_inflight = std::max(m_sample_max_inflight, m_outstanding.load(std::memory_order_relaxed) + 1);
+    if (now - m_sample_start < std::chrono::milliseconds(kSampleWindowMs) ||
+        (m_sample_count < kMinSampleCount && !m_sample_failed)) {
+        return;
+    }
+
+    double limit = m_limit_value;
+    if (m_sample_failed) {
+        limit = m_limit_value * kBackoffRatio;
+    } else {
+        int64_t rtt = std::max<int64_t>(1, m_sample_rtt_sum / m_sample_count);
+        if (m_probe_windows > 0) {
+            // 重新测量基线：第一个窗口让排队的请求消化掉，第二个窗口的延迟作为新基线，然后恢复原来的上限
+            if (--m_probe_windows == 0) {
+                m_min_rtt_us = rtt;
+                limit = m_probe_saved_limit;
+            }
+        } else if (++m_period_windows >= kMinRttPeriodWindows) {
+            m_period_windows = 0;
+            m_probe_windows = 2;
+            m_probe_saved_limit = m_limit_value;
+            limit = m_limit_value / 2;
+        } else {
+            if (m_min_rtt_us == 0 || rtt < m_min_rtt_us) {
+                m_min_rtt_us = rtt;
+            }
+            // 在途请求远少于上限时，延迟不能说明上限是否合适（调用方本身没有用满），不调整
+            if (m_sample_max_inflight * 2 >= m_limit_value) {
+                double gradient = std::max(0.5, std::min(1.0, kRttTolerance * m_min_rtt_us / rtt));
+                limit = m_limit_value * gradient + std::sqrt(m_limit_value);
+                limit = m_limit_value * (1 - kLimitSmoothing) + limit * kLimitSmoothing;
+            }
+        }
+    }
+    m_limit_value = std::min<double>(kMaxLimit, std::max<double>(kMinLimit, limit));
+    m_limit.store(static_cast<int>(m_limit_value), std::memory_order_relaxed);
+
+    m_sample_rtt_sum = 0;
+    m_sample_count = 0;
+    m_sample_max_inflight = 0;
+    m_sample_failed = false;
+}
+
+// 熔断器：CLOSED状态下按固定窗口统计失败率；HALF_OPEN状态下探测请求的结果决定关闭还是重新打开
+void ZrpcEndpointStats::UpdateCircuit(bool failed, std::chrono::steady_clock::time_point now) {
+    if (m_circuit == HALF_OPEN) {
+        m_probe_inflight = false;
+        if (failed) {
+            m_open_ms = std::min(m_open_ms * 2, static_cast<int>(kMaxOpenMs));
+            m_circuit = OPEN;
+            m_open_until = now + std::chrono::milliseconds(m_open_ms);
+        } else {
+            m_circuit = CLOSED;
+            m_open_ms = kMinOpenMs;
+            m_window_start = now;
+            m_window_requests = 0;
+            m_window_failures = 0;
+        }
+        return;
+    }
+    if (m_circuit == OPEN) {
+        return;  // 打开之前发出的请求陆续结束，不影响状态
+    }
+
+    if (now - m_window_start >= std::chrono::milliseconds(kWindowMs)) {
+        m_window_start = now;
+        m_window_requests = 0;
+        m_window_failures = 0;
+    }
+    m_window_requests++;
+    if (failed) {
+        m_window_failures++;
+    }
+    if (m_window_requests >= kMinWindowRequests && m_window_failures * 100 >= m_window_requests * kFailurePercent) {
+        m_circuit = OPEN;
+        m_open_until = now + std::chrono::milliseconds(m_open_ms);
+    }
+}
+
+// 轮询的起点随机选取，避免各个客户端（以及每个进程刚启动时）都从第一个实例开始
+ZrpcLoadBalancer::ZrpcLoadBalancer(Policy policy) : m_policy(policy), m_counter(std::random_device{}()) {}
+
+const ZrpcEndpoint *ZrpcLoadBalancer::Select(const ZrpcEndpointList &endpoints) {
+    if (endpoints.empty()) {
+        return nullptr;
+    }
+    if (endpoints.size() == 1) {
+        return &endpoints[0];
+    }
+
+    switch (m_policy.load()) {
+        case WEIGHTED:
+            return SelectWeighted(endpoints);
+        case POWER_OF_TWO:
+            return SelectPowerOfTwo(endpoints);
+        case LEAST_LATENCY:
+            return SelectLeastLatency(endpoints);
+        case ROUND_ROBIN:
+        default:
+            return &endpoints[m_counter.fetch_add(1, std::memory_order_relaxed) % endpoints.size()];
+    }
+}
+
+// 按权重随机：权重越大被选中的概率越高
+const ZrpcEndpoint *ZrpcLoadBalancer::SelectWeighted(const ZrpcEndpointList &endpoints) {
+    uint64_t total_weight = 0;
+    for (const auto &endpoint : endpoints) {
+        total_weight += endpoint.weight > 0 ? endpoint.weight : 0;
+    }
+    if (total_weight == 0) {
+        return &endpoints[RandomIndex(endpoints.size())];
+    }
+
+    uint64_t point = RandomIndex(total_weight);
+    for (const auto &endpoint : endpoints) {
+        uint64_t weight = endpoint.weight > 0 ? endpoint.weight : 0;
+        if (point < weight) {
+            return &endpoint;
+        }
+        point -= weight;
+    }
+    return &endpoints.back();
+}
+
+// 两次随机选择：比较两个候选实例的在途请求数
+const ZrpcEndpoint *ZrpcLoadBalancer::SelectPowerOfTwo(const ZrpcEndpointList &endpoints) {
+    size_t first = RandomIndex(endpoints.size());
+    size_t second = RandomIndex(endpoints.size() - 1);
+    if (second >= first) {
+        ++second;  // 保证两个候选不相同
+    }
+
+    const ZrpcEndpoint &a = endpoints[first];
+    const ZrpcEndpoint &b = endpoints[second];
+    int load_a = a.stats ? a.stats->Outstanding() : 0;
+    int load_b = b.stats ? b.stats->Outstanding() : 0;
+    if (load_a != load_b) {
+        return load_a < load_b ? &a : &b;
+    }
+    int64_t latency_a = a.stats ? a.stats->EwmaLatencyUs() : 0;
+    int64_t latency_b = b.stats ? b.stats->EwmaLatencyUs() : 0;
+    return latency_a <= latency_b ? &a : &b;
+}
+
+// 最低延迟：得分 = EWMA延迟 * (在途请求数 + 1)，从随机位置开始扫描以打散得分相同的实例
+const ZrpcEndpoint *ZrpcLoadBalancer::SelectLeastLatency(const ZrpcEndpointList &endpoints) {
+    size_t start = RandomIndex(endpoints.size());
+    const ZrpcEndpoint *best = nullptr;
+    double best_score = 0;
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        const ZrpcEndpoint &endpoint = endpoints[(start + i) % endpoints.size()];
+        if (!endpoint.stats || endpoint.stats->EwmaLatencyUs() == 0) {
+            return &endpoint;  // 还没有延迟样本，先探测
+        }
+        double score = static_cast<double>(endpoint.stats->EwmaLatencyUs()) * (endpoint.stats->Outstanding() + 1);
+        if (best == nullptr || score < best_score) {
+            best = &endpoint;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+// 带权重的rendezvous哈希：每个实例的得分为 -weight / ln(u)，u为key和实例地址共同决定的(0,1)均匀值，取得分最高者
+// 与哈希环相比不需要预先构建虚拟节点，实例列表是不可变快照，每次调用只需O(n)次整数运算
+const ZrpcEndpoint *ZrpcLoadBalancer::SelectByKey(const ZrpcEndpointList &endpoints, const std::string &key) {
+    if (endpoints.empty()) {
+        return nullptr;
+    }
+
+    uint64_t key_hash = Hash(key.data(), key.size());
+    const ZrpcEndpoint *best = nullptr;
+    double best_score = 0;
+    for (const auto &endpoint : endpoints) {
+        if (endpoint.weight <= 0) {
+            continue;
+        }
+        uint64_t h = Mix(key_hash ^ endpoint.address_hash);
+        double u = (static_cast<double>(h >> 11) + 0.5) / 9007199254740992.0;  // 取高53位映射到(0,1)
+        double score = -endpoint.weight / std::log(u);
+        if (best == nullptr || score > best_score) {
+            best = &endpoint;
+            best_score = score;
+        }
+    }
+    return best != nullptr ? best : &endpoints[0];
+}
+
+// FNV-1a哈希，结果再经过一次混合；各客户端对同一地址/key算出的值相同
+uint64_t ZrpcLoadBalancer::Hash(const char *data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return Mix(h);
+}
@@ -0,0 +1,459 @@
+#include "ZrpcMuxConnection.h"
+#include "ZrpcClientReactor.h"
+#include "ZrpcCodec.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <condition_variable>
+#include <vector>
+
+namespace {
+std::mutex g_mux_mutex;  // 保护连接表
+std::unordered_map<std::string, std::shared_ptr<ZrpcMuxConnection>> g_mux_connections;  // endpoint -> 共享连接
+}
+
+// 获取到指定服务端的共享连接
+std::shared_ptr<ZrpcMuxConnection> ZrpcMuxConnection::GetConnection(const std::string &ip, uint16_t port, int timeout_ms,
+                                                                    const std::string &unix_path) {
+    std::string endpoint = ip + ":" + std::to_string(port);
+
+    {
+        std::lock_guard<std::mutex> lock(g_mux_mutex);
+        auto it = g_mux_connections.find(endpoint);
+        if (it != g_mux_connections.end() && !it->second->IsClosed()) {
+            return it->second;
+        }
+    }
+
+    // 连接不存在或已断开，在锁外重新建立（到不同服务端的连接可以同时建立，如预热时），再交给reactor驱动
+    int fd = Connect(ip, port, timeout_ms, unix_path);
+    if (-1 == fd) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(g_mux_mutex);
+    auto it = g_mux_connections.find(endpoint);
+    if (it != g_mux_connections.end() && !it->second->IsClosed()) {
+        close(fd);  // 其他线程已经建好了连接
+        return it->second;
+    }
+    auto conn = std::make_shared<ZrpcMuxConnection>(fd, endpoint);
+    if (!ZrpcClientReactor::GetInstance().AddConnection(conn)) {
+        return nullptr;
+    }
+    g_mux_connections[endpoint] = conn;
+    LOG(INFO) << "multiplexed connection established: " << endpoint;
+    return conn;
+}
+
+ZrpcMuxConnection::ZrpcMuxConnection(int fd, const std::string &endpoint)
+    : m_fd(fd), m_endpoint(endpoint), m_closed(false), m_next_request_id(1), m_peer_compress_mask(0) {}
+
+ZrpcMuxConnection::~ZrpcMuxConnection() {
+    close(m_fd);
+}
+
+uint64_t ZrpcMuxConnection::NextRequestId() {
+    return m_next_request_id.fetch_add(1);
+}
+
+bool ZrpcMuxConnection::IsClosed() const {
+    return m_closed;
+}
+
+// 异步发送请求帧
+void ZrpcMuxConnection::CallAsync(uint64_t request_id, const std::string &frame, int timeout_ms, Completion done,
+                                  const ZrpcBatchPolicy *batch) {
+    if (!AddPending(request_id, timeout_ms, std::move(done))) {
+        return;
+    }
+    if (batch != nullptr) {
+        EnqueueBatch(frame, *batch);
+        return;
+    }
+    SendFrame(frame);
+}
+
+// 先登记再发送，避免响应先于登记到达；超时定时器在登记的同时加入，保证每个调用都会结束
+bool ZrpcMuxConnection::AddPending(uint64_t request_id, int timeout_ms, Completion done) {
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    if (m_closed) {
+        lock.unlock();
+        done(Zrpc::RPC_UNAVAILABLE, nullptr, 0, "connection closed: " + m_endpoint);
+        return false;
+    }
+    PendingCall call;
+    call.done = std::move(done);
+    std::weak_ptr<ZrpcMuxConnection> weak_self = shared_from_this();
+    call.timer = ZrpcClientReactor::GetInstance().RunAfter(timeout_ms, [weak_self, request_id, timeout_ms] {
+        if (std::shared_ptr<ZrpcMuxConnection> self = weak_self.lock()) {
+            self->OnTimeout(request_id, timeout_ms);
+        }
+    });
+    m_pending.emplace(request_id, std::move(call));
+    return true;
+}
+
+// 发送一个完整的帧：输出缓冲区为空时直接在调用线程发送，发不完的部分交给reactor
+void ZrpcMuxConnection::SendFrame(const std::string &frame) {
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    ZrpcClientReactor &reactor = ZrpcClientReactor::GetInstance();
+    if (reactor.UsesIoUring()) {
+        // io_uring引擎：不在调用线程上发送，同一轮中的请求攒在一起由reactor一次提交
+        bool idle = m_output.empty();
+        m_output.append(frame);
+        if (idle) {
+            reactor.RequestSend(shared_from_this());
+        }
+        return;
+    }
+    if (!m_output.empty()) {
+        // 前面还有数据没发完，排在后面由reactor继续发送
+        m_output.append(frame);
+        return;
+    }
+
+    ssize_t n = send(m_fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            char errtxt[512] = {0};
+            LOG(ERROR) << "send error: " << strerror_r(errno, errtxt, sizeof(errtxt));
+            shutdown(m_fd, SHUT_RDWR);  // reactor会收到挂断事件，统一关闭连接并通知所有未完成的调用
+            return;
+        }
+        n = 0;
+    }
+    if (static_cast<size_t>(n) < frame.size()) {
+        m_output.append(frame.data() + n, frame.size() - n);
+        reactor.EnableWriting(m_fd, true);
+    }
+}
+
+// 请求进入批量缓冲区：攒够数量或字节数时立即发送，否则由这一批的第一个请求安排延迟发送
+void ZrpcMuxConnection::EnqueueBatch(const std::string &frame, const ZrpcBatchPolicy &policy) {
+    std::string batch_frame;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_batch_mutex);
+        m_batch.append(frame);
+        m_batch_count++;
+        if (m_batch_count >= policy.max_calls || m_batch.size() >= policy.max_bytes) {
+            TakeBatch(&batch_frame);
+        } else if (m_batch_count == 1) {
+            generation = ++m_batch_generation;
+        }
+    }
+    if (!batch_frame.empty()) {
+        SendFrame(batch_frame);
+        return;
+    }
+    if (generation == 0) {
+        return;  // 这一批已经安排了延迟发送
+    }
+
+    std::weak_ptr<ZrpcMuxConnection> weak_self = shared_from_this();
+    auto flush = [weak_self, generation] {
+        if (std::shared_ptr<ZrpcMuxConnection> self = weak_self.lock()) {
+            self->FlushBatch(generation);
+        }
+    };
+    // 时间轮精度为1毫秒，更短的延迟退化为reactor本轮事件处理之后发送
+    if (policy.max_delay_us >= 1000) {
+        ZrpcClientReactor::GetInstance().RunAfter(policy.max_delay_us / 1000, std::move(flush));
+    } else {
+        ZrpcClientReactor::GetInstance().QueueInLoop(std::move(flush));
+    }
+}
+
+// 延迟时间到，发送这一批中还没有发出的请求；这一批已经因攒满而发出时什么也不做
+void ZrpcMuxConnection::FlushBatch(uint64_t generation) {
+    std::string batch_frame;
+    {
+        std::lock_guard<std::mutex> lock(m_batch_mutex);
+        if (generation != m_batch_generation || m_batch_count == 0) {
+            return;
+        }
+        TakeBatch(&batch_frame);
+    }
+    SendFrame(batch_frame);
+}
+
+// 取出批量缓冲区中的请求：只有一个请求时原样发送，不加批量帧的外层头部
+void ZrpcMuxConnection::TakeBatch(std::string *frame) {
+    if (m_batch_count == 1) {
+        frame->swap(m_batch);
+    } else if (!ZrpcCodec::EncodeBatchRequest(m_batch, m_batch_count, frame)) {
+        LOG(ERROR) << "encode batch request error: " << m_endpoint;  // 只有外层头部需要序列化，不会失败
+    }
+    m_batch.clear();
+    m_batch_count = 0;
+    m_batch_generation++;  // 使这一批已安排的延迟发送失效
+}
+
+// 同步调用：在异步调用的基础上等待结果，超时由时间轮上的定时器触发
+Zrpc::RpcErrorCode ZrpcMuxConnection::Call(uint64_t request_id, const std::string &frame, int timeout_ms,
+                                           std::string *body, std::string *errtxt, const ZrpcBatchPolicy *batch) {
+    struct Waiter
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        Zrpc::RpcErrorCode code = Zrpc::RPC_OK;
+        std::string body;
+        std::string errtxt;
+    };
+    auto waiter = std::make_shared<Waiter>();
+
+    CallAsync(request_id, frame, timeout_ms,
+              [waiter](Zrpc::RpcErrorCode code, const char *data, size_t len, const std::string &reason) {
+                  std::lock_guard<std::mutex> lock(waiter->mutex);
+                  waiter->code = code;
+                  if (code == Zrpc::RPC_OK) {
+                      waiter->body.assign(data, len);
+                  } else {
+                      waiter->errtxt = reason;
+                  }
+                  waiter->finished = true;
+                  waiter->cv.notify_one();
+              },
+              batch);
+
+    std::unique_lock<std::mutex> lock(waiter->mutex);
+    waiter->cv.wait(lock, [&waiter] { return waiter->finished; });
+    if (waiter->code != Zrpc::RPC_OK) {
+        *errtxt = waiter->errtxt;
+        return waiter->code;
+    }
+    body->swap(waiter->body);
+    return Zrpc::RPC_OK;
+}
+
+// 建立到服务端的连接（连接阶段带超时），返回非阻塞的fd
+int ZrpcMuxConnection::Connect(const std::string &ip, uint16_t port, int timeout_ms, const std::string &unix_path) {
+    if (!unix_path.empty()) {
+        int fd = ZrpcUnixSocket::Connect(unix_path, timeout_ms);
+        if (fd >= 0) {
+            return fd;
+        }
+        LOG(WARNING) << "fall back to tcp: " << ip << ":" << port;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == fd) {
+        LOG(ERROR) << "socket error: " << strerror(errno);
+        return -1;
+    }
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    server_addr.sin_addr.s_addr = inet_addr(ip.c_str());
+
+    int result = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+    if (result != 0 && errno == EINPROGRESS) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, timeout_ms) > 0) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+                result = 0;
+            }
+        }
+    }
+    if (result != 0) {
+        close(fd);
+        LOG(ERROR) << "connect " << ip << ":" << port << " timeout or error";
+        return -1;
+    }
+    return fd;
+}
+
+// 可读事件：读取所有可读数据，解析出完整的响应帧并分发
+void ZrpcMuxConnection::HandleRead() {
+    while (true) {
+        int saved_errno = 0;
+        ssize_t n = m_input.ReadFd(m_fd, &saved_errno);
+        if (n > 0) continue;
+        if (n < 0 && saved_errno == EINTR) continue;
+        if (n < 0 && (saved_errno == EAGAIN || saved_errno == EWOULDBLOCK)) break;
+        HandleClose("connection closed: " + m_endpoint);  // 对端关闭或出错
+        return;
+    }
+
+    // 一次读取可能包含多个响应帧，也可能只有半个；不完整的帧留在缓冲区等待下次读取
+    ssize_t consumed = ParseResponses(m_input.Peek(), m_input.ReadableBytes());
+    if (consumed > 0) {
+        m_input.Retrieve(consumed);
+    }
+}
+
+// io_uring引擎收到数据：没有遗留的半帧时直接在内核填充的缓冲区上解析，只把末尾不完整的帧拷进接收缓冲区
+void ZrpcMuxConnection::HandleData(const char *data, size_t len) {
+    if (m_input.ReadableBytes() == 0) {
+        ssize_t consumed = ParseResponses(data, len);
+        if (consumed >= 0 && static_cast<size_t>(consumed) < len) {
+            m_input.Append(data + consumed, len - consumed);
+        }
+        return;
+    }
+    m_input.Append(data, len);
+    ssize_t consumed = ParseResponses(m_input.Peek(), m_input.ReadableBytes());
+    if (consumed > 0) {
+        m_input.Retrieve(consumed);
+    }
+}
+
+ssize_t ZrpcMuxConnection::ParseResponses(const char *data, size_t len) {
+    size_t offset = 0;
+    while (offset < len) {
+        Zrpc::RpcResponseHeader header;
+        const char *body = nullptr;
+        int frame_len = ZrpcCodec::DecodeResponse(data + offset, len - offset, &header, &body);
+        if (frame_len == 0) break;
+        if (frame_len < 0) {
+            LOG(ERROR) << "malformed response from " << m_endpoint;
+            HandleClose("malformed response from " + m_endpoint);
+            return -1;
+        }
+
+        if (!DispatchFrame(header, body)) {
+            LOG(ERROR) << "malformed batch response from " << m_endpoint;
+            HandleClose("malformed response from " + m_endpoint);
+            return -1;
+        }
+        offset += frame_len;
+    }
+    return static_cast<ssize_t>(offset);
+}
+
+bool ZrpcMuxConnection::TakeOutput(std::string *out) {
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    if (m_output.empty()) {
+        return false;
+    }
+    out->swap(m_output);
+    m_output.clear();
+    return true;
+}
+
+// 批量响应帧：逐个解析内层的响应帧并分发
+bool ZrpcMuxConnection::DispatchFrame(const Zrpc::RpcResponseHeader &header, const char *body) {
+    if (header.batch_count() == 0) {
+        DispatchResponse(header, body);
+        return true;
+    }
+    const char *inner = body;
+    size_t remaining = header.body_size();
+    while (remaining > 0) {
+        Zrpc::RpcResponseHeader inner_header;
+        const char *inner_body = nullptr;
+        int inner_len = ZrpcCodec::DecodeResponse(inner, remaining, &inner_header, &inner_body);
+        if (inner_len <= 0 || inner_header.batch_count() != 0) {
+            return false;
+        }
+        DispatchResponse(inner_header, inner_body);
+        inner += inner_len;
+        remaining -= inner_len;
+    }
+    return true;
+}
+
+// 把一个响应交给对应的调用，压缩过的响应体先解压
+void ZrpcMuxConnection::DispatchResponse(const Zrpc::RpcResponseHeader &header, const char *body) {
+    m_peer_compress_mask.store(header.accept_compress(), std::memory_order_relaxed);
+
+    PendingCall call;
+    if (!RemovePending(header.request_id(), &call)) {
+        // 调用方已超时放弃，丢弃迟到的响应
+        LOG(WARNING) << "discard response for unknown request_id " << header.request_id() << " from " << m_endpoint;
+    } else if (header.error_code() != Zrpc::RPC_OK) {
+        call.done(header.error_code(), nullptr, 0, header.error_text());
+    } else if (header.compress_type() != Zrpc::COMPRESS_NONE) {
+        std::string raw;
+        if (!ZrpcCompression::Decompress(header.compress_type(), body, header.body_size(), &raw)) {
+            call.done(Zrpc::RPC_INTERNAL_ERROR, nullptr, 0,
+                      std::string("decompress response error: ") + ZrpcCompression::Name(header.compress_type()));
+            return;
+        }
+        call.done(Zrpc::RPC_OK, raw.data(), raw.size(), "");
+    } else {
+        call.done(Zrpc::RPC_OK, body, header.body_size(), "");  // 响应体直接指向接收缓冲区
+    }
+}
+
+// 可写事件：继续发送输出缓冲区中的数据
+void ZrpcMuxConnection::HandleWrite() {
+    std::unique_lock<std::mutex> lock(m_send_mutex);
+    while (!m_output.empty()) {
+        ssize_t n = send(m_fd, m_output.data(), m_output.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;  // 等待下一次可写事件
+            m_output.clear();
+            lock.unlock();
+            HandleClose("send error: " + m_endpoint);
+            return;
+        }
+        m_output.erase(0, n);
+    }
+    ZrpcClientReactor::GetInstance().EnableWriting(m_fd, false);
+}
+
+// 调用的超时定时器到期：调用方不再等待，迟到的响应会被丢弃
+void ZrpcMuxConnection::OnTimeout(uint64_t request_id, int timeout_ms) {
+    PendingCall call;
+    if (RemovePending(request_id, &call)) {
+        call.done(Zrpc::RPC_DEADLINE_EXCEEDED, nullptr, 0,
+                  "RPC call timeout after " + std::to_string(timeout_ms) + "ms: " + m_endpoint);
+    }
+}
+
+void ZrpcMuxConnection::HandleClose(const std::string &reason) {
+    m_closed = true;
+    ZrpcClientReactor::GetInstance().RemoveConnection(m_fd);
+    FailAll(reason);
+}
+
+void ZrpcMuxConnection::FailAll(const std::string &reason) {
+    std::unordered_map<uint64_t, PendingCall> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        pending.swap(m_pending);
+    }
+    for (auto &item : pending) {
+        ZrpcClientReactor::GetInstance().CancelTimer(item.second.timer);
+        item.second.done(Zrpc::RPC_UNAVAILABLE, nullptr, 0, reason);
+    }
+}
+
+void ZrpcMuxConnection::FailPending(uint64_t request_id, Zrpc::RpcErrorCode code, const std::string &reason) {
+    PendingCall call;
+    if (RemovePending(request_id, &call)) {
+        call.done(code, nullptr, 0, reason);
+    }
+}
+
+bool ZrpcMuxConnection::Cancel(uint64_t request_id) {
+    PendingCall call;
+    return RemovePending(request_id, &call);
+}
+
+bool ZrpcMuxConnection::RemovePending(uint64_t request_id, PendingCall *call) {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    auto it = m_pending.find(request_id);
+    if (it == m_pending.end()) {
+        return false;
+    }
+    *call = std::move(it->second);
+    m_pending.erase(it);
+    ZrpcClientReactor::GetInstance().CancelTimer(call->timer);  // 超时触发时定时器已经到期，取消不会生效
+    return true;
+}
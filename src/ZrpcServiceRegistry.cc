@@ -0,0 +1,332 @@
+#include "ZrpcServiceRegistry.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+
+// 按地址排序，保证各客户端看到的实例顺序一致
+void SortEndpoints(ZrpcEndpointList *endpoints) {
+    std::sort(endpoints->begin(), endpoints->end(), [](const ZrpcEndpoint &a, const ZrpcEndpoint &b) {
+        return a.ip != b.ip ? a.ip < b.ip : a.port < b.port;
+    });
+}
+
+}  // namespace
+
+ZrpcServiceRegistry &ZrpcServiceRegistry::GetInstance() {
+    static ZrpcServiceRegistry instance;
+    return instance;
+}
+
+ZrpcServiceRegistry::ZrpcServiceRegistry()
+    : m_snapshot(std::make_shared<const EndpointMap>()), m_session_expired(false) {}
+
+// 查询提供该方法的所有实例
+std::shared_ptr<const ZrpcEndpointList> ZrpcServiceRegistry::Lookup(const std::string &service_name, const std::string &method_name) {
+    std::string method_path = "/" + service_name + "/" + method_name;  // 构造ZooKeeper路径
+
+    // 快路径：直接读取当前快照
+    if (!m_session_expired) {
+        std::shared_ptr<const EndpointMap> snapshot = LoadSnapshot();
+        auto it = snapshot->find(method_path);
+        if (it != snapshot->end()) {
+            return it->second;
+        }
+    }
+
+    // 慢路径：首次查询该方法或会话已过期，查询ZooKeeper并注册watcher
+    std::lock_guard<std::mutex> lock(m_update_mutex);
+    EnsureSession();
+    std::shared_ptr<const EndpointMap> snapshot = LoadSnapshot();
+    auto it = snapshot->find(method_path);
+    if (it != snapshot->end()) {  // 等锁期间已被其他线程加载
+        return it->second;
+    }
+
+    auto endpoints = std::make_shared<ZrpcEndpointList>();
+    if (!FetchAndWatch(method_path, endpoints.get())) {
+        LOG(ERROR) << method_path + " is not exist!";  // 记录错误日志
+        return nullptr;
+    }
+    // 没有实例时也缓存空列表，实例上线后由watcher刷新
+    std::shared_ptr<const ZrpcEndpointList> result = std::move(endpoints);
+    Publish(method_path, result);
+    return result;
+}
+
+// 并行预解析：所有查询一次性发出，由ZooKeeper的回调线程逐个完成，总耗时约为一次往返而不是每个方法一次
+bool ZrpcServiceRegistry::Prefetch(const std::vector<std::pair<std::string, std::string>> &methods, int timeout_ms,
+                                   std::vector<std::string> *failed) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0);
+    auto batch = std::make_shared<PrefetchBatch>();
+    {
+        // 持有m_update_mutex发出查询，完成回调要等到这里释放锁后才能更新快照
+        std::lock_guard<std::mutex> lock(m_update_mutex);
+        EnsureSession();
+        std::shared_ptr<const EndpointMap> snapshot = LoadSnapshot();
+        for (const auto &method : methods) {
+            std::string method_path = "/" + method.first + "/" + method.second;
+            if (snapshot->count(method_path) > 0) {
+                continue;  // 已缓存，由watcher保持最新
+            }
+            {
+                std::lock_guard<std::mutex> batch_lock(batch->mutex);
+                if (!batch->pending.insert(method_path).second) {
+                    continue;  // 同一方法出现多次
+                }
+            }
+            PrefetchRequest *request = new PrefetchRequest{method_path, batch};
+            if (!m_zkclient->AsyncGetChildrenWatch(method_path.c_str(), &ZrpcServiceRegistry::ChildrenWatcher, this,
+                                                   &ZrpcServiceRegistry::PrefetchCompletion, request)) {
+                delete request;
+                std::lock_guard<std::mutex> batch_lock(batch->mutex);
+                batch->pending.erase(method_path);
+                batch->failed.push_back(method_path);
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> batch_lock(batch->mutex);
+    batch->cv.wait_until(batch_lock, deadline, [&batch] { return batch->pending.empty(); });
+    // 超时的查询仍在进行，完成后照常更新快照
+    batch->failed.insert(batch->failed.end(), batch->pending.begin(), batch->pending.end());
+    if (failed != nullptr) {
+        failed->insert(failed->end(), batch->failed.begin(), batch->failed.end());
+    }
+    return batch->failed.empty();
+}
+
+std::shared_ptr<const ZrpcServiceRegistry::EndpointMap> ZrpcServiceRegistry::LoadSnapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+// 拷贝当前快照，修改后整体替换
+void ZrpcServiceRegistry::Publish(const std::string &method_path, std::shared_ptr<const ZrpcEndpointList> endpoints) {
+    auto next = std::make_shared<EndpointMap>(*LoadSnapshot());
+    if (endpoints) {
+        (*next)[method_path] = std::move(endpoints);
+    } else {
+        next->erase(method_path);
+    }
+    std::atomic_store(&m_snapshot, std::shared_ptr<const EndpointMap>(std::move(next)));
+}
+
+// 确保ZooKeeper会话可用
+void ZrpcServiceRegistry::EnsureSession() {
+    if (m_zkclient && !m_session_expired) {
+        return;
+    }
+
+    bool reconnect = (m_zkclient != nullptr);
+    m_zkclient.reset(new ZkClient());
+    m_zkclient->Start();  // 连接ZooKeeper服务器，整个进程只保留这一个会话
+    m_session_expired = false;
+    if (!reconnect) {
+        return;
+    }
+
+    // 会话过期后watcher全部失效，重新拉取已缓存的路径并注册watcher；拉取失败的保留旧实例列表
+    LOG(WARNING) << "zookeeper session expired, refreshing service registry";
+    auto next = std::make_shared<EndpointMap>(*LoadSnapshot());
+    for (auto &item : *next) {
+        auto endpoints = std::make_shared<ZrpcEndpointList>();
+        if (FetchAndWatch(item.first, endpoints.get())) {
+            item.second = std::move(endpoints);
+        }
+    }
+    std::atomic_store(&m_snapshot, std::shared_ptr<const EndpointMap>(std::move(next)));
+}
+
+bool ZrpcServiceRegistry::FetchAndWatch(const std::string &method_path, ZrpcEndpointList *endpoints) {
+    std::vector<std::string> children;
+    if (!m_zkclient->GetChildrenWatch(method_path.c_str(), &ZrpcServiceRegistry::ChildrenWatcher, this, &children)) {
+        return false;
+    }
+
+    for (const std::string &name : children) {
+        ZrpcEndpoint endpoint;
+        if (!ParseEndpoint(name, &endpoint)) {
+            LOG(ERROR) << method_path + "/" + name + " address is invalid!";  // 记录错误日志
+            continue;
+        }
+        std::string data = m_zkclient->GetData((method_path + "/" + name).c_str());
+        ParseInstanceData(data.data(), static_cast<int>(data.size()), &endpoint);
+        endpoints->push_back(std::move(endpoint));
+    }
+    SortEndpoints(endpoints);
+    return true;
+}
+
+// 解析 "ip:port" 格式的子节点名
+bool ZrpcServiceRegistry::ParseEndpoint(const std::string &name, ZrpcEndpoint *endpoint) {
+    size_t idx = name.rfind(":");  // 查找IP和端口的分隔符
+    if (idx == std::string::npos) {
+        return false;
+    }
+    endpoint->ip = name.substr(0, idx);
+    endpoint->port = static_cast<uint16_t>(atoi(name.substr(idx + 1).c_str()));
+    if (endpoint->ip.empty() || endpoint->port == 0) {
+        return false;
+    }
+    endpoint->stats = ZrpcEndpointStats::ForAddress(name);  // 同一地址的调用统计在进程内共享
+    endpoint->address_hash = ZrpcLoadBalancer::Hash(name.data(), name.size());
+    return true;
+}
+
+// 解析 "key=value;key=value" 格式的节点数据，不认识的属性忽略，缺省的属性保持默认值
+void ZrpcServiceRegistry::ParseInstanceData(const char *data, int len, ZrpcEndpoint *endpoint) {
+    if (data == nullptr || len <= 0) {
+        return;
+    }
+    std::string instance_data(data, len);
+    std::string unix_path;
+    std::string shm_path;
+    std::string host;
+    size_t begin = 0;
+    while (begin < instance_data.size()) {
+        size_t end = instance_data.find(';', begin);
+        if (end == std::string::npos) {
+            end = instance_data.size();
+        }
+        std::string item = instance_data.substr(begin, end - begin);
+        size_t idx = item.find('=');
+        begin = end + 1;
+        if (idx == std::string::npos) {
+            continue;
+        }
+        std::string key = item.substr(0, idx);
+        std::string value = item.substr(idx + 1);
+        if (key == "weight") {
+            int weight = atoi(value.c_str());
+            endpoint->weight = weight > 0 ? weight : 0;
+        } else if (key == "unix") {
+            unix_path = value;
+        } else if (key == "shm") {
+            shm_path = value;
+        } else if (key == "host") {
+            host = value;
+        }
+    }
+    // 只有同一主机上的实例才能通过它的Unix域套接字连接、与它共享内存
+    if (!host.empty() && host == ZrpcUnixSocket::LocalHostId()) {
+        endpoint->unix_path = unix_path;
+        endpoint->shm_path = shm_path;
+    }
+}
+
+// 子节点变化通知：异步重新拉取子节点列表并再次注册watcher（watcher是一次性的）
+void ZrpcServiceRegistry::ChildrenWatcher(zhandle_t *zh, int type, int state, const char *path, void *watcher_ctx) {
+    ZrpcServiceRegistry *registry = static_cast<ZrpcServiceRegistry *>(watcher_ctx);
+
+    if (type == ZOO_SESSION_EVENT) {
+        if (state == ZOO_EXPIRED_SESSION_STATE) {
+            registry->m_session_expired = true;  // 下次查询时重建会话
+        }
+        return;
+    }
+
+    if (type == ZOO_CHILD_EVENT) {
+        LOG(INFO) << "service registry refresh: " << path;
+        zoo_awget_children(zh, path, &ZrpcServiceRegistry::ChildrenWatcher, registry,
+                           &ZrpcServiceRegistry::ChildrenCompletion, new std::string(path));
+    } else if (type == ZOO_DELETED_EVENT) {
+        // 方法节点被删除，从快照中移除，下次查询时重新到ZooKeeper查找
+        LOG(WARNING) << "service offline: " << path;
+        std::lock_guard<std::mutex> lock(registry->m_update_mutex);
+        registry->Publish(path, nullptr);
+    }
+}
+
+// 子节点列表拉取完成
+void ZrpcServiceRegistry::ChildrenCompletion(int rc, const struct String_vector *strings, const void *data) {
+    std::unique_ptr<const std::string> method_path(static_cast<const std::string *>(data));
+    GetInstance().UpdateChildren(*method_path, rc, strings);
+}
+
+// Prefetch发出的查询完成：更新快照后通知等待的调用方
+void ZrpcServiceRegistry::PrefetchCompletion(int rc, const struct String_vector *strings, const void *data) {
+    std::unique_ptr<const PrefetchRequest> request(static_cast<const PrefetchRequest *>(data));
+    GetInstance().UpdateChildren(request->method_path, rc, strings);
+
+    PrefetchBatch &batch = *request->batch;
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (batch.pending.erase(request->method_path) > 0 && (rc != ZOK || strings == nullptr)) {
+        LOG(ERROR) << request->method_path + " is not exist!";
+        batch.failed.push_back(request->method_path);
+    }
+    batch.cv.notify_all();
+}
+
+// 已知实例沿用原有属性，新实例先按默认属性加入，再异步拉取其节点数据
+void ZrpcServiceRegistry::UpdateChildren(const std::string &method_path, int rc, const struct String_vector *strings) {
+    std::lock_guard<std::mutex> lock(m_update_mutex);
+    if (rc != ZOK || strings == nullptr) {
+        Publish(method_path, nullptr);
+        return;
+    }
+
+    std::shared_ptr<const EndpointMap> snapshot = LoadSnapshot();
+    auto it = snapshot->find(method_path);
+    std::shared_ptr<const ZrpcEndpointList> current = it != snapshot->end() ? it->second : nullptr;
+
+    auto endpoints = std::make_shared<ZrpcEndpointList>();
+    for (int i = 0; i < strings->count; ++i) {
+        std::string name = strings->data[i];
+        ZrpcEndpoint endpoint;
+        if (!ParseEndpoint(name, &endpoint)) {
+            continue;
+        }
+
+        bool known = false;
+        if (current) {
+            for (const ZrpcEndpoint &old_endpoint : *current) {
+                if (old_endpoint.ip == endpoint.ip && old_endpoint.port == endpoint.port) {
+                    endpoint.weight = old_endpoint.weight;
+                    endpoint.unix_path = old_endpoint.unix_path;
+                    endpoint.shm_path = old_endpoint.shm_path;
+                    known = true;
+                    break;
+                }
+            }
+        }
+        if (!known && m_zkclient) {
+            std::string instance_path = method_path + "/" + name;
+            m_zkclient->AsyncGetData(instance_path.c_str(), &ZrpcServiceRegistry::InstanceDataCompletion,
+                                     new std::string(instance_path));
+        }
+        endpoints->push_back(std::move(endpoint));
+    }
+    SortEndpoints(endpoints.get());
+    LOG(INFO) << method_path << " instances: " << endpoints->size();
+    Publish(method_path, std::move(endpoints));
+}
+
+// 新实例的节点数据拉取完成，更新该实例的属性
+void ZrpcServiceRegistry::InstanceDataCompletion(int rc, const char *value, int value_len, const struct Stat * /*stat*/, const void *data) {
+    std::unique_ptr<const std::string> instance_path(static_cast<const std::string *>(data));
+    if (rc != ZOK) {
+        return;  // 实例已下线，子节点watcher会刷新列表
+    }
+    size_t idx = instance_path->rfind('/');
+    std::string method_path = instance_path->substr(0, idx);
+    std::string name = instance_path->substr(idx + 1);
+
+    ZrpcServiceRegistry &registry = GetInstance();
+    std::lock_guard<std::mutex> lock(registry.m_update_mutex);
+    std::shared_ptr<const EndpointMap> snapshot = registry.LoadSnapshot();
+    auto it = snapshot->find(method_path);
+    if (it == snapshot->end()) {
+        return;
+    }
+
+    auto endpoints = std::make_shared<ZrpcEndpointList>(*it->second);
+    for (ZrpcEndpoint &endpoint : *endpoints) {
+        if (endpoint.Address() == name) {
+            ParseInstanceData(value, value_len, &endpoint);
+        }
+    }
+    registry.Publish(method_path, std::move(endpoints));
+}
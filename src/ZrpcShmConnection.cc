@@ -0,0 +1,122 @@
+#include "ZrpcShmConnection.h"
+#include "ZrpcClientReactor.h"
+#include "ZrpcCodec.h"
+#include "ZrpcLogger.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+std::mutex g_shm_mutex;  // 保护连接表
+std::unordered_map<std::string, std::shared_ptr<ZrpcShmConnection>> g_shm_connections;  // path -> 共享连接
+std::unordered_map<std::string, std::chrono::steady_clock::time_point> g_shm_failures;    // path -> 最近一次握手失败的时间
+}
+
+// 获取到指定服务端的共享内存连接
+std::shared_ptr<ZrpcShmConnection> ZrpcShmConnection::GetConnection(const std::string &path, int timeout_ms) {
+    {
+        std::lock_guard<std::mutex> lock(g_shm_mutex);
+        auto it = g_shm_connections.find(path);
+        if (it != g_shm_connections.end() && !it->second->IsClosed()) {
+            return it->second;
+        }
+        auto fit = g_shm_failures.find(path);
+        if (fit != g_shm_failures.end() &&
+            std::chrono::steady_clock::now() - fit->second < std::chrono::milliseconds(kRetryIntervalMs)) {
+            return nullptr;
+        }
+    }
+
+    // 在锁外握手，与ZrpcMuxConnection::GetConnection相同
+    int control_fd = -1;
+    std::unique_ptr<ZrpcShmLink> link = ZrpcShmLink::Connect(path, ZrpcShmLink::kDefaultCapacity, timeout_ms, &control_fd);
+    std::lock_guard<std::mutex> lock(g_shm_mutex);
+    if (!link) {
+        g_shm_failures[path] = std::chrono::steady_clock::now();
+        return nullptr;
+    }
+    auto it = g_shm_connections.find(path);
+    if (it != g_shm_connections.end() && !it->second->IsClosed()) {
+        close(control_fd);  // 其他线程已经建好了连接，本次创建的共享内存随link释放
+        return it->second;
+    }
+
+    int wait_fd = link->WaitFd();
+    auto conn = std::make_shared<ZrpcShmConnection>(control_fd, "shm:" + path, std::move(link));
+    ZrpcClientReactor &reactor = ZrpcClientReactor::GetInstance();
+    if (!reactor.AddConnection(conn)) {
+        return nullptr;
+    }
+    if (!reactor.AddConnection(conn, wait_fd)) {
+        reactor.RemoveConnection(control_fd);
+        return nullptr;
+    }
+    g_shm_connections[path] = conn;
+    g_shm_failures.erase(path);
+    LOG(INFO) << "shared memory connection established: " << path;
+    return conn;
+}
+
+ZrpcShmConnection::ZrpcShmConnection(int control_fd, const std::string &endpoint, std::unique_ptr<ZrpcShmLink> link)
+    : ZrpcMuxConnection(control_fd, endpoint), m_link(std::move(link)) {}
+
+// 请求直接编码到发往服务端的环上
+void ZrpcShmConnection::CallAsync(uint64_t request_id, const std::string &service_name, const std::string &method_name,
+                                  const google::protobuf::Message &request, int timeout_ms, Completion done,
+                                  Zrpc::RpcPriority priority) {
+    if (!AddPending(request_id, timeout_ms, std::move(done))) {
+        return;
+    }
+    bool sent = m_link->Send([&](const ZrpcCodec::FrameAllocator &alloc) {
+        return ZrpcCodec::EncodeRequest(service_name, method_name, request_id, request, alloc, static_cast<uint32_t>(timeout_ms), nullptr, priority);
+    });
+    if (!sent) {
+        FailPending(request_id, Zrpc::RPC_INTERNAL_ERROR, "send request over shared memory error: " + m_endpoint);
+    }
+}
+
+// 已编码好的帧拷贝到环上；服务端长时间不接收（溢出队列超过上限）时关闭连接，与套接字发送出错的处理相同
+void ZrpcShmConnection::SendFrame(const std::string &frame) {
+    if (!m_link->SendFrame(frame)) {
+        LOG(ERROR) << "send over shared memory error: " << m_endpoint;
+        shutdown(m_fd, SHUT_RDWR);
+    }
+}
+
+// 保留的套接字或门铃可读：先确认服务端还在，再处理环中的响应，响应体直接在共享内存上解析
+void ZrpcShmConnection::HandleRead() {
+    if (m_closed) {
+        return;
+    }
+    char buf[64];
+    ssize_t n = recv(m_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        HandleClose("connection closed: " + m_endpoint);
+        return;
+    }
+
+    bool malformed = false;
+    bool ok = m_link->Poll([this, &malformed](const char *data, size_t len) {
+        if (malformed) {
+            return;
+        }
+        Zrpc::RpcResponseHeader header;
+        const char *body = nullptr;
+        int frame_len = ZrpcCodec::DecodeResponse(data, len, &header, &body);
+        if (frame_len <= 0 || static_cast<size_t>(frame_len) != len || !DispatchFrame(header, body)) {
+            malformed = true;
+        }
+    });
+    if (!ok || malformed) {
+        LOG(ERROR) << "malformed response from " << m_endpoint;
+        HandleClose("malformed response from " + m_endpoint);
+    }
+}
+
+void ZrpcShmConnection::HandleClose(const std::string &reason) {
+    ZrpcClientReactor::GetInstance().RemoveConnection(m_link->WaitFd());
+    ZrpcMuxConnection::HandleClose(reason);
+}
@@ -0,0 +1,465 @@
+#include "ZrpcShmRing.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared memory ring requires lock-free atomics");
+
+namespace {
+
+const uint32_t kShmMagic = 0x4d48535a;  // "ZSHM"
+const uint32_t kShmVersion = 1;
+const char kHandshakeAck = 'K';
+const uint32_t kMinCapacity = 4096;
+
+// 共享内存的布局：段头 | 两个环的控制块（调用方到服务端、服务端到调用方）| 两个环的数据区
+struct SegmentHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;  // 每个环的容量
+};
+const size_t kSegmentHeaderSize = 64;
+
+// 握手消息，随fd一起发给服务端
+struct Handshake
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+size_t SegmentSize(uint32_t capacity) {
+    return kSegmentHeaderSize + 2 * (sizeof(ZrpcShmRing::Control) + capacity);
+}
+
+// 门铃必须是eventfd：服务端会把它加入epoll，并按eventfd的语义读写
+bool IsEventFd(int fd) {
+    char link[64] = {0};
+    std::string path = "/proc/self/fd/" + std::to_string(fd);
+    ssize_t n = readlink(path.c_str(), link, sizeof(link) - 1);
+    return n > 0 && strcmp(link, "anon_inode:[eventfd]") == 0;
+}
+
+}  // namespace
+
+ZrpcShmRing::ZrpcShmRing()
+    : m_control(nullptr), m_data(nullptr), m_capacity(0), m_tail(0), m_reserved_tail(0), m_reserved_header(nullptr),
+      m_head(0), m_next_head(0) {}
+
+void ZrpcShmRing::Init(Control *control, char *data, uint32_t capacity) {
+    m_control = control;
+    m_data = data;
+    m_capacity = capacity;
+    m_tail = control->tail.load(std::memory_order_acquire);
+    m_head = control->head.load(std::memory_order_acquire);
+}
+
+// 写入len字节的记录需要的空间：环尾剩余的连续空间放不下时，还要算上填充掉的部分
+bool ZrpcShmRing::HasSpace(uint64_t tail, size_t len) const {
+    uint64_t used = tail - m_control->head.load(std::memory_order_acquire);
+    if (used > m_capacity) {
+        return false;  // head被对端写坏，不再写入
+    }
+    size_t offset = tail & (m_capacity - 1);
+    size_t record = RecordSize(len);
+    size_t need = record <= m_capacity - offset ? record : (m_capacity - offset) + record;
+    return need <= m_capacity - used;
+}
+
+char *ZrpcShmRing::BeginWrite(size_t len) {
+    if (len > MaxRecordSize() || !HasSpace(m_tail, len)) {
+        return nullptr;
+    }
+    uint64_t tail = m_tail;
+    size_t offset = tail & (m_capacity - 1);
+    size_t record = RecordSize(len);
+    if (record > m_capacity - offset) {
+        // 环尾放不下，写一条填充记录，与这条记录一起发布
+        uint32_t header[2] = {static_cast<uint32_t>(m_capacity - offset - kRecordHeaderSize), kFlagPadding};
+        memcpy(m_data + offset, header, sizeof(header));
+        tail += m_capacity - offset;
+        offset = 0;
+    }
+    m_reserved_header = m_data + offset;
+    uint32_t length = static_cast<uint32_t>(len);
+    memcpy(m_reserved_header, &length, sizeof(length));
+    m_reserved_tail = tail + record;
+    return m_reserved_header + kRecordHeaderSize;
+}
+
+bool ZrpcShmRing::EndWrite(uint32_t flags) {
+    memcpy(m_reserved_header + sizeof(uint32_t), &flags, sizeof(flags));
+    m_tail = m_reserved_tail;
+    m_control->tail.store(m_tail, std::memory_order_release);
+    // 与ArmConsumer配对：要么消费者看到新的tail，要么这里看到消费者准备睡眠
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_control->consumer_waiting.load(std::memory_order_relaxed) != 0 &&
+           m_control->consumer_waiting.exchange(0, std::memory_order_relaxed) != 0;
+}
+
+bool ZrpcShmRing::ArmProducer(size_t len) {
+    m_control->producer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (HasSpace(m_tail, len)) {
+        m_control->producer_waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+int ZrpcShmRing::Peek(const char **data, size_t *len, uint32_t *flags) {
+    while (true) {
+        uint64_t tail = m_control->tail.load(std::memory_order_acquire);
+        if (tail == m_head) {
+            return 0;
+        }
+        if (tail - m_head > m_capacity) {
+            return -1;
+        }
+        size_t offset = m_head & (m_capacity - 1);
+        uint32_t header[2];
+        memcpy(header, m_data + offset, sizeof(header));  // 先拷贝出来再检查，对端之后再改也不会越界
+
+        if (header[1] & kFlagPadding) {
+            // 填充记录总是和其后的记录一起发布
+            m_head += m_capacity - offset;
+            if (m_head > tail) {
+                return -1;
+            }
+            m_control->head.store(m_head, std::memory_order_release);
+            continue;
+        }
+
+        size_t record = RecordSize(header[0]);
+        if (header[0] > MaxRecordSize() || record > m_capacity - offset || record > tail - m_head) {
+            return -1;
+        }
+        *data = m_data + offset + kRecordHeaderSize;
+        *len = header[0];
+        *flags = header[1];
+        m_next_head = m_head + record;
+        return 1;
+    }
+}
+
+bool ZrpcShmRing::Consume() {
+    m_head = m_next_head;
+    m_control->head.store(m_head, std::memory_order_release);
+    // 与ArmProducer配对
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_control->producer_waiting.load(std::memory_order_relaxed) != 0 &&
+           m_control->producer_waiting.exchange(0, std::memory_order_relaxed) != 0;
+}
+
+bool ZrpcShmRing::ArmConsumer() {
+    m_control->consumer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_control->tail.load(std::memory_order_acquire) != m_head) {
+        m_control->consumer_waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+ZrpcShmLink::ZrpcShmLink()
+    : m_memfd(-1), m_wait_fd(-1), m_notify_fd(-1), m_base(nullptr), m_size(0), m_overflow_bytes(0), m_overflow_offset(0) {}
+
+ZrpcShmLink::~ZrpcShmLink() {
+    if (m_base != nullptr) {
+        munmap(m_base, m_size);
+    }
+    if (m_memfd >= 0) {
+        close(m_memfd);
+    }
+    if (m_wait_fd >= 0) {
+        close(m_wait_fd);
+    }
+    if (m_notify_fd >= 0) {
+        close(m_notify_fd);
+    }
+}
+
+bool ZrpcShmLink::Map(size_t size) {
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_memfd, 0);
+    if (base == MAP_FAILED) {
+        LOG(ERROR) << "mmap shared memory error: " << strerror(errno);
+        return false;
+    }
+    m_base = static_cast<char *>(base);
+    m_size = size;
+    return true;
+}
+
+// 第一个环由调用方写、服务端读，第二个环相反
+void ZrpcShmLink::InitRings(uint32_t capacity, bool server) {
+    ZrpcShmRing::Control *controls = reinterpret_cast<ZrpcShmRing::Control *>(m_base + kSegmentHeaderSize);
+    char *data = m_base + kSegmentHeaderSize + 2 * sizeof(ZrpcShmRing::Control);
+    m_send.Init(&controls[server ? 1 : 0], data + (server ? capacity : 0), capacity);
+    m_recv.Init(&controls[server ? 0 : 1], data + (server ? 0 : capacity), capacity);
+}
+
+// 调用方创建共享内存和两个门铃；共享内存封住大小，服务端映射后不会因对端截断而访问越界
+std::unique_ptr<ZrpcShmLink> ZrpcShmLink::Create(uint32_t capacity) {
+    uint32_t rounded = kMinCapacity;
+    while (rounded < capacity && rounded < (1u << 30)) {
+        rounded <<= 1;
+    }
+
+    std::unique_ptr<ZrpcShmLink> link(new ZrpcShmLink);
+    link->m_memfd = memfd_create("zrpc-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    link->m_wait_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    link->m_notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (link->m_memfd < 0 || link->m_wait_fd < 0 || link->m_notify_fd < 0) {
+        LOG(ERROR) << "create shared memory error: " << strerror(errno);
+        return nullptr;
+    }
+    size_t size = SegmentSize(rounded);
+    if (ftruncate(link->m_memfd, static_cast<off_t>(size)) != 0 ||
+        fcntl(link->m_memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        LOG(ERROR) << "resize shared memory error: " << strerror(errno);
+        return nullptr;
+    }
+    if (!link->Map(size)) {
+        return nullptr;
+    }
+
+    // memfd的内容初始为0，读写位置不需要再初始化；两端的消费者一开始都在睡眠，第一条记录总会敲门铃
+    SegmentHeader header;
+    header.magic = kShmMagic;
+    header.version = kShmVersion;
+    header.capacity = rounded;
+    memcpy(link->m_base, &header, sizeof(header));
+    ZrpcShmRing::Control *controls = reinterpret_cast<ZrpcShmRing::Control *>(link->m_base + kSegmentHeaderSize);
+    controls[0].consumer_waiting.store(1, std::memory_order_relaxed);
+    controls[1].consumer_waiting.store(1, std::memory_order_relaxed);
+    link->InitRings(rounded, false);
+    return link;
+}
+
+// 服务端映射调用方传来的共享内存，检查它确实是封住大小的memfd，且布局与段头一致
+std::unique_ptr<ZrpcShmLink> ZrpcShmLink::Attach(int memfd, int server_doorbell, int client_doorbell) {
+    std::unique_ptr<ZrpcShmLink> link(new ZrpcShmLink);
+    link->m_memfd = memfd;
+    link->m_wait_fd = server_doorbell;
+    link->m_notify_fd = client_doorbell;
+
+    struct stat st;
+    int seals = fcntl(memfd, F_GET_SEALS);
+    if (fstat(memfd, &st) != 0 || seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) != (F_SEAL_SHRINK | F_SEAL_GROW)) {
+        LOG(ERROR) << "shared memory handshake: not a sealed memfd";
+        return nullptr;
+    }
+    if (!IsEventFd(server_doorbell) || !IsEventFd(client_doorbell)) {
+        LOG(ERROR) << "shared memory handshake: doorbell is not an eventfd";
+        return nullptr;
+    }
+    fcntl(server_doorbell, F_SETFL, O_NONBLOCK);
+
+    if (static_cast<size_t>(st.st_size) < kSegmentHeaderSize || !link->Map(static_cast<size_t>(st.st_size))) {
+        return nullptr;
+    }
+    SegmentHeader header;
+    memcpy(&header, link->m_base, sizeof(header));
+    if (header.magic != kShmMagic || header.version != kShmVersion || header.capacity < kMinCapacity ||
+        (header.capacity & (header.capacity - 1)) != 0 || SegmentSize(header.capacity) != link->m_size) {
+        LOG(ERROR) << "shared memory handshake: bad segment header";
+        return nullptr;
+    }
+    link->InitRings(header.capacity, true);
+    return link;
+}
+
+std::unique_ptr<ZrpcShmLink> ZrpcShmLink::Connect(const std::string &path, uint32_t capacity, int timeout_ms, int *control_fd) {
+    int fd = ZrpcUnixSocket::Connect(path, timeout_ms);
+    if (fd < 0) {
+        return nullptr;
+    }
+    std::unique_ptr<ZrpcShmLink> link = Create(capacity);
+    if (!link) {
+        close(fd);
+        return nullptr;
+    }
+
+    // 依次传递memfd、服务端的门铃（本端通知对端用）、调用方的门铃（本端等待用）
+    Handshake handshake;
+    handshake.magic = kShmMagic;
+    handshake.version = kShmVersion;
+    int fds[3] = {link->m_memfd, link->m_notify_fd, link->m_wait_fd};
+    char ack = 0;
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if (!ZrpcUnixSocket::SendFds(fd, fds, 3, &handshake, sizeof(handshake)) || poll(&pfd, 1, timeout_ms) <= 0 ||
+        recv(fd, &ack, 1, 0) != 1 || ack != kHandshakeAck) {
+        LOG(WARNING) << "shared memory handshake with " << path << " failed";
+        close(fd);
+        return nullptr;
+    }
+    *control_fd = fd;
+    return link;
+}
+
+std::unique_ptr<ZrpcShmLink> ZrpcShmLink::Accept(int control_fd) {
+    Handshake handshake;
+    int fds[3] = {-1, -1, -1};
+    int count = 0;
+    ssize_t n = ZrpcUnixSocket::RecvFds(control_fd, fds, 3, &count, &handshake, sizeof(handshake));
+    if (n != static_cast<ssize_t>(sizeof(handshake)) || count != 3 || handshake.magic != kShmMagic ||
+        handshake.version != kShmVersion) {
+        for (int i = 0; i < count; ++i) {
+            close(fds[i]);
+        }
+        if (n != 0) {
+            LOG(ERROR) << "shared memory handshake: bad request";
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<ZrpcShmLink> link = Attach(fds[0], fds[1], fds[2]);  // 失败时由link关闭收到的fd
+    if (!link || send(control_fd, &kHandshakeAck, 1, MSG_NOSIGNAL) != 1) {
+        return nullptr;
+    }
+    return link;
+}
+
+void ZrpcShmLink::Notify() {
+    uint64_t one = 1;
+    if (write(m_notify_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        LOG(ERROR) << "shared memory notify error: " << strerror(errno);
+    }
+}
+
+bool ZrpcShmLink::Send(const FrameEncoder &encode) {
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    char *reserved = nullptr;
+    bool overflow = false;
+    bool encoded = encode([this, &reserved, &overflow](size_t frame_len) -> uint8_t * {
+        // 前面还有帧在排队时不能插队
+        if (m_overflow.empty() && frame_len <= m_send.MaxRecordSize()) {
+            reserved = m_send.BeginWrite(frame_len);
+            if (reserved != nullptr) {
+                return reinterpret_cast<uint8_t *>(reserved);
+            }
+        }
+        if (m_overflow_bytes + frame_len > kMaxOverflowBytes) {
+            return nullptr;
+        }
+        m_overflow.emplace_back(frame_len, '\0');
+        m_overflow_bytes += frame_len;
+        overflow = true;
+        return reinterpret_cast<uint8_t *>(&m_overflow.back()[0]);
+    });
+    if (!encoded) {
+        if (overflow) {
+            m_overflow_bytes -= m_overflow.back().size();
+            m_overflow.pop_back();
+        }
+        return false;
+    }
+    if (reserved != nullptr) {
+        if (m_send.EndWrite(0)) {
+            Notify();
+        }
+        return true;
+    }
+    FlushOverflow();
+    return true;
+}
+
+bool ZrpcShmLink::SendFrame(const std::string &frame) {
+    return Send([&frame](const ZrpcCodec::FrameAllocator &alloc) {
+        uint8_t *target = alloc(frame.size());
+        if (target == nullptr) {
+            return false;
+        }
+        memcpy(target, frame.data(), frame.size());
+        return true;
+    });
+}
+
+// 把溢出队列中的帧分段拷贝进环，环满时登记等待，对端腾出空间后敲本端的门铃
+void ZrpcShmLink::FlushOverflow() {
+    bool wake = false;
+    while (!m_overflow.empty()) {
+        const std::string &frame = m_overflow.front();
+        size_t len = std::min(frame.size() - m_overflow_offset, m_send.MaxRecordSize());
+        char *target = m_send.BeginWrite(len);
+        if (target == nullptr) {
+            if (m_send.ArmProducer(len)) {
+                break;
+            }
+            continue;
+        }
+        memcpy(target, frame.data() + m_overflow_offset, len);
+        m_overflow_offset += len;
+        bool last = (m_overflow_offset == frame.size());
+        wake |= m_send.EndWrite(last ? 0 : ZrpcShmRing::kFlagMore);
+        if (last) {
+            m_overflow_bytes -= frame.size();
+            m_overflow.pop_front();
+            m_overflow_offset = 0;
+        }
+    }
+    if (wake) {
+        Notify();
+    }
+}
+
+bool ZrpcShmLink::Poll(const FrameHandler &handler) {
+    uint64_t value = 0;
+    if (read(m_wait_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        LOG(ERROR) << "shared memory doorbell error: " << strerror(errno);
+    }
+
+    while (true) {
+        bool wake_producer = false;
+        const char *data = nullptr;
+        size_t len = 0;
+        uint32_t flags = 0;
+        int rc;
+        while ((rc = m_recv.Peek(&data, &len, &flags)) > 0) {
+            if ((flags & ZrpcShmRing::kFlagMore) == 0 && m_partial.empty()) {
+                handler(data, len);  // 完整的帧直接在共享内存上处理，处理完再释放
+                wake_producer |= m_recv.Consume();
+                continue;
+            }
+            // 拆成多条记录的帧先拼接起来
+            if (m_partial.size() + len > 2 * static_cast<size_t>(ZrpcCodec::kMaxFrameSize)) {
+                return false;
+            }
+            m_partial.append(data, len);
+            wake_producer |= m_recv.Consume();
+            if ((flags & ZrpcShmRing::kFlagMore) == 0) {
+                std::string frame;
+                frame.swap(m_partial);
+                handler(frame.data(), frame.size());
+            }
+        }
+        if (wake_producer) {
+            Notify();
+        }
+        if (rc < 0) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_send_mutex);
+            if (!m_overflow.empty()) {
+                FlushOverflow();
+            }
+        }
+        if (m_recv.ArmConsumer()) {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,191 @@
+#include "ZrpcShmServer.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+ZrpcShmSession::ZrpcShmSession(muduo::net::EventLoop *loop, const std::string &name, int control_fd,
+                               std::unique_ptr<ZrpcShmLink> link)
+    : m_loop(loop), m_name(name), m_control_fd(control_fd), m_link(std::move(link)), m_closed(false) {}
+
+ZrpcShmSession::~ZrpcShmSession() {
+    close(m_control_fd);
+}
+
+void ZrpcShmSession::Start() {
+    // tie保证事件处理期间会话不会被释放
+    m_doorbell_channel.reset(new muduo::net::Channel(m_loop, m_link->WaitFd()));
+    m_doorbell_channel->tie(shared_from_this());
+    m_doorbell_channel->setReadCallback(std::bind(&ZrpcShmSession::HandleDoorbell, this, std::placeholders::_1));
+    m_doorbell_channel->enableReading();
+
+    m_control_channel.reset(new muduo::net::Channel(m_loop, m_control_fd));
+    m_control_channel->tie(shared_from_this());
+    m_control_channel->setReadCallback(std::bind(&ZrpcShmSession::HandleControl, this));
+    m_control_channel->setCloseCallback(std::bind(&ZrpcShmSession::HandleControl, this));
+    m_control_channel->enableReading();
+
+    // 调用方可能在握手完成后立即写入了请求，而那时还没有人等待门铃
+    HandleDoorbell(muduo::Timestamp::now());
+}
+
+// 依次处理环中的请求帧，请求在共享内存上直接解析，处理完才释放
+void ZrpcShmSession::HandleDoorbell(muduo::Timestamp receive_time) {
+    if (m_closed) {
+        return;
+    }
+    ZrpcShmSessionPtr self = shared_from_this();
+    bool ok = m_link->Poll([this, &self, receive_time](const char *data, size_t len) {
+        if (!m_closed) {
+            m_frame_callback(self, data, len, receive_time);
+        }
+    });
+    if (!ok) {
+        LOG(ERROR) << "malformed shared memory ring from " << m_name;
+        Close();
+    }
+}
+
+// 调用方不会在保留的套接字上发送数据，可读只可能是对端关闭
+void ZrpcShmSession::HandleControl() {
+    char buf[64];
+    ssize_t n = recv(m_control_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) {
+        return;
+    }
+    Close();
+}
+
+void ZrpcShmSession::Close() {
+    if (m_closed.exchange(true)) {
+        return;
+    }
+    LOG(INFO) << "shared memory session closed: " << m_name;
+    if (m_doorbell_channel) {
+        m_doorbell_channel->disableAll();
+        m_doorbell_channel->remove();
+    }
+    if (m_control_channel) {
+        m_control_channel->disableAll();
+        m_control_channel->remove();
+    }
+    if (m_close_callback) {
+        m_close_callback(shared_from_this());
+    }
+}
+
+// 发送失败（调用方长时间不接收，溢出队列超过上限）或收到格式错误的请求时关闭套接字，由IO线程在挂断事件中关闭会话
+void ZrpcShmSession::Abort(const std::string &reason) {
+    LOG(ERROR) << reason << ": " << m_name;
+    shutdown(m_control_fd, SHUT_RDWR);
+}
+
+void ZrpcShmSession::Send(const std::string &frame) {
+    if (m_closed) {
+        return;
+    }
+    if (!m_link->SendFrame(frame)) {
+        Abort("shared memory send error");
+    }
+}
+
+// 共享内存上的响应从不压缩，协商出的压缩策略不使用
+bool ZrpcShmSession::SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                                  const ZrpcCompressPolicy * /*compress*/) {
+    if (m_closed) {
+        return true;
+    }
+    return m_link->Send([request_id, &response](const ZrpcCodec::FrameAllocator &alloc) {
+        return ZrpcCodec::EncodeResponse(request_id, response, alloc);
+    });
+}
+
+ZrpcShmServer::ZrpcShmServer(muduo::net::EventLoop *loop, const std::string &path, const std::string &name)
+    : m_loop(loop), m_path(path), m_name(name), m_listenfd(-1), m_next_session_id(1) {}
+
+ZrpcShmServer::~ZrpcShmServer() {
+    if (m_accept_channel) {
+        m_accept_channel->disableAll();
+        m_accept_channel->remove();
+    }
+    if (m_listenfd >= 0) {
+        close(m_listenfd);
+        unlink(m_path.c_str());
+    }
+    for (auto &item : m_handshakes) {
+        item.second->disableAll();
+        item.second->remove();
+        close(item.first);
+    }
+    for (auto &item : m_sessions) {
+        ZrpcShmSessionPtr session = item.second;
+        session->SetCloseCallback(nullptr);
+        session->GetLoop()->runInLoop(std::bind(&ZrpcShmSession::Close, session));
+    }
+}
+
+bool ZrpcShmServer::Start(const std::shared_ptr<muduo::net::EventLoopThreadPool> &pool) {
+    m_listenfd = ZrpcUnixSocket::Listen(m_path);
+    if (m_listenfd < 0) {
+        return false;
+    }
+    m_pool = pool;
+    m_accept_channel.reset(new muduo::net::Channel(m_loop, m_listenfd));
+    m_accept_channel->setReadCallback(std::bind(&ZrpcShmServer::HandleAccept, this));
+    m_accept_channel->enableReading();
+    return true;
+}
+
+// 接受连接后等待调用方发来握手，不在这里阻塞
+void ZrpcShmServer::HandleAccept() {
+    while (true) {
+        int fd = accept4(m_listenfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG(ERROR) << "accept shared memory socket error: " << strerror(errno);
+            }
+            if (errno != EINTR) {
+                return;
+            }
+            continue;
+        }
+        std::shared_ptr<muduo::net::Channel> channel = std::make_shared<muduo::net::Channel>(m_loop, fd);
+        channel->setReadCallback(std::bind(&ZrpcShmServer::HandleHandshake, this, fd));
+        channel->setCloseCallback(std::bind(&ZrpcShmServer::HandleHandshake, this, fd));
+        channel->enableReading();
+        m_handshakes[fd] = channel;
+    }
+}
+
+void ZrpcShmServer::HandleHandshake(int fd) {
+    auto it = m_handshakes.find(fd);
+    if (it == m_handshakes.end()) {
+        return;
+    }
+    std::shared_ptr<muduo::net::Channel> channel = it->second;
+    m_handshakes.erase(it);
+    channel->disableAll();
+    channel->remove();
+    m_loop->queueInLoop([channel] {});  // 正在处理这个channel自己的事件，延后到本轮事件处理之后再释放
+
+    std::unique_ptr<ZrpcShmLink> link = ZrpcShmLink::Accept(fd);
+    if (!link) {
+        close(fd);
+        return;
+    }
+
+    muduo::net::EventLoop *io_loop = m_pool ? m_pool->getNextLoop() : m_loop;
+    std::string session_name = m_name + "-shm#" + std::to_string(m_next_session_id++);
+    ZrpcShmSessionPtr session = std::make_shared<ZrpcShmSession>(io_loop, session_name, fd, std::move(link));
+    session->SetFrameCallback(m_frame_callback);
+    session->SetCloseCallback(std::bind(&ZrpcShmServer::RemoveSession, this, std::placeholders::_1));
+    m_sessions[session_name] = session;
+    LOG(INFO) << "shared memory session established: " << session_name;
+    io_loop->runInLoop(std::bind(&ZrpcShmSession::Start, session));
+}
+
+void ZrpcShmServer::RemoveSession(const ZrpcShmSessionPtr &session) {
+    m_loop->runInLoop([this, session] { m_sessions.erase(session->Name()); });
+}
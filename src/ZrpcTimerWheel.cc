@@ -0,0 +1,184 @@
+#include "ZrpcTimerWheel.h"
+#include <algorithm>
+
+ZrpcTimerWheel::ZrpcTimerWheel()
+    : m_origin(std::chrono::steady_clock::now()),
+      m_current(0),
+      m_size(0),
+      m_slots(kRootSize + (kLevels - 1) * kLevelSize, kNil),
+      m_free(kNil) {}
+
+// 时刻换算为tick（向下取整），早于起点的时刻记为0
+int64_t ZrpcTimerWheel::ToTick(std::chrono::steady_clock::time_point when) const {
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(when - m_origin).count();
+    return ms > 0 ? ms : 0;
+}
+
+// 按距离当前tick的远近选择所在的层和槽
+int32_t ZrpcTimerWheel::SlotFor(int64_t expire) const {
+    int64_t delta = expire - m_current;
+    if (delta < 0) {
+        return static_cast<int32_t>(m_current & (kRootSize - 1));  // 已过期，放在下一个要处理的槽
+    }
+    if (delta < kRootSize) {
+        return static_cast<int32_t>(expire & (kRootSize - 1));
+    }
+    if (delta > kMaxSpan) {
+        expire = m_current + kMaxSpan;  // 超出时间轮范围，先放在最高层，转到时再重新放置
+        delta = kMaxSpan;
+    }
+    for (int level = 1; level < kLevels; ++level) {
+        int shift = kRootBits + (level - 1) * kLevelBits;
+        if (level == kLevels - 1 || delta < (int64_t(1) << (shift + kLevelBits))) {
+            return static_cast<int32_t>(kRootSize + (level - 1) * kLevelSize + ((expire >> shift) & (kLevelSize - 1)));
+        }
+    }
+    return kNil;  // 不会到达
+}
+
+void ZrpcTimerWheel::Link(int32_t index) {
+    Node &node = m_nodes[index];
+    int32_t slot = SlotFor(node.expire);
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = m_slots[slot];
+    if (node.next != kNil) {
+        m_nodes[node.next].prev = index;
+    }
+    m_slots[slot] = index;
+}
+
+void ZrpcTimerWheel::Unlink(int32_t index) {
+    Node &node = m_nodes[index];
+    if (node.prev != kNil) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_slots[node.slot] = node.next;
+    }
+    if (node.next != kNil) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = kNil;
+    node.next = kNil;
+}
+
+// 节点放回空闲链表，代数加一使旧的TimerId失效；回调应已由调用方取走
+void ZrpcTimerWheel::Release(int32_t index) {
+    Node &node = m_nodes[index];
+    node.slot = kNil;
+    node.generation++;
+    node.next = m_free;
+    m_free = index;
+    m_size--;
+}
+
+// 把第level层当前槽中的定时器向低层重新放置
+void ZrpcTimerWheel::Cascade(int level) {
+    int shift = kRootBits + (level - 1) * kLevelBits;
+    int32_t slot = static_cast<int32_t>(kRootSize + (level - 1) * kLevelSize + ((m_current >> shift) & (kLevelSize - 1)));
+    int32_t index = m_slots[slot];
+    m_slots[slot] = kNil;
+    while (index != kNil) {
+        int32_t next = m_nodes[index].next;
+        Link(index);
+        index = next;
+    }
+}
+
+ZrpcTimerWheel::TimerId ZrpcTimerWheel::Add(std::chrono::steady_clock::time_point when, Callback cb) {
+    // 到期tick向上取整，定时器不会早于when触发
+    int64_t expire = ToTick(when + std::chrono::microseconds(999));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int32_t index;
+    if (m_free != kNil) {
+        index = m_free;
+        m_free = m_nodes[index].next;
+    } else {
+        index = static_cast<int32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node &node = m_nodes[index];
+    node.expire = expire;
+    node.cb = std::move(cb);
+    Link(index);
+    m_size++;
+    return (static_cast<uint64_t>(node.generation) << 32) | static_cast<uint32_t>(index);
+}
+
+bool ZrpcTimerWheel::Cancel(TimerId id) {
+    Callback cb;  // 回调捕获的对象在锁外析构
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (index >= m_nodes.size()) {
+            return false;
+        }
+        Node &node = m_nodes[index];
+        if (node.generation != generation || node.slot == kNil) {
+            return false;
+        }
+        Unlink(static_cast<int32_t>(index));
+        cb.swap(node.cb);
+        Release(static_cast<int32_t>(index));
+    }
+    return true;
+}
+
+void ZrpcTimerWheel::Advance(std::chrono::steady_clock::time_point now, std::vector<Callback> *expired) {
+    int64_t target = ToTick(now);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_current <= target) {
+        if (m_size == 0) {
+            m_current = target + 1;  // 没有定时器，直接跳到目标位置
+            break;
+        }
+        // 第0层转完一圈时，依次把上一层的当前槽分散下来
+        if ((m_current & (kRootSize - 1)) == 0) {
+            for (int level = 1; level < kLevels; ++level) {
+                Cascade(level);
+                int shift = kRootBits + (level - 1) * kLevelBits;
+                if (((m_current >> shift) & (kLevelSize - 1)) != 0) {
+                    break;
+                }
+            }
+        }
+
+        int32_t slot = static_cast<int32_t>(m_current & (kRootSize - 1));
+        int32_t index = m_slots[slot];
+        m_slots[slot] = kNil;
+        while (index != kNil) {
+            Node &node = m_nodes[index];
+            int32_t next = node.next;
+            expired->push_back(std::move(node.cb));
+            node.cb = nullptr;
+            Release(index);
+            index = next;
+        }
+        m_current++;
+    }
+}
+
+int ZrpcTimerWheel::NextTimeoutMs(std::chrono::steady_clock::time_point now, int max_ms) {
+    int64_t now_tick = ToTick(now);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_size == 0) {
+        return max_ms;
+    }
+    // 在第0层当前这一圈内找第一个非空的槽；找不到时在这一圈结束（高层向下分散）时再检查
+    int64_t wrap = (m_current | (kRootSize - 1)) + 1;
+    int64_t limit = std::min(wrap, now_tick + max_ms);
+    int64_t tick = m_current;
+    while (tick < limit && m_slots[tick & (kRootSize - 1)] == kNil) {
+        ++tick;
+    }
+    return static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(tick - now_tick, max_ms)));
+}
+
+size_t ZrpcTimerWheel::Size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
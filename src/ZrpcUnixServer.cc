@@ -0,0 +1,74 @@
+#include "ZrpcUnixServer.h"
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <muduo/net/InetAddress.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+ZrpcUnixServer::ZrpcUnixServer(muduo::net::EventLoop *loop, const std::string &path, const std::string &name)
+    : m_loop(loop), m_path(path), m_name(name), m_listenfd(-1), m_next_conn_id(1) {}
+
+ZrpcUnixServer::~ZrpcUnixServer() {
+    if (m_accept_channel) {
+        m_accept_channel->disableAll();
+        m_accept_channel->remove();
+    }
+    if (m_listenfd >= 0) {
+        close(m_listenfd);
+        unlink(m_path.c_str());
+    }
+    for (auto &item : m_connections) {
+        muduo::net::TcpConnectionPtr conn = item.second;
+        conn->getLoop()->runInLoop(std::bind(&muduo::net::TcpConnection::connectDestroyed, conn));
+    }
+}
+
+bool ZrpcUnixServer::Start(const std::shared_ptr<muduo::net::EventLoopThreadPool> &pool) {
+    m_listenfd = ZrpcUnixSocket::Listen(m_path);
+    if (m_listenfd < 0) {
+        return false;
+    }
+    m_pool = pool;
+    m_accept_channel.reset(new muduo::net::Channel(m_loop, m_listenfd));
+    m_accept_channel->setReadCallback(std::bind(&ZrpcUnixServer::HandleAccept, this));
+    m_accept_channel->enableReading();
+    return true;
+}
+
+// 接受所有排队的连接，流程与muduo的TcpServer::newConnection相同
+void ZrpcUnixServer::HandleAccept() {
+    while (true) {
+        int fd = accept4(m_listenfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG(ERROR) << "accept unix socket error: " << strerror(errno);
+            }
+            if (errno != EINTR) {
+                return;
+            }
+            continue;
+        }
+
+        muduo::net::EventLoop *io_loop = m_pool ? m_pool->getNextLoop() : m_loop;
+        std::string conn_name = m_name + "-unix#" + std::to_string(m_next_conn_id++);
+        // Unix域套接字没有IP地址，本端和对端地址留空，只用于日志
+        muduo::net::TcpConnectionPtr conn = std::make_shared<muduo::net::TcpConnection>(
+            io_loop, conn_name, fd, muduo::net::InetAddress(), muduo::net::InetAddress());
+        m_connections[conn_name] = conn;
+        conn->setConnectionCallback(m_connection_callback);
+        conn->setMessageCallback(m_message_callback);
+        conn->setCloseCallback(std::bind(&ZrpcUnixServer::RemoveConnection, this, std::placeholders::_1));
+        io_loop->runInLoop(std::bind(&muduo::net::TcpConnection::connectEstablished, conn));
+    }
+}
+
+void ZrpcUnixServer::RemoveConnection(const muduo::net::TcpConnectionPtr &conn) {
+    m_loop->runInLoop(std::bind(&ZrpcUnixServer::RemoveConnectionInLoop, this, conn));
+}
+
+void ZrpcUnixServer::RemoveConnectionInLoop(const muduo::net::TcpConnectionPtr &conn) {
+    m_connections.erase(conn->name());
+    conn->getLoop()->queueInLoop(std::bind(&muduo::net::TcpConnection::connectDestroyed, conn));
+}
@@ -0,0 +1,169 @@
+#include "ZrpcUnixSocket.h"
+#include "ZrpcLogger.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+// 填充地址，路径过长时返回false
+bool MakeAddress(const std::string &path, struct sockaddr_un *addr) {
+    if (path.empty() || path.size() >= sizeof(addr->sun_path)) {
+        LOG(ERROR) << "invalid unix socket path: " << path;
+        return false;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path.data(), path.size());
+    return true;
+}
+
+}  // namespace
+
+const std::string &ZrpcUnixSocket::LocalHostId() {
+    static const std::string host_id = [] {
+        char name[256] = {0};
+        if (gethostname(name, sizeof(name) - 1) != 0) {
+            LOG(ERROR) << "gethostname error: " << strerror(errno);
+            return std::string();
+        }
+        return std::string(name);
+    }();
+    return host_id;
+}
+
+std::string ZrpcUnixSocket::DefaultPath(uint16_t port) {
+    return "/tmp/zrpc-" + std::to_string(port) + ".sock";
+}
+
+int ZrpcUnixSocket::Connect(const std::string &path, int timeout_ms) {
+    struct sockaddr_un addr;
+    if (!MakeAddress(path, &addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == fd) {
+        LOG(ERROR) << "socket error: " << strerror(errno);
+        return -1;
+    }
+
+    // 监听队列满时非阻塞的connect返回EAGAIN，等待可写后再查看结果
+    int result = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (result != 0 && (errno == EINPROGRESS || errno == EAGAIN)) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, timeout_ms) > 0) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+                result = 0;
+            }
+        }
+    }
+    if (result != 0) {
+        LOG(WARNING) << "connect unix socket " << path << " error: " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ZrpcUnixSocket::Listen(const std::string &path) {
+    struct sockaddr_un addr;
+    if (!MakeAddress(path, &addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == fd) {
+        LOG(ERROR) << "socket error: " << strerror(errno);
+        return -1;
+    }
+
+    // 同一端口的TCP监听已经成功，说明之前的进程已经退出，残留的套接字文件可以删除
+    unlink(path.c_str());
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        LOG(ERROR) << "listen unix socket " << path << " error: " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool ZrpcUnixSocket::SendFds(int sockfd, const int *fds, int count, const void *data, size_t len) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void *>(data);
+    iov.iov_len = len;
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * count));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+
+    ssize_t n;
+    do {
+        n = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n != static_cast<ssize_t>(len)) {
+        LOG(ERROR) << "send fds error: " << (n < 0 ? strerror(errno) : "short write");
+        return false;
+    }
+    return true;
+}
+
+ssize_t ZrpcUnixSocket::RecvFds(int sockfd, int *fds, int max_count, int *count, void *data, size_t len) {
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = len;
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * max_count));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    *count = 0;
+    ssize_t n;
+    do {
+        n = recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return -1;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        int received = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        const char *p = reinterpret_cast<const char *>(CMSG_DATA(cmsg));
+        for (int i = 0; i < received; ++i) {
+            int fd;
+            memcpy(&fd, p + i * sizeof(int), sizeof(int));
+            if (*count < max_count) {
+                fds[(*count)++] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+    if (msg.msg_flags & MSG_CTRUNC) {
+        LOG(WARNING) << "recv fds truncated";
+    }
+    return n;
+}
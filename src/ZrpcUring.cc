@@ -0,0 +1,372 @@
+#include "ZrpcUring.h"
+#include "ZrpcLogger.h"
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#ifdef ZRPC_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+ZrpcUring::ZrpcUring()
+    : m_ringfd(-1), m_ring(nullptr), m_ring_size(0), m_sqes(nullptr), m_sqes_size(0), m_sq_entries(0),
+      m_sq_head(nullptr), m_sq_tail(nullptr), m_sq_mask(0), m_cq_head(nullptr), m_cq_tail(nullptr), m_cq_mask(0),
+      m_cqes(nullptr), m_sq_local_tail(0), m_to_submit(0), m_buf_ring(nullptr), m_buf_ring_size(0),
+      m_buffers(nullptr), m_buffers_size(0), m_buffer_size(0), m_buffer_mask(0), m_buf_tail(0) {}
+
+ZrpcUring::~ZrpcUring() {
+    if (m_buffers != nullptr) {
+        munmap(m_buffers, m_buffers_size);
+    }
+    if (m_buf_ring != nullptr) {
+        munmap(m_buf_ring, m_buf_ring_size);
+    }
+    if (m_sqes != nullptr) {
+        munmap(m_sqes, m_sqes_size);
+    }
+    if (m_ring != nullptr) {
+        munmap(m_ring, m_ring_size);
+    }
+    if (m_ringfd >= 0) {
+        close(m_ringfd);  // 关闭时内核取消所有未完成的操作，并释放注册的缓冲区环和固定文件表
+    }
+}
+
+#ifdef ZRPC_HAVE_IO_URING
+
+namespace {
+
+const uint16_t kBufferGroup = 0;
+
+int SysRegister(int ringfd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringfd, opcode, arg, nr_args));
+}
+
+}  // namespace
+
+bool ZrpcUring::Init(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // 完成队列放大到提交队列的4倍：多发操作一次提交会产生多个完成事件
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = entries * 4;
+    m_ringfd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (m_ringfd < 0) {
+        LOG(WARNING) << "io_uring_setup error: " << strerror(errno);
+        return false;
+    }
+    const uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required) {
+        LOG(WARNING) << "io_uring lacks required features: " << params.features;
+        return false;
+    }
+
+    // 多发接收与IORING_OP_SEND_ZC同在6.0加入，以后者是否支持判断内核版本
+    std::vector<char> probe_buf(sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe *probe = reinterpret_cast<struct io_uring_probe *>(probe_buf.data());
+    if (SysRegister(m_ringfd, IORING_REGISTER_PROBE, probe, 256) < 0 || probe->last_op < IORING_OP_SEND_ZC ||
+        (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) == 0) {
+        LOG(WARNING) << "io_uring multishot recv is not supported by this kernel";
+        return false;
+    }
+
+    m_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                           params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+    m_ring = mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringfd, IORING_OFF_SQ_RING);
+    if (m_ring == MAP_FAILED) {
+        m_ring = nullptr;
+        LOG(WARNING) << "io_uring mmap error: " << strerror(errno);
+        return false;
+    }
+    m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    m_sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringfd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED) {
+        m_sqes = nullptr;
+        LOG(WARNING) << "io_uring mmap error: " << strerror(errno);
+        return false;
+    }
+
+    char *ring = static_cast<char *>(m_ring);
+    m_sq_entries = params.sq_entries;
+    m_sq_head = reinterpret_cast<unsigned *>(ring + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned *>(ring + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<unsigned *>(ring + params.sq_off.ring_mask);
+    unsigned *sq_array = reinterpret_cast<unsigned *>(ring + params.sq_off.array);
+    for (unsigned i = 0; i < m_sq_entries; ++i) {
+        sq_array[i] = i;  // 提交队列项与数组下标一一对应
+    }
+    m_sq_local_tail = *m_sq_tail;
+    m_cq_head = reinterpret_cast<unsigned *>(ring + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned *>(ring + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned *>(ring + params.cq_off.ring_mask);
+    m_cqes = ring + params.cq_off.cqes;
+    return true;
+}
+
+bool ZrpcUring::SetupBuffers(unsigned count, unsigned size) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    m_buf_ring_size = (count * sizeof(struct io_uring_buf) + page_size - 1) & ~static_cast<size_t>(page_size - 1);
+    m_buf_ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_buf_ring == MAP_FAILED) {
+        m_buf_ring = nullptr;
+        return false;
+    }
+    m_buffers_size = static_cast<size_t>(count) * size;
+    void *buffers = mmap(nullptr, m_buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+        return false;
+    }
+    m_buffers = static_cast<char *>(buffers);
+    m_buffer_size = size;
+    m_buffer_mask = count - 1;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = count;
+    reg.bgid = kBufferGroup;
+    if (SysRegister(m_ringfd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LOG(WARNING) << "io_uring register buffer ring error: " << strerror(errno);
+        return false;
+    }
+    for (unsigned bid = 0; bid < count; ++bid) {
+        RecycleBuffer(static_cast<uint16_t>(bid));
+    }
+    return true;
+}
+
+void ZrpcUring::RecycleBuffer(uint16_t bid) {
+    struct io_uring_buf_ring *br = static_cast<struct io_uring_buf_ring *>(m_buf_ring);
+    // 环尾与第一项的resv字段重叠，只能逐个字段赋值；
+    // 头文件中bufs的声明在C++下前面多占一个字节（空结构体），不能用br->bufs定位，直接按数组下标计算
+    struct io_uring_buf *buf = static_cast<struct io_uring_buf *>(m_buf_ring) + (m_buf_tail & m_buffer_mask);
+    buf->addr = reinterpret_cast<uint64_t>(Buffer(bid));
+    buf->len = m_buffer_size;
+    buf->bid = bid;
+    m_buf_tail++;
+    __atomic_store_n(&br->tail, m_buf_tail, __ATOMIC_RELEASE);
+}
+
+bool ZrpcUring::SetupFiles(unsigned count) {
+    std::vector<int> fds(count, -1);
+    if (SysRegister(m_ringfd, IORING_REGISTER_FILES, fds.data(), count) < 0) {
+        LOG(WARNING) << "io_uring register files error: " << strerror(errno);
+        return false;
+    }
+    for (unsigned slot = count; slot > 0; --slot) {
+        m_free_slots.push_back(static_cast<int>(slot - 1));
+    }
+    return true;
+}
+
+int ZrpcUring::RegisterFile(int fd) {
+    if (m_free_slots.empty()) {
+        return -1;
+    }
+    int slot = m_free_slots.back();
+    struct io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<uint32_t>(slot);
+    update.fds = reinterpret_cast<uint64_t>(&fd);
+    if (SysRegister(m_ringfd, IORING_REGISTER_FILES_UPDATE, &update, 1) != 1) {
+        return -1;
+    }
+    m_free_slots.pop_back();
+    return slot;
+}
+
+void ZrpcUring::UnregisterFile(int slot) {
+    if (slot < 0) {
+        return;
+    }
+    int fd = -1;
+    struct io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<uint32_t>(slot);
+    update.fds = reinterpret_cast<uint64_t>(&fd);
+    SysRegister(m_ringfd, IORING_REGISTER_FILES_UPDATE, &update, 1);
+    m_free_slots.push_back(slot);
+}
+
+void *ZrpcUring::GetSqe() {
+    if (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+        Submit(0);  // 提交队列已满，先把攒下的操作交给内核
+        if (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+            return nullptr;
+        }
+    }
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(m_sqes) + (m_sq_local_tail & m_sq_mask);
+    memset(sqe, 0, sizeof(*sqe));
+    m_sq_local_tail++;
+    m_to_submit++;
+    return sqe;
+}
+
+bool ZrpcUring::PrepareRecvMultishot(int fd, int slot, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = slot >= 0 ? slot : fd;
+    sqe->flags = IOSQE_BUFFER_SELECT | (slot >= 0 ? IOSQE_FIXED_FILE : 0);
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool ZrpcUring::PrepareSend(int fd, int slot, const void *data, size_t len, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = slot >= 0 ? slot : fd;
+    sqe->flags = slot >= 0 ? IOSQE_FIXED_FILE : 0;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool ZrpcUring::PrepareAcceptMultishot(int fd, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool ZrpcUring::PrepareRead(int fd, void *buf, size_t len, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->off = static_cast<uint64_t>(-1);  // 从当前位置读
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool ZrpcUring::PreparePollMultishot(int fd, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool ZrpcUring::PrepareCancel(uint64_t target_user_data, uint64_t user_data) {
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(GetSqe());
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target_user_data;
+    sqe->user_data = user_data;
+    return true;
+}
+
+// 提交和等待合并为一次io_uring_enter；完成队列中已有事件时不等待
+int ZrpcUring::Submit(int timeout_ms) {
+    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+    bool wait = timeout_ms != 0 && __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) == *m_cq_head;
+    if (m_to_submit == 0 && !wait) {
+        return 0;
+    }
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    if (timeout_ms > 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+    unsigned flags = wait ? (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG) : 0;
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ringfd, m_to_submit, wait ? 1 : 0, flags,
+                                       wait ? &arg : nullptr, wait ? sizeof(arg) : 0));
+    if (ret < 0) {
+        // 等待超时、被信号打断或完成队列溢出待处理都不是错误，调用方照常处理已有的完成事件
+        if (errno == ETIME || errno == EINTR || errno == EBUSY || errno == EAGAIN) {
+            return 0;
+        }
+        LOG(ERROR) << "io_uring_enter error: " << strerror(errno);
+        return -errno;
+    }
+    m_to_submit -= std::min(static_cast<unsigned>(ret), m_to_submit);
+    return ret;
+}
+
+bool ZrpcUring::NextCompletion(Completion *completion) {
+    unsigned head = *m_cq_head;
+    if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    const struct io_uring_cqe *cqe = static_cast<const struct io_uring_cqe *>(m_cqes) + (head & m_cq_mask);
+    completion->user_data = cqe->user_data;
+    completion->res = cqe->res;
+    completion->flags = cqe->flags;
+    __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool ZrpcUring::HasMore(uint32_t flags) {
+    return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+bool ZrpcUring::HasBuffer(uint32_t flags) {
+    return (flags & IORING_CQE_F_BUFFER) != 0;
+}
+
+uint16_t ZrpcUring::BufferId(uint32_t flags) {
+    return static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+#else  // 编译环境的内核头文件太旧，只能使用epoll
+
+bool ZrpcUring::Init(unsigned) {
+    LOG(WARNING) << "built without io_uring support";
+    return false;
+}
+bool ZrpcUring::SetupBuffers(unsigned, unsigned) { return false; }
+void ZrpcUring::RecycleBuffer(uint16_t) {}
+bool ZrpcUring::SetupFiles(unsigned) { return false; }
+int ZrpcUring::RegisterFile(int) { return -1; }
+void ZrpcUring::UnregisterFile(int) {}
+void *ZrpcUring::GetSqe() { return nullptr; }
+bool ZrpcUring::PrepareRecvMultishot(int, int, uint64_t) { return false; }
+bool ZrpcUring::PrepareSend(int, int, const void *, size_t, uint64_t) { return false; }
+bool ZrpcUring::PrepareAcceptMultishot(int, uint64_t) { return false; }
+bool ZrpcUring::PrepareRead(int, void *, size_t, uint64_t) { return false; }
+bool ZrpcUring::PreparePollMultishot(int, uint64_t) { return false; }
+bool ZrpcUring::PrepareCancel(uint64_t, uint64_t) { return false; }
+int ZrpcUring::Submit(int) { return -ENOSYS; }
+bool ZrpcUring::NextCompletion(Completion *) { return false; }
+bool ZrpcUring::HasMore(uint32_t) { return false; }
+bool ZrpcUring::HasBuffer(uint32_t) { return false; }
+uint16_t ZrpcUring::BufferId(uint32_t) { return 0; }
+
+#endif
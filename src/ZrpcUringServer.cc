@@ -0,0 +1,477 @@
+#include "ZrpcUringServer.h"
+#include "ZrpcCodec.h"
+#include "ZrpcLogger.h"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace {
+
+// 完成事件的user_data：高56位是连接编号（其他操作为0），低8位是操作类型
+enum UringOp : uint64_t
+{
+    kOpWakeup = 1,
+    kOpAccept = 2,
+    kOpRecv = 3,
+    kOpSend = 4,
+    kOpCancel = 5,
+};
+
+uint64_t MakeUserData(uint64_t token, UringOp op) {
+    return (token << 8) | op;
+}
+
+}  // namespace
+
+ZrpcUringConnection::ZrpcUringConnection(ZrpcUringLoop *loop, int fd)
+    : m_loop(loop), m_fd(fd), m_closed(false), m_token(0), m_slot(-1), m_recv_armed(false), m_send_inflight(false),
+      m_sending_offset(0), m_writing(false) {}
+
+ZrpcUringConnection::~ZrpcUringConnection() {
+    close(m_fd);
+}
+
+void ZrpcUringConnection::Send(const std::string &frame) {
+    if (m_closed) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    m_output.append(frame);
+    ScheduleSend();
+}
+
+bool ZrpcUringConnection::SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                                       const ZrpcCompressPolicy *compress) {
+    if (m_closed) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    size_t offset = m_output.size();
+    bool encoded = ZrpcCodec::EncodeResponse(request_id, response, [this, offset](size_t frame_len) {
+        m_output.resize(offset + frame_len);
+        return reinterpret_cast<uint8_t *>(&m_output[offset]);
+    }, compress);
+    if (!encoded) {
+        m_output.resize(offset);
+        return false;
+    }
+    ScheduleSend();
+    return true;
+}
+
+// 同一轮中产生的响应只安排一次发送：总是排队到loop本轮事件处理之后，即使当前就在loop线程上
+void ZrpcUringConnection::ScheduleSend() {
+    if (m_writing) {
+        return;
+    }
+    m_writing = true;
+    ZrpcUringConnectionPtr self = shared_from_this();
+    m_loop->QueueInLoop([self] { self->m_loop->StartSend(self); });
+}
+
+ZrpcUringLoop::ZrpcUringLoop()
+    : m_wakeupfd(-1), m_wakeup_value(0), m_wakeup_pending(false), m_running(false), m_listenfd(-1), m_next_token(1) {}
+
+ZrpcUringLoop::~ZrpcUringLoop() {
+    Stop();
+    if (m_wakeupfd >= 0) {
+        close(m_wakeupfd);
+    }
+}
+
+bool ZrpcUringLoop::Init() {
+    if (!m_ring.Init(kRingEntries) || !m_ring.SetupBuffers(kBufferCount, kBufferSize)) {
+        return false;
+    }
+    if (!m_ring.SetupFiles(kFixedFiles)) {
+        LOG(WARNING) << "io_uring fixed files unavailable, use plain fds";  // 不影响使用，只是每次操作都要查找fd
+    }
+    m_wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return m_wakeupfd >= 0;
+}
+
+void ZrpcUringLoop::SetAcceptor(int listenfd, const AcceptCallback &cb) {
+    m_listenfd = listenfd;
+    m_accept_callback = cb;
+}
+
+// 与muduo的EventLoopThread一样，等loop线程开始运行后才返回
+void ZrpcUringLoop::Start() {
+    m_running = true;
+    m_thread = std::thread(&ZrpcUringLoop::Loop, this);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_started.wait(lock, [this] { return m_thread_id != std::thread::id(); });
+}
+
+void ZrpcUringLoop::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    Wakeup();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void ZrpcUringLoop::RunInLoop(Functor cb) {
+    if (IsInLoopThread()) {
+        cb();
+        return;
+    }
+    QueueInLoop(std::move(cb));
+}
+
+void ZrpcUringLoop::QueueInLoop(Functor cb) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_functors.push_back(std::move(cb));
+    }
+    if (!IsInLoopThread()) {
+        Wakeup();
+    }
+}
+
+// loop还没有处理上一次唤醒时不再写eventfd，任务再多也只有一次系统调用
+void ZrpcUringLoop::Wakeup() {
+    if (m_wakeup_pending.exchange(true)) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t n = write(m_wakeupfd, &one, sizeof(one));
+    (void)n;
+}
+
+void ZrpcUringLoop::ArmWakeup() {
+    m_ring.PrepareRead(m_wakeupfd, &m_wakeup_value, sizeof(m_wakeup_value), MakeUserData(0, kOpWakeup));
+}
+
+void ZrpcUringLoop::ArmAccept() {
+    m_ring.PrepareAcceptMultishot(m_listenfd, MakeUserData(0, kOpAccept));
+}
+
+void ZrpcUringLoop::Loop() {
+    if (m_thread_init_callback) {
+        m_thread_init_callback();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_thread_id = std::this_thread::get_id();
+    }
+    m_started.notify_all();
+
+    ArmWakeup();
+    if (m_listenfd >= 0) {
+        ArmAccept();
+    }
+    while (m_running) {
+        // 本轮准备好的收发操作与等待合并为一次系统调用；还有排队的任务时不等待
+        bool has_pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            has_pending = !m_pending_functors.empty();
+        }
+        m_ring.Submit(has_pending ? 0 : -1);
+
+        muduo::Timestamp receive_time = muduo::Timestamp::now();
+        ZrpcUring::Completion completion;
+        while (m_ring.NextCompletion(&completion)) {
+            HandleCompletion(completion, receive_time);
+        }
+        DoPendingFunctors();
+    }
+
+    // 退出前关闭所有连接，之后在其他线程上发送的响应直接丢弃
+    for (auto &item : m_connections) {
+        item.second->m_closed = true;
+        shutdown(item.second->m_fd, SHUT_RDWR);
+    }
+    m_connections.clear();
+}
+
+void ZrpcUringLoop::DoPendingFunctors() {
+    std::vector<Functor> functors;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        functors.swap(m_pending_functors);
+    }
+    for (auto &functor : functors) {
+        functor();
+    }
+}
+
+void ZrpcUringLoop::HandleCompletion(const ZrpcUring::Completion &completion, muduo::Timestamp receive_time) {
+    uint64_t token = completion.user_data >> 8;
+    switch (completion.user_data & 0xff) {
+    case kOpWakeup:
+        m_wakeup_pending = false;
+        if (m_running) {
+            ArmWakeup();
+        }
+        return;
+    case kOpAccept:
+        if (completion.res >= 0) {
+            m_accept_callback(completion.res);
+        } else if (completion.res != -ECANCELED) {
+            LOG(ERROR) << "io_uring accept error: " << strerror(-completion.res);
+        }
+        if (!ZrpcUring::HasMore(completion.flags) && m_running) {
+            ArmAccept();  // 多发accept被内核终止（如fd耗尽）后重新提交
+        }
+        return;
+    case kOpCancel:
+        return;
+    default:
+        break;
+    }
+
+    ZrpcUringConnectionPtr conn;
+    auto it = m_connections.find(token);
+    if (it != m_connections.end()) {
+        conn = it->second;
+    }
+    if ((completion.user_data & 0xff) == kOpRecv) {
+        if (conn) {
+            HandleRecv(conn, completion, receive_time);
+        }
+        if (ZrpcUring::HasBuffer(completion.flags)) {
+            m_ring.RecycleBuffer(ZrpcUring::BufferId(completion.flags));  // 请求已经处理或拷走，缓冲区还给内核
+        }
+    } else if (conn) {
+        HandleSend(conn, completion.res);
+    }
+}
+
+void ZrpcUringLoop::AddConnection(const ZrpcUringConnectionPtr &conn) {
+    conn->m_token = m_next_token++;
+    conn->m_slot = m_ring.RegisterFile(conn->m_fd);
+    m_connections[conn->m_token] = conn;
+    if (!m_ring.PrepareRecvMultishot(conn->m_fd, conn->m_slot, MakeUserData(conn->m_token, kOpRecv))) {
+        LOG(ERROR) << "io_uring submission queue full, drop connection";
+        CloseConnection(conn);
+        return;
+    }
+    conn->m_recv_armed = true;
+}
+
+// 收到数据：没有遗留的半帧时直接在内核填充的缓冲区上解析，只把末尾不完整的帧拷进连接的接收缓冲区
+void ZrpcUringLoop::HandleRecv(const ZrpcUringConnectionPtr &conn, const ZrpcUring::Completion &completion,
+                               muduo::Timestamp receive_time) {
+    if (completion.res > 0 && ZrpcUring::HasBuffer(completion.flags) && !conn->m_closed) {
+        const char *data = m_ring.Buffer(ZrpcUring::BufferId(completion.flags));
+        size_t len = static_cast<size_t>(completion.res);
+        ssize_t consumed;
+        if (conn->m_input.ReadableBytes() == 0) {
+            consumed = ParseRequests(conn, data, len, receive_time);
+            if (consumed >= 0 && static_cast<size_t>(consumed) < len) {
+                conn->m_input.Append(data + consumed, len - consumed);
+            }
+        } else {
+            conn->m_input.Append(data, len);
+            consumed = ParseRequests(conn, conn->m_input.Peek(), conn->m_input.ReadableBytes(), receive_time);
+            if (consumed > 0) {
+                conn->m_input.Retrieve(consumed);
+            }
+        }
+        if (consumed < 0) {
+            LOG(ERROR) << "malformed request, close connection";
+            CloseConnection(conn);
+        }
+    }
+
+    if (ZrpcUring::HasMore(completion.flags)) {
+        return;
+    }
+    conn->m_recv_armed = false;
+    // 缓冲区暂时用完（-ENOBUFS）或内核因其他原因结束了多发接收时重新提交；对端关闭或出错时关闭连接
+    if (!conn->m_closed && (completion.res > 0 || completion.res == -ENOBUFS)) {
+        if (m_ring.PrepareRecvMultishot(conn->m_fd, conn->m_slot, MakeUserData(conn->m_token, kOpRecv))) {
+            conn->m_recv_armed = true;
+            return;
+        }
+    }
+    CloseConnection(conn);
+}
+
+ssize_t ZrpcUringLoop::ParseRequests(const ZrpcUringConnectionPtr &conn, const char *data, size_t len,
+                                     muduo::Timestamp receive_time) {
+    size_t offset = 0;
+    while (offset < len) {
+        Zrpc::RpcHeader header;
+        const char *args = nullptr;
+        int frame_len = ZrpcCodec::DecodeRequest(data + offset, len - offset, &header, &args);
+        if (frame_len == 0) {
+            break;
+        }
+        if (frame_len < 0) {
+            return -1;
+        }
+        if (!m_request_callback(conn, header, args, header.args_size(), receive_time)) {
+            return -1;
+        }
+        offset += frame_len;
+    }
+    return static_cast<ssize_t>(offset);
+}
+
+// 把输出缓冲区中攒下的响应整体交给一个发送操作；上一个发送操作还没完成时由它完成后接着发送
+void ZrpcUringLoop::StartSend(const ZrpcUringConnectionPtr &conn) {
+    if (conn->m_closed || conn->m_send_inflight) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(conn->m_send_mutex);
+        if (conn->m_output.empty()) {
+            conn->m_writing = false;
+            return;
+        }
+        conn->m_sending.swap(conn->m_output);
+    }
+    conn->m_sending_offset = 0;
+    if (!m_ring.PrepareSend(conn->m_fd, conn->m_slot, conn->m_sending.data(), conn->m_sending.size(),
+                            MakeUserData(conn->m_token, kOpSend))) {
+        LOG(ERROR) << "io_uring submission queue full, close connection";
+        CloseConnection(conn);
+        return;
+    }
+    conn->m_send_inflight = true;
+}
+
+void ZrpcUringLoop::HandleSend(const ZrpcUringConnectionPtr &conn, int res) {
+    conn->m_send_inflight = false;
+    if (res < 0 || conn->m_closed) {
+        if (res < 0 && !conn->m_closed) {
+            LOG(ERROR) << "io_uring send error: " << strerror(-res);
+        }
+        CloseConnection(conn);
+        return;
+    }
+    conn->m_sending_offset += static_cast<size_t>(res);
+    if (conn->m_sending_offset < conn->m_sending.size()) {
+        // 只发出了一部分（内核发送缓冲区满），接着发送剩余的部分
+        if (m_ring.PrepareSend(conn->m_fd, conn->m_slot, conn->m_sending.data() + conn->m_sending_offset,
+                               conn->m_sending.size() - conn->m_sending_offset, MakeUserData(conn->m_token, kOpSend))) {
+            conn->m_send_inflight = true;
+        } else {
+            CloseConnection(conn);
+        }
+        return;
+    }
+    conn->m_sending.clear();
+    StartSend(conn);  // 发送期间又攒下的响应
+}
+
+// 关闭连接：取消多发接收并关闭套接字让未完成的发送尽快结束，所有操作都完成后才释放连接
+void ZrpcUringLoop::CloseConnection(const ZrpcUringConnectionPtr &conn) {
+    if (!conn->m_closed.exchange(true)) {
+        if (conn->m_recv_armed) {
+            m_ring.PrepareCancel(MakeUserData(conn->m_token, kOpRecv), MakeUserData(0, kOpCancel));
+        }
+        shutdown(conn->m_fd, SHUT_RDWR);
+    }
+    ReleaseIfIdle(conn);
+}
+
+void ZrpcUringLoop::ReleaseIfIdle(const ZrpcUringConnectionPtr &conn) {
+    if (conn->m_recv_armed || conn->m_send_inflight) {
+        return;
+    }
+    if (m_connections.erase(conn->m_token) > 0) {
+        m_ring.UnregisterFile(conn->m_slot);
+        conn->m_slot = -1;
+    }
+}
+
+ZrpcUringServer::ZrpcUringServer(const std::string &ip, uint16_t port, const std::string &name)
+    : m_ip(ip), m_port(port), m_name(name), m_num_threads(1), m_reuse_port(false), m_next_loop(0) {}
+
+ZrpcUringServer::~ZrpcUringServer() {
+    for (auto &loop : m_loops) {
+        loop->Stop();
+    }
+    m_loops.clear();
+    for (int fd : m_listenfds) {
+        close(fd);
+    }
+}
+
+bool ZrpcUringServer::Start() {
+    for (int i = 0; i < m_num_threads; ++i) {
+        std::unique_ptr<ZrpcUringLoop> loop(new ZrpcUringLoop);
+        if (!loop->Init()) {
+            m_loops.clear();
+            return false;
+        }
+        loop->SetRequestCallback(m_request_callback);
+        loop->SetThreadInitCallback(m_thread_init_callback);
+        m_loops.push_back(std::move(loop));
+    }
+
+    int num_listeners = m_reuse_port ? m_num_threads : 1;
+    for (int i = 0; i < num_listeners; ++i) {
+        int listenfd = Listen();
+        if (listenfd < 0) {
+            for (int fd : m_listenfds) {
+                close(fd);
+            }
+            m_listenfds.clear();
+            m_loops.clear();
+            return false;
+        }
+        m_listenfds.push_back(listenfd);
+    }
+
+    if (m_reuse_port) {
+        // 每个loop接受的连接就留在本loop上，接受连接不再集中在一个线程
+        for (size_t i = 0; i < m_loops.size(); ++i) {
+            ZrpcUringLoop *loop = m_loops[i].get();
+            loop->SetAcceptor(m_listenfds[i], [loop](int fd) {
+                loop->AddConnection(std::make_shared<ZrpcUringConnection>(loop, fd));
+            });
+        }
+    } else {
+        m_loops[0]->SetAcceptor(m_listenfds[0], std::bind(&ZrpcUringServer::HandleAccept, this, std::placeholders::_1));
+    }
+    for (auto &loop : m_loops) {
+        loop->Start();
+    }
+    LOG(INFO) << m_name << " io_uring server started with " << m_num_threads << " loops, "
+              << num_listeners << (m_reuse_port ? " SO_REUSEPORT listeners" : " listener");
+    return true;
+}
+
+int ZrpcUringServer::Listen() {
+    int listenfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenfd < 0) {
+        LOG(ERROR) << "socket error: " << strerror(errno);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (m_reuse_port && setsockopt(listenfd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        LOG(ERROR) << "SO_REUSEPORT error: " << strerror(errno);
+        close(listenfd);
+        return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_port);
+    addr.sin_addr.s_addr = inet_addr(m_ip.c_str());
+    if (bind(listenfd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listenfd, SOMAXCONN) < 0) {
+        LOG(ERROR) << "listen " << m_ip << ":" << m_port << " error: " << strerror(errno);
+        close(listenfd);
+        return -1;
+    }
+    return listenfd;
+}
+
+// 在接受连接的loop上执行，连接轮流分配给各个loop
+void ZrpcUringServer::HandleAccept(int fd) {
+    ZrpcUringLoop *loop = m_loops[m_next_loop++ % m_loops.size()].get();
+    ZrpcUringConnectionPtr conn = std::make_shared<ZrpcUringConnection>(loop, fd);
+    loop->RunInLoop([loop, conn] { loop->AddConnection(conn); });
+}
@@ -1,20 +1,287 @@
 #include "Zrpcchannel.h"
 #include "Zrpcheader.pb.h"
-#include "zookeeperutil.h"
+#include "ZrpcServiceRegistry.h"
 #include "Zrpcapplication.h"
 #include "Zrpccontroller.h"
 #include "ZrpcHeartbeat.h"
+#include "ZrpcCodec.h"
+#include "ZrpcBuffer.h"
+#include "ZrpcMuxConnection.h"
+#include "ZrpcShmConnection.h"
+#include "ZrpcConnectionPool.h"
+#include "ZrpcClientReactor.h"
 #include "memory"
 #include <errno.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
-#include <arpa/inet.h>
-#include <fcntl.h>
-#include <poll.h>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include "ZrpcLogger.h"
 
-std::mutex g_data_mutx;  // 全局互斥锁，用于保护共享数据的线程安全
+// 每个线程复用的发送缓冲区：请求帧直接编码到其中，容量跨调用保留，不再每次调用分配新的字符串
+// 偶尔出现的大请求之后释放多余的容量，避免每个线程长期占用大块内存
+static std::string &ThreadLocalSendBuffer() {
+    static const size_t kMaxRetainedCapacity = 1024 * 1024;
+    thread_local std::string send_buffer;
+    if (send_buffer.capacity() > kMaxRetainedCapacity) {
+        std::string().swap(send_buffer);
+    }
+    send_buffer.clear();
+    return send_buffer;
+}
+
+// 协商请求体的压缩：对端声明支持该算法时按策略压缩，否则按原样发送
+static const ZrpcCompressPolicy *NegotiateCompress(const ZrpcCompressPolicy &policy, uint32_t peer_mask) {
+    if (policy.type == Zrpc::COMPRESS_NONE || (peer_mask & (1u << policy.type)) == 0) {
+        return nullptr;
+    }
+    return &policy;
+}
+
+// 调用开始前计入实例统计；开启过载保护时先做准入检查，被拒绝时设置原因并返回false
+static bool StartEndpointCall(const std::shared_ptr<ZrpcEndpointStats> &stats, bool protect,
+                              const std::string &address, std::string *reason) {
+    if (!stats) {
+        return true;
+    }
+    if (!protect) {
+        stats->OnCallStart();
+        return true;
+    }
+    switch (stats->TryStart()) {
+    case ZrpcEndpointStats::ADMITTED:
+        return true;
+    case ZrpcEndpointStats::LIMITED:
+        *reason = "concurrency limit " + std::to_string(stats->ConcurrencyLimit()) + " reached: " + address;
+        return false;
+    case ZrpcEndpointStats::CIRCUIT_OPEN:
+    default:
+        *reason = "circuit open: " + address;
+        return false;
+    }
+}
+
+// 配置了io_uring引擎（rpcioengine=io_uring）时同步调用也走reactor驱动的共享连接，由io_uring批量收发，不再在调用线程上阻塞读写套接字
+static bool IoUringConfigured() {
+    static const bool configured = ZrpcApplication::GetInstance().GetConfig().Load("rpcioengine") == "io_uring";
+    return configured;
+}
+
+static int64_t ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 同步阻塞调用结束时（包括各个失败分支）把结果计入实例统计
+// 结果由失败分支通过SetResult记下，不从控制器读取：调用方可能没有传入控制器
+class ZrpcCallRecorder
+{
+public:
+    explicit ZrpcCallRecorder(std::shared_ptr<ZrpcEndpointStats> stats)
+        : m_stats(std::move(stats)), m_code(Zrpc::RPC_OK), m_start(std::chrono::steady_clock::now()) {}
+
+    ~ZrpcCallRecorder() {
+        if (m_stats) {
+            m_stats->OnCallFinish(ElapsedUs(m_start), m_code);
+        }
+    }
+
+    void SetResult(Zrpc::RpcErrorCode code) { m_code = code; }
+
+private:
+    std::shared_ptr<ZrpcEndpointStats> m_stats;
+    Zrpc::RpcErrorCode m_code;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// 设置调用失败，控制器是Zrpccontroller时同时记录错误码
+static void SetCallFailed(google::protobuf::RpcController *controller, Zrpc::RpcErrorCode code, const std::string &reason) {
+    if (controller == nullptr) {
+        return;
+    }
+    Zrpccontroller *rpc_controller = dynamic_cast<Zrpccontroller *>(controller);
+    if (rpc_controller) {
+        rpc_controller->SetFailed(code, reason);
+    } else {
+        controller->SetFailed(reason);
+    }
+}
+
+// 多路复用（或共享内存）连接上异步调用的完成回调：在reactor线程上直接从接收缓冲区（或共享内存）反序列化响应，然后执行done
+static ZrpcMuxConnection::Completion MakeAsyncCompletion(google::protobuf::RpcController *controller,
+                                                         google::protobuf::Message *response,
+                                                         google::protobuf::Closure *done,
+                                                         const std::string &call_name,
+                                                         const std::shared_ptr<ZrpcEndpointStats> &stats,
+                                                         std::chrono::steady_clock::time_point start) {
+    return [controller, response, done, call_name, stats, start](Zrpc::RpcErrorCode code, const char *body, size_t len, const std::string &errtxt) {
+        if (stats) {
+            stats->OnCallFinish(ElapsedUs(start), code);
+        }
+        if (code != Zrpc::RPC_OK) {
+            LOG(ERROR) << call_name << " call failed: " << errtxt;
+            SetCallFailed(controller, code, errtxt);
+        } else if (!response->ParseFromArray(body, static_cast<int>(len))) {
+            SetCallFailed(controller, Zrpc::RPC_INTERNAL_ERROR, "parse response error");
+        }
+        done->Run();
+    };
+}
+
+// 一次对冲调用的共享状态：首次请求和对冲请求中先成功的一个生效，另一个被取消
+// 两次请求的完成回调都在reactor线程上执行，状态由mutex保护，调用方的done在锁外执行
+struct ZrpcHedgedCall : public std::enable_shared_from_this<ZrpcHedgedCall>
+{
+    struct Attempt
+    {
+        ZrpcEndpoint endpoint;
+        std::shared_ptr<ZrpcMuxConnection> conn;  // 为空表示没有可用的对冲实例
+        uint64_t request_id = 0;
+        std::chrono::steady_clock::time_point start;
+        bool launched = false;
+        bool inflight = false;
+        bool admitted = false;  // 已计入实例的在途请求数，结束时需要更新统计
+    };
+
+    std::string service;
+    std::string method;
+    Zrpccontroller *controller = nullptr;
+    const google::protobuf::Message *request = nullptr;
+    google::protobuf::Message *response = nullptr;
+    google::protobuf::Closure *done = nullptr;
+    std::shared_ptr<ZrpcLatencyTracker> tracker;
+    std::chrono::steady_clock::time_point deadline;
+    ZrpcCompressPolicy compress;
+    Zrpc::RpcPriority priority = Zrpc::PRIORITY_UNSET;
+    bool protect = false;  // 过载保护
+
+    std::mutex mutex;
+    bool finished = false;
+    std::string last_error;
+    Zrpc::RpcErrorCode last_code = Zrpc::RPC_OK;
+    Attempt attempts[2];  // 0为首次请求，1为对冲请求
+
+    // 发出第index次请求，超时时间为整个调用剩余的时间
+    void Launch(int index) {
+        Attempt &attempt = attempts[index];
+        std::string reject_reason;
+        attempt.admitted = StartEndpointCall(attempt.endpoint.stats, protect, attempt.endpoint.Address(), &reject_reason);
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            attempt.launched = true;
+            attempt.inflight = true;
+            attempt.start = now;
+        }
+        if (!attempt.admitted) {
+            // 实例过载或熔断：首次请求被拒绝时立即改发对冲实例
+            OnAttemptDone(index, Zrpc::RPC_OVERLOADED, nullptr, 0, "rejected, " + reject_reason);
+            return;
+        }
+
+        int remaining_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+        if (remaining_ms <= 0) {
+            OnAttemptDone(index, Zrpc::RPC_DEADLINE_EXCEEDED, nullptr, 0, "RPC call timeout");
+            return;
+        }
+        uint64_t request_id = attempt.conn->NextRequestId();
+        std::string frame;
+        if (!ZrpcCodec::EncodeRequest(service, method, request_id, *request, &frame, static_cast<uint32_t>(remaining_ms),
+                                      NegotiateCompress(compress, attempt.conn->PeerCompressMask()), priority)) {
+            OnAttemptDone(index, Zrpc::RPC_INTERNAL_ERROR, nullptr, 0, "serialize request fail");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            attempt.request_id = request_id;
+        }
+        std::shared_ptr<ZrpcHedgedCall> self = shared_from_this();
+        attempt.conn->CallAsync(request_id, frame, remaining_ms,
+                                [self, index](Zrpc::RpcErrorCode code, const char *body, size_t len, const std::string &errtxt) {
+                                    self->OnAttemptDone(index, code, body, len, errtxt);
+                                });
+    }
+
+    // 对冲定时器到期或首次请求失败时发出对冲请求，已发出、没有对冲实例或调用已结束时什么也不做
+    void LaunchHedge() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (finished || attempts[1].launched || !attempts[1].conn) {
+                return;
+            }
+            attempts[1].launched = true;
+        }
+        LOG(INFO) << service << "." << method << " hedged to " << attempts[1].endpoint.Address();
+        Launch(1);
+    }
+
+    void OnAttemptDone(int index, Zrpc::RpcErrorCode code, const char *body, size_t len, const std::string &errtxt) {
+        Attempt &attempt = attempts[index];
+        bool ok = (code == Zrpc::RPC_OK);
+        int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - attempt.start).count();
+        bool won = false;
+        bool failed = false;
+        bool retry = false;
+        Attempt *loser = nullptr;
+        uint64_t loser_request_id = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!attempt.inflight) {
+                // 另一次请求已经胜出，但取消时本次响应恰好已经取出
+                if (attempt.admitted && attempt.endpoint.stats) {
+                    attempt.endpoint.stats->OnCallCanceled();
+                }
+                return;
+            }
+            attempt.inflight = false;
+            if (ok) {
+                finished = true;
+                won = true;
+                Attempt &other = attempts[1 - index];
+                if (other.inflight) {
+                    other.inflight = false;
+                    loser = &other;
+                    loser_request_id = other.request_id;
+                }
+            } else {
+                last_error = errtxt;
+                last_code = code;
+                if (index == 0 && !attempts[1].launched && attempts[1].conn) {
+                    retry = true;  // 首次请求失败，不必等对冲定时器，立即向另一个实例发送
+                } else if (!attempts[0].inflight && !attempts[1].inflight) {
+                    finished = true;
+                    failed = true;
+                }
+            }
+        }
+        if (attempt.admitted && attempt.endpoint.stats) {
+            attempt.endpoint.stats->OnCallFinish(latency_us, code);
+        }
+
+        if (loser != nullptr && loser->conn->Cancel(loser_request_id) && loser->admitted && loser->endpoint.stats) {
+            loser->endpoint.stats->OnCallCanceled();
+        }
+        if (retry) {
+            LaunchHedge();
+        }
+        if (won) {
+            tracker->Record(latency_us);
+            // body只在回调期间有效，在这里完成反序列化
+            if (!response->ParseFromArray(body, static_cast<int>(len))) {
+                SetCallFailed(controller, Zrpc::RPC_INTERNAL_ERROR, "parse response error");
+            }
+            done->Run();
+        } else if (failed) {
+            LOG(ERROR) << service << "." << method << " call failed: " << last_error;
+            if (controller) {
+                controller->SetFailed(last_code, last_error);
+            }
+            done->Run();
+        }
+    }
+};
 
 // RPC调用的核心方法，负责将客户端的请求序列化并发送到服务端，同时接收服务端的响应
 void ZrpcChannel::CallMethod(const ::google::protobuf::MethodDescriptor *method,
@@ -26,202 +293,201 @@ void ZrpcChannel::CallMethod(const ::google::protobuf::MethodDescriptor *method,
     // 转换为具体的控制器类型以使用超时功能
     Zrpccontroller* rpc_controller = dynamic_cast<Zrpccontroller*>(controller);
     if (rpc_controller) {
-        rpc_controller->SetStartTime();  // 设置开始时间
-    }
-    
-    if (-1 == m_clientfd) {  // 如果客户端socket未初始化
-        // 获取服务对象名和方法名
-        const google::protobuf::ServiceDescriptor *sd = method->service();
-        service_name = sd->name();  // 服务名
-        method_name = method->name();  // 方法名
-
-        // 客户端需要查询ZooKeeper，找到提供该服务的服务器地址
-        ZkClient zkCli;
-        zkCli.Start();  // 连接ZooKeeper服务器
-        std::string host_data = QueryServiceHost(&zkCli, service_name, method_name, m_idx);  // 查询服务地址
-        m_ip = host_data.substr(0, m_idx);  // 从查询结果中提取IP地址
-        std::cout << "ip: " << m_ip << std::endl;
-        m_port = atoi(host_data.substr(m_idx + 1, host_data.size() - m_idx).c_str());  // 从查询结果中提取端口号
-        std::cout << "port: " << m_port << std::endl;
-
-        // 生成服务标识符并注册到心跳管理器
-        m_service_key = service_name + "." + method_name + "@" + m_ip + ":" + std::to_string(m_port);
-        
-        if (m_heartbeat_enabled) {
-            ZrpcHeartbeat::GetInstance().RegisterService(m_service_key, m_ip, m_port, 15000);
-            
-            // 检查服务是否可用
-            if (!ZrpcHeartbeat::GetInstance().IsServiceAvailable(m_service_key)) {
-                LOG(WARNING) << "Service " << m_service_key << " is not available according to heartbeat";
-                if (rpc_controller) {
-                    rpc_controller->SetFailed("Service not available: " + m_service_key);
-                }
-                return;
+        rpc_controller->SetStartTime();  // 设置开始时间，同时确定截止时间
+        // 嵌套调用继承的上游预算已经用完：上游调用方不再等待结果，不必再发出请求
+        if (rpc_controller->IsTimeout()) {
+            rpc_controller->SetFailed(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded before " + method->full_name() + " was sent");
+            if (done) {
+                done->Run();
             }
-        }
-
-        // 尝试连接服务器（带超时）
-        int timeout_ms = rpc_controller ? rpc_controller->GetTimeout() : 15000;
-        auto rt = newConnectWithTimeout(m_ip.c_str(), m_port, timeout_ms);
-        if (!rt) {
-            LOG(ERROR) << "connect server error";  // 连接失败，记录错误日志
             return;
-        } else {
-            LOG(INFO) << "connect server success";  // 连接成功，记录日志
         }
-    }  // endif
+    }
+    
+    // 幂等方法开启了对冲：可能同时向两个实例发送请求，只能走多路复用连接
+    if (rpc_controller && rpc_controller->IsHedgingEnabled()) {
+        CallMethodHedged(method, rpc_controller, request, response, done);
+        return;
+    }
 
-    // 将请求参数序列化为字符串，并计算其长度
-    uint32_t args_size{};
-    std::string args_str;
-    if (request->SerializeToString(&args_str)) {  // 序列化请求参数
-        args_size = args_str.size();  // 获取序列化后的长度
-    } else {
-        controller->SetFailed("serialize request fail");  // 序列化失败，设置错误信息
+    // 多路复用模式、批量调用、共享内存、io_uring引擎、异步调用（done非空）或按key路由：共享连接由reactor驱动读写，按request_id匹配响应
+    // 按key路由时每次调用都要重新选择实例，不能沿用channel上绑定的单个实例
+    if (done != nullptr || IsMultiplexEnabled() || IsBatchingEnabled() || IsSharedMemoryEnabled() || IoUringConfigured() ||
+        (rpc_controller && rpc_controller->HasHashKey())) {
+        CallMethodMultiplexed(method, controller, request, response, done);
         return;
     }
 
-    // 定义RPC请求的头部信息
-    Zrpc::RpcHeader Zrpcheader;
-    Zrpcheader.set_service_name(service_name);  // 设置服务名
-    Zrpcheader.set_method_name(method_name);  // 设置方法名
-    Zrpcheader.set_args_size(args_size);  // 设置参数长度
+    // 获取服务对象名和方法名，每次调用都取自本次的method
+    const std::string &service_name = method->service()->name();  // 服务名
+    const std::string &method_name = method->name();  // 方法名
 
-    // 将RPC头部信息序列化为字符串，并计算其长度
-    uint32_t header_size = 0;
-    std::string rpc_header_str;
-    if (Zrpcheader.SerializeToString(&rpc_header_str)) {  // 序列化头部信息
-        header_size = rpc_header_str.size();  // 获取序列化后的长度
-    } else {
-        controller->SetFailed("serialize rpc header error!");  // 序列化失败，设置错误信息
+    // 每次调用都从本地服务注册表的快照中按负载均衡策略选出一个实例，连接池按实例分别保存连接
+    ZrpcEndpoint endpoint;
+    if (!ResolveEndpoint(method, rpc_controller, &endpoint)) {
+        SetCallFailed(controller, Zrpc::RPC_SERVICE_NOT_FOUND, "Service not found: " + service_name + "." + method_name);
+        return;
+    }
+    if (!CheckHeartbeat(method, endpoint, controller)) {
         return;
     }
 
-    // 将头部长度和头部信息拼接成完整的RPC请求报文
-    std::string send_rpc_str;
-    {
-        google::protobuf::io::StringOutputStream string_output(&send_rpc_str);
-        google::protobuf::io::CodedOutputStream coded_output(&string_output);
-        coded_output.WriteVarint32(static_cast<uint32_t>(header_size));  // 写入头部长度
-        coded_output.WriteString(rpc_header_str);  // 写入头部信息
-    }
-    send_rpc_str += args_str;  // 拼接请求参数
-
-    // 发送RPC请求到服务器
-    if (-1 == send(m_clientfd, send_rpc_str.c_str(), send_rpc_str.size(), 0)) {
-        close(m_clientfd);  // 发送失败，关闭socket
-        char errtxt[512] = {};
-        std::cout << "send error: " << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        controller->SetFailed(errtxt);  // 设置错误信息
+    // 以下每个阶段（借用/建立连接、发送、接收）都不超过调用剩余的时间，超时以RPC_DEADLINE_EXCEEDED失败
+    // 没有Zrpccontroller时与多路复用调用一样使用15秒的默认预算，不会无限阻塞在连接、发送或接收上
+    std::chrono::steady_clock::time_point deadline = rpc_controller ? rpc_controller->GetDeadline()
+                                                                    : std::chrono::steady_clock::now() + std::chrono::milliseconds(15000);
+    auto remaining_ms = [deadline]() {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+    };
+    auto timed_out = [deadline]() { return std::chrono::steady_clock::now() >= deadline; };
+    std::string address = endpoint.Address();
+
+    // 实例过载或熔断时不再借用连接、阻塞在该实例上，直接失败
+    std::string reject_reason;
+    if (!StartEndpointCall(endpoint.stats, IsOverloadProtectionEnabled(), address, &reject_reason)) {
+        SetCallFailed(controller, Zrpc::RPC_OVERLOADED, service_name + "." + method_name + " rejected, " + reject_reason);
         return;
     }
+    ZrpcCallRecorder recorder(endpoint.stats);  // 调用结束时把结果计入实例统计
+
+    // 以下的失败同时记入recorder和控制器
+    auto fail = [&recorder, controller](Zrpc::RpcErrorCode code, const std::string &reason) {
+        recorder.SetResult(code);
+        SetCallFailed(controller, code, reason);
+    };
 
-    // 接收服务器的响应
-    char recv_buf[1024] = {0};
-    int recv_size = 0;
-    if (-1 == (recv_size = recv(m_clientfd, recv_buf, 1024, 0))) {
-        char errtxt[512] = {};
-        std::cout << "recv error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        controller->SetFailed(errtxt);  // 设置错误信息
+    // 从连接池借用到该服务端的连接，调用结束时由guard归还；稳定状态下每次调用不再建立和关闭连接
+    ZrpcConnectionGuard guard(endpoint.ip, endpoint.port, remaining_ms(), endpoint.unix_path);
+    if (!guard.IsValid()) {
+        if (timed_out()) {
+            fail(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded while connecting to " + address);
+            return;
+        }
+        LOG(ERROR) << "connect server error";  // 连接失败，记录错误日志
+        fail(Zrpc::RPC_UNAVAILABLE, "connect server error: " + address);
         return;
     }
+    std::shared_ptr<ZrpcConnection> conn = guard.GetConnection();
 
-    // 将接收到的响应数据反序列化为response对象
-    if (!response->ParseFromArray(recv_buf, recv_size)) {
-        close(m_clientfd);  // 反序列化失败，关闭socket
-        char errtxt[512] = {};
-        std::cout << "parse error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        controller->SetFailed(errtxt);  // 设置错误信息
+    // 将请求头和请求参数编码为完整的RPC请求报文（非多路复用连接上request_id固定为0），请求头带上剩余的时间预算
+    // 请求头中的时间预算为0表示没有截止时间，预算已经用完（不足1ms）时不再发送，避免服务端把请求当作不限时间处理
+    int budget_ms = remaining_ms();
+    if (budget_ms <= 0) {
+        fail(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded before sending to " + address);
+        return;
+    }
+    std::string &send_rpc_str = ThreadLocalSendBuffer();
+    ZrpcCompressPolicy compress = GetCompressPolicy(method);
+    if (!ZrpcCodec::EncodeRequest(service_name, method_name, 0, *request, &send_rpc_str, static_cast<uint32_t>(budget_ms),
+                                  NegotiateCompress(compress, conn->GetPeerCompressMask()),
+                                  rpc_controller ? rpc_controller->GetPriority() : Zrpc::PRIORITY_UNSET)) {
+        fail(Zrpc::RPC_INTERNAL_ERROR, "serialize request fail");  // 序列化失败，设置错误信息
         return;
     }
 
-    close(m_clientfd);  // 关闭socket连接
-}
+    // 发送RPC请求到服务器，失败或超时时连接被关闭，归还后由连接池销毁
+    if (!conn->Send(send_rpc_str.data(), send_rpc_str.size(), remaining_ms())) {
+        if (errno == ETIMEDOUT) {
+            fail(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded while sending to " + address);
+        } else {
+            fail(Zrpc::RPC_UNAVAILABLE, "send error: " + address);  // 设置错误信息
+        }
+        return;
+    }
 
-// 创建新的socket连接
-bool ZrpcChannel::newConnect(const char *ip, uint16_t port) {
-    // 创建socket
-    int clientfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (-1 == clientfd) {
-        char errtxt[512] = {0};
-        std::cout << "socket error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        LOG(ERROR) << "socket error:" << errtxt;  // 记录错误日志
-        return false;
+    // 接收服务器的响应：按帧长度增量读取，直到收到一个完整的响应帧
+    // 每个线程复用同一个可增长的接收缓冲区，大响应不会被截断，也不会每次调用都重新分配内存
+    thread_local ZrpcBuffer recv_buffer;
+    recv_buffer.RetrieveAll();
+    Zrpc::RpcResponseHeader response_header;
+    const char *body = nullptr;
+    int frame_len = 0;
+    while (0 == (frame_len = ZrpcCodec::DecodeResponse(recv_buffer.Peek(), recv_buffer.ReadableBytes(), &response_header, &body))) {
+        // 等待响应到达，超过截止时间时关闭连接（迟到的响应会错位），不再无限阻塞在recv上
+        if (!conn->WaitReadable(remaining_ms())) {
+            std::string reason = errno == ETIMEDOUT ? "RPC call timeout waiting for response from " + address
+                                                    : "recv error: " + address;
+            LOG(ERROR) << reason;
+            fail(errno == ETIMEDOUT ? Zrpc::RPC_DEADLINE_EXCEEDED : Zrpc::RPC_UNAVAILABLE, reason);
+            return;
+        }
+        int saved_errno = 0;
+        ssize_t recv_size = recv_buffer.ReadFd(conn->GetSocket(), &saved_errno);
+        if (recv_size < 0 && saved_errno == EINTR) continue;
+        if (recv_size <= 0) {
+            conn->Close();  // 接收失败或对端关闭，连接不能再复用
+            char errtxt[512] = {};
+            std::string reason = recv_size == 0 ? "connection closed by server"
+                                                : strerror_r(saved_errno, errtxt, sizeof(errtxt));
+            LOG(ERROR) << "recv error from " << address << ": " << reason;
+            fail(Zrpc::RPC_UNAVAILABLE, reason);  // 设置错误信息
+            return;
+        }
     }
 
-    // 设置服务器地址信息
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;  // IPv4地址族
-    server_addr.sin_port = htons(port);  // 端口号
-    server_addr.sin_addr.s_addr = inet_addr(ip);  // IP地址
+    if (frame_len < 0) {
+        conn->Close();  // 报文格式错误，后续字节无法再对齐帧边界，连接不能再复用
+        LOG(ERROR) << "malformed response from " << address;
+        fail(Zrpc::RPC_UNAVAILABLE, "malformed response from " + address);
+        return;
+    }
 
-    // 尝试连接服务器
-    if (-1 == connect(clientfd, (struct sockaddr *)&server_addr, sizeof(server_addr))) {
-        close(clientfd);  // 连接失败，关闭socket
-        char errtxt[512] = {0};
-        std::cout << "connect error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        LOG(ERROR) << "connect server error" << errtxt;  // 记录错误日志
-        return false;
+    // 以下情况完整的响应帧都已读出，连接可以继续复用
+    conn->SetPeerCompressMask(response_header.accept_compress());
+    // 服务端返回了失败状态
+    if (response_header.error_code() != Zrpc::RPC_OK) {
+        fail(response_header.error_code(), response_header.error_text());
+        return;
     }
 
-    m_clientfd = clientfd;  // 保存socket文件描述符
-    return true;
+    // 直接在接收缓冲区上反序列化响应体（压缩过的先解压）
+    if (!ZrpcCodec::ParseBody(response_header.compress_type(), body, response_header.body_size(), response)) {
+        LOG(ERROR) << service_name << "." << method_name << " parse response error";
+        fail(Zrpc::RPC_INTERNAL_ERROR, "parse response error");  // 设置错误信息
+        return;
+    }
+    recv_buffer.Retrieve(frame_len);
 }
 
-// 带超时的连接函数
-bool ZrpcChannel::newConnectWithTimeout(const char *ip, uint16_t port, int timeout_ms) {
-    // 创建socket
-    int clientfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (-1 == clientfd) {
-        char errtxt[512] = {0};
-        std::cout << "socket error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;  // 打印错误信息
-        LOG(ERROR) << "socket error:" << errtxt;  // 记录错误日志
-        return false;
+// 开启心跳时检查选中的实例是否可用，每个实例第一次被选中时登记到心跳管理器
+bool ZrpcChannel::CheckHeartbeat(const google::protobuf::MethodDescriptor *method, const ZrpcEndpoint &endpoint,
+                                 google::protobuf::RpcController *controller) {
+    if (!IsHeartbeatEnabled()) {
+        return true;
     }
 
-    // 设置socket为非阻塞模式
-    int flags = fcntl(clientfd, F_GETFL, 0);
-    fcntl(clientfd, F_SETFL, flags | O_NONBLOCK);
-
-    // 设置服务器地址信息
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;  // IPv4地址族
-    server_addr.sin_port = htons(port);  // 端口号
-    server_addr.sin_addr.s_addr = inet_addr(ip);  // IP地址
+    // 生成服务标识符并注册到心跳管理器；重复登记会重置最近一次心跳的时间，所以只登记一次
+    std::string service_key = method->service()->name() + "." + method->name() + "@" + endpoint.Address();
+    bool first_seen;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        first_seen = m_heartbeat_services.insert(service_key).second;
+    }
+    if (first_seen) {
+        LOG(INFO) << "register " << service_key << " for heartbeat";
+        ZrpcHeartbeat::GetInstance().RegisterService(service_key, endpoint.ip, endpoint.port, 15000);
+    }
 
-    // 尝试连接服务器
-    int result = connect(clientfd, (struct sockaddr *)&server_addr, sizeof(server_addr));
-    
-    if (result == 0) {
-        // 连接立即成功
-        fcntl(clientfd, F_SETFL, flags);  // 恢复阻塞模式
-        m_clientfd = clientfd;
-        return true;
-    } else if (errno == EINPROGRESS) {
-        // 连接正在进行中，使用poll等待
-        struct pollfd pfd;
-        pfd.fd = clientfd;
-        pfd.events = POLLOUT;
-        
-        int poll_result = poll(&pfd, 1, timeout_ms);
-        if (poll_result > 0) {
-            // 检查连接是否成功
-            int error = 0;
-            socklen_t len = sizeof(error);
-            if (getsockopt(clientfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
-                fcntl(clientfd, F_SETFL, flags);  // 恢复阻塞模式
-                m_clientfd = clientfd;
-                return true;
-            }
-        }
+    // 检查服务是否可用
+    if (!ZrpcHeartbeat::GetInstance().IsServiceAvailable(service_key)) {
+        LOG(WARNING) << "Service " << service_key << " is not available according to heartbeat";
+        SetCallFailed(controller, Zrpc::RPC_UNAVAILABLE, "Service not available: " + service_key);
+        return false;
     }
-    
-    // 连接失败
-    close(clientfd);
-    char errtxt[512] = {0};
-    std::cout << "connect timeout or error" << strerror_r(errno, errtxt, sizeof(errtxt)) << std::endl;
-    LOG(ERROR) << "connect server timeout or error" << errtxt;
-    return false;
+    return true;
+}
+
+// 以future方式发起异步调用：done非空走异步路径，done在reactor线程上设置future的结果
+ZrpcFuture<bool> ZrpcChannel::CallMethodAsync(const ::google::protobuf::MethodDescriptor *method,
+                                              ::google::protobuf::RpcController *controller,
+                                              const ::google::protobuf::Message *request,
+                                              ::google::protobuf::Message *response)
+{
+    ZrpcPromise<bool> promise;
+    ZrpcFuture<bool> future = promise.GetFuture();
+    CallMethod(method, controller, request, response, google::protobuf::NewCallback(&ZrpcCompletePromise, promise, controller));
+    return future;
 }
 
 // 启用/禁用心跳功能
@@ -241,39 +507,472 @@ bool ZrpcChannel::IsHeartbeatEnabled() const {
     return m_heartbeat_enabled;
 }
 
-// 从ZooKeeper查询服务地址
-std::string ZrpcChannel::QueryServiceHost(ZkClient *zkclient, std::string service_name, std::string method_name, int &idx) {
-    std::string method_path = "/" + service_name + "/" + method_name;  // 构造ZooKeeper路径
-    std::cout << "method_path: " << method_path << std::endl;
+// 启用/禁用多路复用模式
+void ZrpcChannel::EnableMultiplex(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_multiplex_enabled = enable;
+}
+
+// 检查多路复用是否启用
+bool ZrpcChannel::IsMultiplexEnabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_multiplex_enabled;
+}
 
-    std::unique_lock<std::mutex> lock(g_data_mutx);  // 加锁，保证线程安全
-    std::string host_data_1 = zkclient->GetData(method_path.c_str());  // 从ZooKeeper获取数据
-    lock.unlock();  // 解锁
+// 启用/禁用批量调用
+void ZrpcChannel::EnableBatching(bool enable, const ZrpcBatchPolicy &policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batching_enabled = enable;
+    m_batch_policy = policy;
+}
 
-    if (host_data_1 == "") {  // 如果未找到服务地址
-        LOG(ERROR) << method_path + " is not exist!";  // 记录错误日志
-        return " ";
+bool ZrpcChannel::IsBatchingEnabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_batching_enabled;
+}
+
+// 启用/禁用共享内存传输
+void ZrpcChannel::EnableSharedMemory(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shm_enabled = enable;
+}
+
+bool ZrpcChannel::IsSharedMemoryEnabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_shm_enabled;
+}
+
+// 设置请求体压缩策略
+void ZrpcChannel::SetCompression(Zrpc::CompressType type, uint32_t min_bytes, const std::string &method_name) {
+    ZrpcCompressPolicy policy;
+    policy.type = type;
+    policy.min_bytes = min_bytes;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (method_name.empty()) {
+        m_default_compress = policy;
+    } else {
+        m_method_compress[method_name] = policy;
+    }
+}
+
+// 方法单独设置的策略优先于默认策略
+ZrpcCompressPolicy ZrpcChannel::GetCompressPolicy(const google::protobuf::MethodDescriptor *method) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_method_compress.find(method->name());
+    return it != m_method_compress.end() ? it->second : m_default_compress;
+}
+
+// 多路复用模式下的调用：同一个channel可以被多个线程同时使用
+// done为空时阻塞等待响应；done非空时立即返回，响应由reactor线程反序列化后执行done
+void ZrpcChannel::CallMethodMultiplexed(const ::google::protobuf::MethodDescriptor *method,
+                                        ::google::protobuf::RpcController *controller,
+                                        const ::google::protobuf::Message *request,
+                                        ::google::protobuf::Message *response,
+                                        ::google::protobuf::Closure *done)
+{
+    Zrpccontroller* rpc_controller = dynamic_cast<Zrpccontroller*>(controller);
+    int timeout_ms = rpc_controller ? rpc_controller->RemainingMs() : 15000;  // 剩余的时间预算
+    const std::string &service = method->service()->name();
+    const std::string &name = method->name();
+
+    // 失败时设置错误信息，异步调用同样需要执行done通知调用方
+    auto fail = [controller, done](Zrpc::RpcErrorCode code, const std::string &reason) {
+        LOG(ERROR) << reason;
+        SetCallFailed(controller, code, reason);
+        if (done) {
+            done->Run();
+        }
+    };
+
+    // 每次调用都从本地服务注册表的快照中查询实例列表（无锁），再按负载均衡策略选出一个实例
+    ZrpcEndpoint endpoint;
+    if (!ResolveEndpoint(method, rpc_controller, &endpoint)) {
+        fail(Zrpc::RPC_SERVICE_NOT_FOUND, "Service not found: " + service + "." + name);
+        return;
+    }
+
+    // 记录在途请求数和延迟，供负载均衡策略和过载保护使用；实例过载或熔断时不建立连接，直接失败
+    std::shared_ptr<ZrpcEndpointStats> stats = endpoint.stats;
+    auto start = std::chrono::steady_clock::now();
+    std::string reject_reason;
+    if (!StartEndpointCall(stats, IsOverloadProtectionEnabled(), endpoint.Address(), &reject_reason)) {
+        fail(Zrpc::RPC_OVERLOADED, service + "." + name + " rejected, " + reject_reason);
+        return;
+    }
+
+    // 开启了共享内存且实例在同一主机上时，请求和响应都经过共享内存，不再经过内核；握手失败时改用下面的套接字连接
+    if (!endpoint.shm_path.empty() && IsSharedMemoryEnabled()) {
+        if (std::shared_ptr<ZrpcShmConnection> shm = ZrpcShmConnection::GetConnection(endpoint.shm_path, timeout_ms)) {
+            if (rpc_controller) {
+                timeout_ms = rpc_controller->RemainingMs();
+            }
+            if (timeout_ms <= 0) {
+                if (stats) {
+                    stats->OnCallCanceled();  // 预算在本地用完，与实例无关
+                }
+                fail(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded before sending to " + endpoint.shm_path);
+                return;
+            }
+            // 同步调用同样走异步接口：响应在reactor线程上直接从共享内存解析，调用线程只等待完成
+            ZrpcPromise<bool> promise;
+            ZrpcFuture<bool> future = promise.GetFuture();
+            google::protobuf::Closure *call_done = done ? done : google::protobuf::NewCallback(&ZrpcCompletePromise, promise, controller);
+            shm->CallAsync(shm->NextRequestId(), service, name, *request, timeout_ms,
+                           MakeAsyncCompletion(controller, response, call_done, service + "." + name, stats, start),
+                           rpc_controller ? rpc_controller->GetPriority() : Zrpc::PRIORITY_UNSET);
+            if (done == nullptr) {
+                future.Get();
+            }
+            return;
+        }
+    }
+
+    std::shared_ptr<ZrpcMuxConnection> conn = ZrpcMuxConnection::GetConnection(endpoint.ip, endpoint.port, timeout_ms, endpoint.unix_path);
+    if (!conn) {
+        if (stats) {
+            stats->OnCallFinish(ElapsedUs(start), Zrpc::RPC_UNAVAILABLE);  // 连接失败同样计入熔断器
+        }
+        fail(Zrpc::RPC_UNAVAILABLE, "connect server error: " + endpoint.Address());
+        return;
+    }
+    if (rpc_controller) {
+        timeout_ms = rpc_controller->RemainingMs();  // 建立连接可能用掉了一部分预算
+    }
+    if (timeout_ms <= 0) {
+        // 请求头中的时间预算为0表示没有截止时间，预算已经用完时不再发送
+        if (stats) {
+            stats->OnCallCanceled();
+        }
+        fail(Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded before sending to " + endpoint.Address());
+        return;
+    }
+
+    // 编码请求帧，request_id由连接分配，用于匹配响应
+    // 帧编码在线程复用的缓冲区中，连接能立即发完时不再产生拷贝，只有发不完或排队合并时才复制剩余部分
+    uint64_t request_id = conn->NextRequestId();
+    std::string &send_rpc_str = ThreadLocalSendBuffer();
+    ZrpcCompressPolicy compress = GetCompressPolicy(method);
+    if (!ZrpcCodec::EncodeRequest(service, name, request_id, *request, &send_rpc_str, static_cast<uint32_t>(timeout_ms),
+                                  NegotiateCompress(compress, conn->PeerCompressMask()),
+                                  rpc_controller ? rpc_controller->GetPriority() : Zrpc::PRIORITY_UNSET)) {
+        if (stats) {
+            stats->OnCallCanceled();  // 本地的序列化失败，与实例无关
+        }
+        fail(Zrpc::RPC_INTERNAL_ERROR, "serialize request fail");
+        return;
+    }
+
+    // 开启批量调用时把策略交给连接，与同一连接上的其他请求合并发送
+    ZrpcBatchPolicy batch_policy;
+    const ZrpcBatchPolicy *batch = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_batching_enabled) {
+            batch_policy = m_batch_policy;
+            batch = &batch_policy;
+        }
     }
 
-    idx = host_data_1.find(":");  // 查找IP和端口的分隔符
-    if (idx == -1) {  // 如果分隔符不存在
-        LOG(ERROR) << method_path + " address is invalid!";  // 记录错误日志
-        return " ";
+    if (done == nullptr) {
+        // 同步调用：阻塞等待响应
+        std::string body;
+        std::string errtxt;
+        Zrpc::RpcErrorCode code = conn->Call(request_id, send_rpc_str, timeout_ms, &body, &errtxt, batch);
+        if (stats) {
+            stats->OnCallFinish(ElapsedUs(start), code);
+        }
+        if (code != Zrpc::RPC_OK) {
+            fail(code, service + "." + name + " call failed: " + errtxt);
+            return;
+        }
+        if (!response->ParseFromString(body)) {
+            fail(Zrpc::RPC_INTERNAL_ERROR, "parse response error");
+        }
+        return;
     }
 
-    return host_data_1;  // 返回服务地址
+    // 异步调用：直接在reactor线程的接收缓冲区上反序列化，然后执行done
+    conn->CallAsync(request_id, send_rpc_str, timeout_ms,
+                    MakeAsyncCompletion(controller, response, done, service + "." + name, stats, start), batch);
 }
 
-// 构造函数，支持延迟连接
-ZrpcChannel::ZrpcChannel(bool connectNow) : m_clientfd(-1), m_idx(0), m_heartbeat_enabled(false) {
-    if (!connectNow) {  // 如果不需要立即连接
+// 对冲调用：先向选出的实例发送请求，超过近期延迟的百分位数仍未响应时再向另一个实例发送一份，采用先成功的响应
+// 延迟样本不足、只有一个实例或对冲时间超过调用超时时间时，等同于普通的多路复用调用
+void ZrpcChannel::CallMethodHedged(const ::google::protobuf::MethodDescriptor *method,
+                                   Zrpccontroller *controller,
+                                   const ::google::protobuf::Message *request,
+                                   ::google::protobuf::Message *response,
+                                   ::google::protobuf::Closure *done)
+{
+    // 同步调用时用future等待异步调用完成（与其他同步调用一样，不能在reactor线程上调用）
+    ZrpcPromise<bool> promise;
+    ZrpcFuture<bool> future = promise.GetFuture();
+    bool sync = (done == nullptr);
+    if (sync) {
+        done = google::protobuf::NewCallback(&ZrpcCompletePromise, promise, static_cast<google::protobuf::RpcController *>(controller));
+    }
+
+    auto call = std::make_shared<ZrpcHedgedCall>();
+    call->service = method->service()->name();
+    call->method = method->name();
+    call->controller = controller;
+    call->request = request;
+    call->response = response;
+    call->done = done;
+    call->tracker = GetLatencyTracker(method);
+    int timeout_ms = controller->RemainingMs();
+    call->deadline = controller->GetDeadline();
+    call->compress = GetCompressPolicy(method);
+    call->priority = controller->GetPriority();
+    call->protect = IsOverloadProtectionEnabled();
+
+    std::shared_ptr<const ZrpcEndpointList> endpoints =
+        ZrpcServiceRegistry::GetInstance().Lookup(call->service, call->method);
+    const ZrpcEndpoint *primary = nullptr;
+    if (endpoints) {
+        primary = SelectEndpoint(*endpoints, controller);
+    }
+    if (primary == nullptr) {
+        controller->SetFailed(Zrpc::RPC_SERVICE_NOT_FOUND, "Service not found: " + call->service + "." + call->method);
+        done->Run();
         return;
     }
+    call->attempts[0].endpoint = *primary;
+    call->attempts[0].conn = ZrpcMuxConnection::GetConnection(primary->ip, primary->port, timeout_ms, primary->unix_path);
+
+    // 对冲时间取该方法近期延迟的百分位数
+    double percentile;
+    int min_delay_ms;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        percentile = m_hedge_percentile;
+        min_delay_ms = m_hedge_min_delay_ms;
+    }
+    int64_t percentile_us = call->tracker->Percentile(percentile);
+    int hedge_delay_ms = std::max(min_delay_ms, static_cast<int>((percentile_us + 999) / 1000));
 
-    // 尝试连接服务器，最多重试3次
-    auto rt = newConnectWithTimeout(m_ip.c_str(), m_port, 15000);
-    int count = 3;  // 重试次数
-    while (!rt && count--) {
-        rt = newConnectWithTimeout(m_ip.c_str(), m_port, 15000);
+    // 对冲实例从其余实例中选择；按key路由时取排名第二的实例，相同key的对冲请求也总落在同一个实例上
+    if (percentile_us >= 0 && hedge_delay_ms < timeout_ms && endpoints->size() > 1) {
+        ZrpcEndpointList others;
+        others.reserve(endpoints->size() - 1);
+        for (const ZrpcEndpoint &endpoint : *endpoints) {
+            if (endpoint.ip != primary->ip || endpoint.port != primary->port) {
+                others.push_back(endpoint);
+            }
+        }
+        const ZrpcEndpoint *hedge = SelectEndpoint(others, controller);
+        if (hedge != nullptr) {
+            call->attempts[1].endpoint = *hedge;
+            // 在调用方线程上准备好对冲连接，定时器在reactor线程上触发时只需发送
+            call->attempts[1].conn = ZrpcMuxConnection::GetConnection(hedge->ip, hedge->port, timeout_ms, hedge->unix_path);
+        }
     }
-}
\ No newline at end of file
+
+    if (!call->attempts[0].conn) {
+        // 首选实例连接不上，直接使用对冲实例
+        if (!call->attempts[1].conn) {
+            controller->SetFailed(Zrpc::RPC_UNAVAILABLE, "connect server error: " + primary->Address());
+            done->Run();
+            return;
+        }
+        std::swap(call->attempts[0], call->attempts[1]);
+        call->Launch(0);
+    } else {
+        call->Launch(0);
+        if (call->attempts[1].conn) {
+            ZrpcClientReactor::GetInstance().RunAfter(hedge_delay_ms, [call] { call->LaunchHedge(); });
+        }
+    }
+    if (sync) {
+        future.Get();
+    }
+}
+
+// 每个方法一份延迟统计，对冲时间按该方法自己的延迟分布计算
+std::shared_ptr<ZrpcLatencyTracker> ZrpcChannel::GetLatencyTracker(const google::protobuf::MethodDescriptor *method) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_ptr<ZrpcLatencyTracker> &tracker = m_latency_trackers[method->full_name()];
+    if (!tracker) {
+        tracker = std::make_shared<ZrpcLatencyTracker>();
+    }
+    return tracker;
+}
+
+// 设置对冲时间
+void ZrpcChannel::SetHedgingPolicy(double percentile, int min_delay_ms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hedge_percentile = percentile;
+    m_hedge_min_delay_ms = min_delay_ms;
+}
+
+// 通过进程内共享的服务注册表取出提供该方法的实例列表，并选出一个实例：
+// 控制器设置了路由key时按一致性哈希选择，否则按负载均衡策略选择
+bool ZrpcChannel::ResolveEndpoint(const google::protobuf::MethodDescriptor *method, const Zrpccontroller *controller, ZrpcEndpoint *endpoint) {
+    std::shared_ptr<const ZrpcEndpointList> endpoints =
+        ZrpcServiceRegistry::GetInstance().Lookup(method->service()->name(), method->name());
+    if (!endpoints) {
+        return false;
+    }
+    const ZrpcEndpoint *selected = SelectEndpoint(*endpoints, controller);
+    if (selected == nullptr) {
+        LOG(ERROR) << method->full_name() << " has no available instance";
+        return false;
+    }
+    *endpoint = *selected;
+    return true;
+}
+
+// 按key路由或按负载均衡策略选出实例
+// 开启过载保护时避开熔断中的实例；按key路由时不换实例，否则key会落到没有对应数据的实例上
+const ZrpcEndpoint *ZrpcChannel::SelectEndpoint(const ZrpcEndpointList &endpoints, const Zrpccontroller *controller) {
+    if (controller && controller->HasHashKey()) {
+        return ZrpcLoadBalancer::SelectByKey(endpoints, controller->GetHashKey());
+    }
+    const ZrpcEndpoint *selected = m_balancer.Select(endpoints);
+    if (selected == nullptr || !selected->stats || !selected->stats->IsCircuitOpen() || !IsOverloadProtectionEnabled()) {
+        return selected;
+    }
+    size_t index = selected - endpoints.data();
+    for (size_t i = 1; i < endpoints.size(); ++i) {
+        const ZrpcEndpoint &candidate = endpoints[(index + i) % endpoints.size()];
+        if (!candidate.stats || !candidate.stats->IsCircuitOpen()) {
+            return &candidate;
+        }
+    }
+    return selected;  // 所有实例都在熔断中，由准入检查决定是否放行探测请求
+}
+
+// 启用/禁用过载保护
+void ZrpcChannel::EnableOverloadProtection(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_overload_protection = enable;
+}
+
+bool ZrpcChannel::IsOverloadProtectionEnabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_overload_protection;
+}
+
+// 预热：先并行完成服务发现，再把去重后的实例分给若干线程并行建立连接
+ZrpcPrewarmResult ZrpcChannel::Prewarm(const std::vector<const google::protobuf::ServiceDescriptor *> &services,
+                                       const ZrpcPrewarmOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(options.timeout_ms > 0 ? options.timeout_ms : 0);
+    ZrpcPrewarmResult result;
+
+    std::vector<std::pair<std::string, std::string>> methods;
+    for (const google::protobuf::ServiceDescriptor *service : services) {
+        for (int i = 0; i < service->method_count(); ++i) {
+            methods.emplace_back(service->name(), service->method(i)->name());
+        }
+    }
+    result.methods = methods.size();
+
+    ZrpcServiceRegistry &registry = ZrpcServiceRegistry::GetInstance();
+    std::vector<std::string> failed_paths;
+    registry.Prefetch(methods, options.timeout_ms, &failed_paths);
+    for (const std::string &path : failed_paths) {
+        result.failures.push_back(path + ": service discovery failed or timed out");
+    }
+
+    // 每个方法的实例列表（只看已解析成功的方法，失败的方法再查一次会同步阻塞），以及去重后的实例
+    std::vector<std::vector<std::string>> method_endpoints(methods.size());
+    std::vector<ZrpcEndpoint> endpoints;
+    std::unordered_map<std::string, size_t> endpoint_index;  // address -> endpoints中的下标
+    for (size_t i = 0; i < methods.size(); ++i) {
+        std::string path = "/" + methods[i].first + "/" + methods[i].second;
+        if (std::find(failed_paths.begin(), failed_paths.end(), path) != failed_paths.end()) {
+            continue;
+        }
+        std::shared_ptr<const ZrpcEndpointList> list = registry.Lookup(methods[i].first, methods[i].second);
+        if (!list || list->empty()) {
+            result.failures.push_back(path + ": no instance");
+            continue;
+        }
+        for (const ZrpcEndpoint &endpoint : *list) {
+            std::string address = endpoint.Address();
+            method_endpoints[i].push_back(address);
+            if (endpoint_index.emplace(address, endpoints.size()).second) {
+                endpoints.push_back(endpoint);
+            }
+        }
+    }
+    result.endpoints = endpoints.size();
+
+    // 并行建立连接，每个线程依次取下一个实例
+    bool pooled = !IsMultiplexEnabled() && !IsBatchingEnabled() && !IsSharedMemoryEnabled() && !IoUringConfigured();
+    bool shm = IsSharedMemoryEnabled();
+    std::vector<size_t> connections(endpoints.size(), 0);
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < endpoints.size(); i = next++) {
+            int remaining_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (remaining_ms <= 0) {
+                continue;  // 已超时，剩下的实例都记为没有连接
+            }
+            const ZrpcEndpoint &endpoint = endpoints[i];
+            connections[i] = ZrpcMuxConnection::GetConnection(endpoint.ip, endpoint.port, remaining_ms, endpoint.unix_path) ? 1 : 0;
+            if (shm && !endpoint.shm_path.empty() && connections[i] > 0) {
+                remaining_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count());
+                connections[i] += ZrpcShmConnection::GetConnection(endpoint.shm_path, remaining_ms) ? 1 : 0;
+            }
+            if (pooled && connections[i] > 0) {
+                remaining_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count());
+                connections[i] += ZrpcConnectionPool::GetInstance().Prewarm(
+                    endpoint.ip, endpoint.port, options.connections_per_endpoint, remaining_ms, endpoint.unix_path);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    size_t thread_count = std::min(endpoints.size(), kPrewarmThreads);
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();  // 当前线程也参与
+    for (std::thread &t : workers) {
+        t.join();
+    }
+
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        result.connections += connections[i];
+        if (connections[i] == 0) {
+            result.failures.push_back(endpoints[i].Address() + ": connect failed or timed out");
+        }
+    }
+    // 每个方法至少有一个实例可用才算就绪；个别实例连不上时负载均衡仍能用其他实例，不影响就绪
+    result.ready = failed_paths.empty();
+    for (size_t i = 0; i < methods.size() && result.ready; ++i) {
+        bool connected = false;
+        for (const std::string &address : method_endpoints[i]) {
+            connected = connected || connections[endpoint_index[address]] > 0;
+        }
+        result.ready = connected;
+    }
+
+    int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "prewarm " << (result.ready ? "ready" : "not ready") << ": " << result.methods << " methods, "
+              << result.endpoints << " endpoints, " << result.connections << " connections in " << elapsed_ms << "ms";
+    for (const std::string &failure : result.failures) {
+        LOG(WARNING) << "prewarm: " << failure;
+    }
+    return result;
+}
+
+// 设置负载均衡策略
+void ZrpcChannel::SetLoadBalancePolicy(ZrpcLoadBalancer::Policy policy) {
+    m_balancer.SetPolicy(policy);
+}
+
+ZrpcLoadBalancer::Policy ZrpcChannel::GetLoadBalancePolicy() const {
+    return m_balancer.GetPolicy();
+}
+
+// 构造函数
+// 服务地址要到第一次调用时才能通过服务发现确定，connectNow只为兼容保留；连接由连接池按需建立
+ZrpcChannel::ZrpcChannel(bool /*connectNow*/)
+    : m_heartbeat_enabled(false), m_multiplex_enabled(false), m_batching_enabled(false),
+      m_shm_enabled(false), m_overload_protection(false), m_hedge_percentile(0.95), m_hedge_min_delay_ms(1) {
+}
@@ -1,17 +1,26 @@
 #include "Zrpccontroller.h"
 
+// 当前线程上正在处理的请求的截止时间
+static thread_local bool t_has_deadline = false;
+static thread_local std::chrono::steady_clock::time_point t_deadline;
+
 // 构造函数，初始化控制器状态
 Zrpccontroller::Zrpccontroller() {
     m_failed = false;  // 初始状态为未失败
     m_errText = "";    // 错误信息初始为空
+    m_errCode = Zrpc::RPC_OK;
     m_timeout_ms = 15000;  // 默认超时时间15秒
     m_canceled = false;  // 初始未取消
+    m_hedging = false;  // 默认不对冲
+    m_priority = Zrpc::PRIORITY_UNSET;  // 默认由服务端决定优先级
+    SetStartTime();
 }
 
 // 重置控制器状态，将失败标志和错误信息清空
 void Zrpccontroller::Reset() {
     m_failed = false;  // 重置失败标志
     m_errText = "";    // 清空错误信息
+    m_errCode = Zrpc::RPC_OK;
     m_canceled = false;  // 重置取消标志
 }
 
@@ -27,8 +36,17 @@ std::string Zrpccontroller::ErrorText() const {
 
 // 设置RPC调用失败，并记录失败原因
 void Zrpccontroller::SetFailed(const std::string &reason) {
+    SetFailed(Zrpc::RPC_INTERNAL_ERROR, reason);  // 没有给出错误码的失败
+}
+
+void Zrpccontroller::SetFailed(Zrpc::RpcErrorCode code, const std::string &reason) {
     m_failed = true;   // 设置失败标志
     m_errText = reason; // 记录失败原因
+    m_errCode = code;
+}
+
+Zrpc::RpcErrorCode Zrpccontroller::ErrorCode() const {
+    return m_errCode;
 }
 
 // 新增：超时控制功能实现
@@ -40,19 +58,32 @@ int Zrpccontroller::GetTimeout() const {
     return m_timeout_ms;
 }
 
+// 开始计时，同时确定截止时间：在服务端处理请求期间调用时不晚于上游请求的截止时间
 void Zrpccontroller::SetStartTime() {
     m_start_time = std::chrono::steady_clock::now();
+    m_deadline = m_start_time + std::chrono::milliseconds(m_timeout_ms);
+    std::chrono::steady_clock::time_point upstream;
+    if (ZrpcDeadlineScope::Current(&upstream) && upstream < m_deadline) {
+        m_deadline = upstream;
+    }
+}
+
+std::chrono::steady_clock::time_point Zrpccontroller::GetDeadline() const {
+    return m_deadline;
+}
+
+int Zrpccontroller::RemainingMs() const {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_deadline - std::chrono::steady_clock::now());
+    return remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
 }
 
 bool Zrpccontroller::IsTimeout() const {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_start_time);
-    return duration.count() >= m_timeout_ms;
+    return std::chrono::steady_clock::now() >= m_deadline;
 }
 
 void Zrpccontroller::CheckTimeout() {
     if (IsTimeout()) {
-        SetFailed("RPC call timeout after " + std::to_string(m_timeout_ms) + "ms");
+        SetFailed(Zrpc::RPC_DEADLINE_EXCEEDED, "RPC call timeout after " + std::to_string(m_timeout_ms) + "ms");
     }
 }
 
@@ -71,4 +102,55 @@ void Zrpccontroller::NotifyOnCancel(google::protobuf::Closure* callback) {
     if (m_canceled && callback) {
         callback->Run();
     }
-}
\ No newline at end of file
+}
+
+// 新增：按key路由
+void Zrpccontroller::SetHashKey(const std::string &key) {
+    m_hash_key = key;
+}
+
+const std::string &Zrpccontroller::GetHashKey() const {
+    return m_hash_key;
+}
+
+bool Zrpccontroller::HasHashKey() const {
+    return !m_hash_key.empty();
+}
+
+// 新增：请求对冲
+void Zrpccontroller::SetHedging(bool enable) {
+    m_hedging = enable;
+}
+
+bool Zrpccontroller::IsHedgingEnabled() const {
+    return m_hedging;
+}
+
+// 新增：调用的优先级
+void Zrpccontroller::SetPriority(Zrpc::RpcPriority priority) {
+    m_priority = priority;
+}
+
+Zrpc::RpcPriority Zrpccontroller::GetPriority() const {
+    return m_priority;
+}
+
+// 服务端请求的截止时间，作用域结束时恢复外层的值
+ZrpcDeadlineScope::ZrpcDeadlineScope(std::chrono::steady_clock::time_point deadline)
+    : m_prev_valid(t_has_deadline), m_prev(t_deadline) {
+    t_has_deadline = true;
+    t_deadline = deadline;
+}
+
+ZrpcDeadlineScope::~ZrpcDeadlineScope() {
+    t_has_deadline = m_prev_valid;
+    t_deadline = m_prev;
+}
+
+bool ZrpcDeadlineScope::Current(std::chrono::steady_clock::time_point *deadline) {
+    if (!t_has_deadline) {
+        return false;
+    }
+    *deadline = t_deadline;
+    return true;
+}
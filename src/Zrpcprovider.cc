@@ -1,8 +1,16 @@
 #include "Zrpcprovider.h"
 #include "Zrpcapplication.h"
 #include "Zrpcheader.pb.h"
+#include "ZrpcCodec.h"
 #include "ZrpcLogger.h"
+#include "Zrpccontroller.h"
+#include "ZrpcUnixSocket.h"
 #include <iostream>
+#include <chrono>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <algorithm>
 
 // 注册服务对象及其方法，以便服务端能够处理客户端的RPC请求
 void ZrpcProvider::NotifyService(google::protobuf::Service *service) {
@@ -47,41 +55,187 @@ void ZrpcProvider::Run() {
     std::string ip = ZrpcApplication::GetInstance().GetConfig().Load("rpcserverip");
     int port = atoi(ZrpcApplication::GetInstance().GetConfig().Load("rpcserverport").c_str());
 
-    // 使用muduo网络库，创建地址对象
-    muduo::net::InetAddress address(ip, port);
+    Zrpcconfig &config = ZrpcApplication::GetInstance().GetConfig();
+    // IO线程数由rpciothreads指定，默认4个
+    std::string io_threads_conf = config.Load("rpciothreads");
+    int num_io_threads = io_threads_conf.empty() ? 4 : std::max(1, atoi(io_threads_conf.c_str()));
+    // rpcreuseport为1时每个IO线程各自用SO_REUSEPORT监听同一端口，由内核分散新连接，不再由一个线程接受所有连接
+    bool reuse_port = config.Load("rpcreuseport") == "1";
+    // 可选的绑核：rpciocpus、rpcworkercpus分别是IO线程和业务线程使用的CPU列表（如"0-15"），线程轮流绑定到列表中的CPU
+    m_io_cpus.Parse(config.Load("rpciocpus"));
+    m_worker_cpus.Parse(config.Load("rpcworkercpus"));
 
-    // 创建TcpServer对象
-    std::shared_ptr<muduo::net::TcpServer> server = std::make_shared<muduo::net::TcpServer>(&event_loop, address, "ZrpcProvider");
+    // 服务方法在业务线程池中执行，线程数由rpcworkerthreads指定，默认与CPU核数相同（至少4个）；为0时直接在IO线程上执行
+    std::string worker_threads = config.Load("rpcworkerthreads");
+    int num_workers = worker_threads.empty() ? std::max(4, static_cast<int>(std::thread::hardware_concurrency()))
+                                             : atoi(worker_threads.c_str());
+    // 业务线程池按优先级分为PRIORITY_CRITICAL、PRIORITY_NORMAL、PRIORITY_BACKGROUND三个队列，
+    // rpcpriorityweights为各队列的权重（默认"8,4,1"），都有积压时各队列取到的请求数与权重成正比
+    std::vector<uint32_t> priority_weights = {8, 4, 1};
+    std::string weights_conf = config.Load("rpcpriorityweights");
+    if (!weights_conf.empty()) {
+        std::stringstream ss(weights_conf);
+        std::string weight;
+        for (size_t i = 0; i < priority_weights.size() && std::getline(ss, weight, ','); ++i) {
+            priority_weights[i] = std::max(1, atoi(weight.c_str()));
+        }
+    }
+    if (num_workers > 0) {
+        m_executor.reset(new ZrpcExecutor(num_workers, priority_weights));
+        m_executor->SetThreadInitCallback([this] { m_worker_cpus.PinCurrentThread(); });
+        m_executor->Start();
+    }
+
+    // 按排队时间做准入控制（CoDel）：rpcqueuetargetms为排队时间的目标（默认5毫秒，为0时关闭），rpcqueueintervalms为观察窗口（默认100毫秒）
+    // rpcadaptivelifo为1时，过载期间业务线程池改为后进先出
+    std::string queue_target = config.Load("rpcqueuetargetms");
+    std::string queue_interval = config.Load("rpcqueueintervalms");
+    int64_t target_ms = queue_target.empty() ? 5 : atoll(queue_target.c_str());
+    int64_t interval_ms = queue_interval.empty() ? 100 : atoll(queue_interval.c_str());
+    if (target_ms > 0) {
+        for (size_t i = 0; i < priority_weights.size(); ++i) {
+            m_codels.emplace_back(new ZrpcCodel(target_ms * 1000, std::max(interval_ms, target_ms) * 1000));
+        }
+        m_adaptive_lifo = m_executor && config.Load("rpcadaptivelifo") == "1";
+    }
 
-    // 绑定连接回调和消息回调，分离网络连接业务和消息处理业务
-    server->setConnectionCallback(std::bind(&ZrpcProvider::OnConnection, this, std::placeholders::_1));
-    server->setMessageCallback(std::bind(&ZrpcProvider::OnMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    // rpcioengine为io_uring时TCP连接改由io_uring引擎处理（批量提交、多发accept/recv），内核不支持时回退到muduo（epoll）
+    std::string io_engine = config.Load("rpcioengine");
+    if (io_engine == "io_uring") {
+        m_uring_server.reset(new ZrpcUringServer(ip, static_cast<uint16_t>(port), "ZrpcProvider"));
+        m_uring_server->SetThreadNum(num_io_threads);
+        m_uring_server->SetReusePort(reuse_port);
+        m_uring_server->SetThreadInitCallback([this] { m_io_cpus.PinCurrentThread(); });
+        m_uring_server->SetRequestCallback(std::bind(&ZrpcProvider::HandleRequest, this, std::placeholders::_1, std::placeholders::_2,
+                                                     std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+        if (!m_uring_server->Start()) {
+            LOG(WARNING) << "io_uring engine unavailable, fall back to epoll";
+            m_uring_server.reset();
+        }
+    } else if (!io_engine.empty() && io_engine != "epoll") {
+        LOG(WARNING) << "unknown rpcioengine " << io_engine << ", use epoll";
+    }
+
+    muduo::net::EventLoopThreadPool::ThreadInitCallback pin_io_thread = [this](muduo::net::EventLoop *) {
+        m_io_cpus.PinCurrentThread();
+    };
+    std::vector<std::shared_ptr<muduo::net::TcpServer>> servers;
+    std::shared_ptr<muduo::net::EventLoopThreadPool> io_threads;  // Unix域套接字和共享内存会话使用的IO线程
+    if (!m_uring_server && !reuse_port) {
+        // 使用muduo网络库，创建地址对象
+        muduo::net::InetAddress address(ip, port);
+
+        // 创建TcpServer对象
+        std::shared_ptr<muduo::net::TcpServer> server = std::make_shared<muduo::net::TcpServer>(&event_loop, address, "ZrpcProvider");
+
+        // 绑定连接回调和消息回调，分离网络连接业务和消息处理业务
+        server->setConnectionCallback(std::bind(&ZrpcProvider::OnConnection, this, std::placeholders::_1));
+        server->setMessageCallback(std::bind(&ZrpcProvider::OnMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 /*回调函数由 Muduo 的 EventLoop 在检测到相关事件时​​自动调用​​，开发者无需手动调用。==>普通函数直接使用函数名即可进行调用，类成员函数需要bind*/
-    // 设置muduo库的线程数量
-    server->setThreadNum(4);
+        // 设置muduo库的线程数量
+        server->setThreadNum(num_io_threads);
+        server->setThreadInitCallback(pin_io_thread);
+        server->start();  // 先启动IO线程，Unix域套接字上的连接也分配给它们
+        io_threads = server->threadPool();
+        servers.push_back(server);
+    } else {
+        // TCP由io_uring引擎处理，或者每个IO线程各自监听：先单独创建IO线程，本机的Unix域套接字和共享内存也使用它们
+        io_threads = std::make_shared<muduo::net::EventLoopThreadPool>(&event_loop, "ZrpcProvider");
+        io_threads->setThreadNum(num_io_threads);
+        io_threads->start(pin_io_thread);
+    }
+    if (!m_uring_server && reuse_port) {
+        // 每个IO线程上一个开启SO_REUSEPORT的TcpServer，接受的连接就在本线程上处理（线程数为0）
+        muduo::net::InetAddress address(ip, port);
+        for (muduo::net::EventLoop *loop : io_threads->getAllLoops()) {
+            std::shared_ptr<muduo::net::TcpServer> server =
+                std::make_shared<muduo::net::TcpServer>(loop, address, "ZrpcProvider", muduo::net::TcpServer::kReusePort);
+            server->setConnectionCallback(std::bind(&ZrpcProvider::OnConnection, this, std::placeholders::_1));
+            server->setMessageCallback(std::bind(&ZrpcProvider::OnMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+            loop->runInLoop([server] { server->start(); });  // TcpServer只能在所属的loop线程上启动
+            servers.push_back(server);
+        }
+    }
+
+    // 同时在Unix域套接字上监听，供同一主机上的调用方使用；rpcserverunixpath为none时关闭
+    std::string unix_path = ZrpcApplication::GetInstance().GetConfig().Load("rpcserverunixpath");
+    if (unix_path.empty()) {
+        unix_path = ZrpcUnixSocket::DefaultPath(static_cast<uint16_t>(port));
+    }
+    if (unix_path != "none") {
+        m_unix_server.reset(new ZrpcUnixServer(&event_loop, unix_path, "ZrpcProvider"));
+        m_unix_server->setConnectionCallback(std::bind(&ZrpcProvider::OnConnection, this, std::placeholders::_1));
+        m_unix_server->setMessageCallback(std::bind(&ZrpcProvider::OnMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        if (!m_unix_server->Start(io_threads)) {
+            m_unix_server.reset();
+        }
+    }
+
+    // 同一主机上的调用方还可以改用共享内存收发请求，握手在单独的Unix域套接字上进行；rpcservershmpath为none时关闭
+    if (m_unix_server) {
+        std::string shm_path = ZrpcApplication::GetInstance().GetConfig().Load("rpcservershmpath");
+        if (shm_path.empty()) {
+            shm_path = m_unix_server->Path() + ".shm";
+        }
+        if (shm_path != "none") {
+            m_shm_server.reset(new ZrpcShmServer(&event_loop, shm_path, "ZrpcProvider"));
+            m_shm_server->SetFrameCallback(std::bind(&ZrpcProvider::OnShmFrame, this, std::placeholders::_1, std::placeholders::_2,
+                                                     std::placeholders::_3, std::placeholders::_4));
+            if (!m_shm_server->Start(io_threads)) {
+                m_shm_server.reset();
+            }
+        }
+    }
 
     // 将当前RPC节点上要发布的服务全部注册到ZooKeeper上，让RPC客户端可以在ZooKeeper上发现服务
+    // 同一个服务可以由多个实例提供：每个实例在 /service/method 下注册一个以 "ip:port" 命名的临时子节点，
+    // 节点数据是实例属性，客户端据此在多个实例之间做负载均衡
+    std::string weight = ZrpcApplication::GetInstance().GetConfig().Load("rpcserverweight");
+    std::string instance_name = ip + ":" + std::to_string(port);
+    std::string instance_data = "weight=" + (weight.empty() ? std::string("100") : weight);
+    if (m_unix_server) {
+        // 同一主机（host相同）上的调用方改用Unix域套接字连接
+        instance_data += ";unix=" + m_unix_server->Path() + ";host=" + ZrpcUnixSocket::LocalHostId();
+    }
+    if (m_shm_server) {
+        instance_data += ";shm=" + m_shm_server->Path();  // 开启了共享内存传输的调用方据此握手
+    }
+
     ZkClient zkclient;
     zkclient.Start();  // 连接ZooKeeper服务器
-    // service_name为永久节点，method_name为临时节点
+    // service_name和method_name为永久节点，实例为临时节点
     for (auto &sp : service_map) {
         // service_name 在ZooKeeper中的目录是"/"+service_name
         std::string service_path = "/" + sp.first;
         zkclient.Create(service_path.c_str(), nullptr, 0);  // 创建服务节点
         for (auto &mp : sp.second.method_map) {
             std::string method_path = service_path + "/" + mp.first;
-            char method_path_data[128] = {0};
-            sprintf(method_path_data, "%s:%d", ip.c_str(), port);  // 将IP和端口信息存入节点数据
+            zkclient.Create(method_path.c_str(), nullptr, 0);  // 创建方法节点
+            std::string instance_path = method_path + "/" + instance_name;
+            // 本实例快速重启时，上一个会话留下的临时节点可能还没过期，先删除再创建，避免随旧会话过期而被删掉
+            zkclient.Delete(instance_path.c_str());
             // ZOO_EPHEMERAL表示这个节点是临时节点，在客户端断开连接后，ZooKeeper会自动删除这个节点
-            zkclient.Create(method_path.c_str(), method_path_data, strlen(method_path_data), ZOO_EPHEMERAL);
+            zkclient.Create(instance_path.c_str(), instance_data.c_str(), instance_data.size(), ZOO_EPHEMERAL);
         }
     }
 
     // RPC服务端准备启动，打印信息
-    std::cout << "RpcProvider start service at ip:" << ip << " port:" << port << std::endl;
+    std::cout << "RpcProvider start service at ip:" << ip << " port:" << port;
+    if (m_uring_server) {
+        std::cout << " (io_uring)";
+    }
+    if (m_unix_server) {
+        std::cout << " unix:" << m_unix_server->Path();
+    }
+    if (m_shm_server) {
+        std::cout << " shm:" << m_shm_server->Path();
+    }
+    std::cout << " io_threads:" << num_io_threads << (reuse_port ? " (SO_REUSEPORT)" : "");
+    if (m_executor) {
+        std::cout << " workers:" << m_executor->ThreadNum();
+    }
+    std::cout << std::endl;
 
-    // 启动网络服务
-    server->start();
     event_loop.loop();  // 进入事件循环
 }
 
@@ -94,58 +248,112 @@ void ZrpcProvider::OnConnection(const muduo::net::TcpConnectionPtr &conn) {
 }
 /*防止数据粘包，需要定义几个不同字段的长度*/
 // 消息回调函数，处理客户端发送的RPC请求
+// 一次读到的数据可能包含多个请求帧（客户端流水线发送或批量发送），也可能只有半个帧：
+// 逐个取出完整的帧直接在接收缓冲区上解析并分发，不完整的帧留在缓冲区中等下一次读到数据
 void ZrpcProvider::OnMessage(const muduo::net::TcpConnectionPtr &conn, muduo::net::Buffer *buffer, muduo::Timestamp receive_time) {
-    std::cout << "OnMessage" << std::endl;
-
-    // 从网络缓冲区中读取远程RPC调用请求的字符流
-    std::string recv_buf = buffer->retrieveAllAsString();
-
-    // 使用protobuf的CodedInputStream反序列化RPC请求
-    google::protobuf::io::ArrayInputStream raw_input(recv_buf.data(), recv_buf.size());
-    google::protobuf::io::CodedInputStream coded_input(&raw_input);
-
-    uint32_t header_size{};
-    coded_input.ReadVarint32(&header_size);  // 解析header_size
-
-    // 根据header_size读取数据头的原始字符流，反序列化数据，得到RPC请求的详细信息
-    std::string rpc_header_str;
-    Zrpc::RpcHeader ZrpcHeader;
-    std::string service_name;
-    std::string method_name;
-    uint32_t args_size{};
-
-    // 设置读取限制
-    google::protobuf::io::CodedInputStream::Limit msg_limit = coded_input.PushLimit(header_size);
-    coded_input.ReadString(&rpc_header_str, header_size);
-    // 恢复之前的限制，以便安全地继续读取其他数据
-    coded_input.PopLimit(msg_limit);
-
-    if (ZrpcHeader.ParseFromString(rpc_header_str)) {
-        service_name = ZrpcHeader.service_name();
-        method_name = ZrpcHeader.method_name();
-        args_size = ZrpcHeader.args_size();
-    } else {
-        ZrpcLogger::ERROR("ZrpcHeader parse error");
-        return;
+    ZrpcResponderPtr responder;  // 同一次读到的请求共用一个响应者
+    while (buffer->readableBytes() > 0) {
+        Zrpc::RpcHeader header;
+        const char *args = nullptr;
+        int frame_len = ZrpcCodec::DecodeRequest(buffer->peek(), buffer->readableBytes(), &header, &args);
+        if (frame_len == 0) {
+            break;  // 数据还不完整
+        }
+        if (frame_len < 0) {
+            // 报文格式错误时无法再找到下一个帧的边界，丢弃已收到的数据并关闭连接
+            ZrpcLogger::ERROR("ZrpcHeader parse error, close connection");
+            buffer->retrieveAll();
+            conn->shutdown();
+            return;
+        }
+        if (!responder) {
+            responder = std::make_shared<ZrpcConnectionResponder>(conn);
+        }
+        // 请求参数在分发时就已反序列化，之后才把这个帧从缓冲区中移除
+        if (!HandleRequest(responder, header, args, header.args_size(), receive_time)) {
+            // 批量请求的格式有误，其中的调用都无法应答：关闭连接，调用方立即让这条连接上的调用失败，不必等到超时
+            buffer->retrieveAll();
+            conn->shutdown();
+            return;
+        }
+        buffer->retrieve(frame_len);
     }
+}
 
-    std::string args_str;  // RPC参数
-    // 直接读取args_size长度的字符串数据
-    bool read_args_success = coded_input.ReadString(&args_str, args_size);
-    if (!read_args_success) {
-        ZrpcLogger::ERROR("read args error");
+// 共享内存上的每条记录正好是一个请求帧，直接在共享内存上解析，请求参数在分发时反序列化后记录才被释放
+void ZrpcProvider::OnShmFrame(const ZrpcShmSessionPtr &session, const char *data, size_t len, muduo::Timestamp receive_time) {
+    Zrpc::RpcHeader header;
+    const char *args = nullptr;
+    int frame_len = ZrpcCodec::DecodeRequest(data, len, &header, &args);
+    if (frame_len <= 0 || static_cast<size_t>(frame_len) != len) {
+        ZrpcLogger::ERROR("shared memory request parse error");
         return;
     }
+    if (!HandleRequest(session, header, args, header.args_size(), receive_time)) {
+        session->Abort("malformed batch request");  // 同TCP连接，关闭会话让调用方的调用立即失败
+    }
+}
+
+// 处理一个完整的请求：单个调用直接分发，批量请求拆开后逐个分发
+bool ZrpcProvider::HandleRequest(const ZrpcResponderPtr &responder, const Zrpc::RpcHeader &header,
+                                 const char *args, size_t args_size, muduo::Timestamp receive_time) {
+    if (header.batch_count() == 0) {
+        DispatchCall(responder, header, args, args_size, receive_time, nullptr);
+        return true;
+    }
+
+    // 批量请求：请求体是依次拼接的多个请求帧，先全部解析一遍，格式有误时返回false，由调用方关闭连接
+    if (header.batch_count() > args_size) {  // 每个帧至少占一个字节，防止异常的计数导致大量分配
+        ZrpcLogger::ERROR("batch request count error");
+        return false;
+    }
+    std::vector<Zrpc::RpcHeader> headers(header.batch_count());
+    std::vector<const char *> bodies(header.batch_count());
+    const char *data = args;
+    size_t remaining = args_size;
+    for (uint32_t i = 0; i < header.batch_count(); ++i) {
+        int frame_len = ZrpcCodec::DecodeRequest(data, remaining, &headers[i], &bodies[i]);
+        if (frame_len <= 0 || headers[i].batch_count() != 0) {
+            ZrpcLogger::ERROR("batch request parse error");
+            return false;
+        }
+        data += frame_len;
+        remaining -= frame_len;
+    }
+    if (remaining != 0) {
+        ZrpcLogger::ERROR("batch request size mismatch");
+        return false;
+    }
+
+    // 逐个分发，全部完成后（最后一个done执行时）合并响应
+    std::shared_ptr<BatchReply> batch = std::make_shared<BatchReply>();
+    batch->count = header.batch_count();
+    batch->remaining = batch->count;
+    for (uint32_t i = 0; i < header.batch_count(); ++i) {
+        DispatchCall(responder, headers[i], bodies[i], headers[i].args_size(), receive_time, batch);
+    }
+    return true;
+}
+
+// 分发一个调用，结果（包括各种失败）都会通过SendRpcResponse/SendErrorResponse返回给调用方
+void ZrpcProvider::DispatchCall(const ZrpcResponderPtr &responder, const Zrpc::RpcHeader &header,
+                                const char *args, size_t args_size, muduo::Timestamp receive_time,
+                                const std::shared_ptr<BatchReply> &batch) {
+    const std::string &service_name = header.service_name();
+    const std::string &method_name = header.method_name();
+    uint64_t request_id = header.request_id();  // 响应中原样带回，客户端据此匹配多路复用连接上的响应
 
     // 获取service对象和method对象
     auto it = service_map.find(service_name);
     if (it == service_map.end()) {
         std::cout << service_name << " is not exist!" << std::endl;
+        SendErrorResponse(responder, request_id, Zrpc::RPC_SERVICE_NOT_FOUND, service_name + " is not exist", batch);
         return;
     }
     auto mit = it->second.method_map.find(method_name);
     if (mit == it->second.method_map.end()) {
         std::cout << service_name << "." << method_name << " is not exist!" << std::endl;
+        SendErrorResponse(responder, request_id, Zrpc::RPC_METHOD_NOT_FOUND, service_name + "." + method_name + " is not exist", batch);
         return;
     }
 
@@ -154,33 +362,179 @@ void ZrpcProvider::OnMessage(const muduo::net::TcpConnectionPtr &conn, muduo::ne
 
     // 生成RPC方法调用请求的request和响应的response参数
     google::protobuf::Message *request = service->GetRequestPrototype(method).New();  // 动态创建请求对象
-    if (!request->ParseFromString(args_str)) {
+    if (!ZrpcCodec::ParseBody(header.compress_type(), args, args_size, request)) {  // 压缩过的请求体先解压
         std::cout << service_name << "." << method_name << " parse error!" << std::endl;
+        delete request;
+        SendErrorResponse(responder, request_id, Zrpc::RPC_BAD_REQUEST, service_name + "." + method_name + " parse error", batch);
         return;
     }
     google::protobuf::Message *response = service->GetResponsePrototype(method).New();  // 动态创建响应对象
 
-    // 绑定回调函数，用于在方法调用完成后发送响应
-    google::protobuf::Closure *done = google::protobuf::NewCallback<ZrpcProvider,
-                                                                    const muduo::net::TcpConnectionPtr &,
-                                                                    google::protobuf::Message *>(this,
-                                                                                                 &ZrpcProvider::SendRpcResponse,
-                                                                                                 conn, response);
+    // 保存本次调用的上下文，响应发送后统一释放
+    RpcCall *call = new RpcCall;
+    call->request_id = request_id;
+    call->responder = responder;
+    call->request = request;
+    call->response = response;
+    call->batch = batch;
+    // 调用方声明支持该方法配置的压缩算法时才压缩响应
+    auto cit = m_method_compress.find(service_name + "." + method_name);
+    call->compress = cit != m_method_compress.end() ? cit->second : m_default_compress;
+    if ((header.accept_compress() & (1u << call->compress.type)) == 0) {
+        call->compress.type = Zrpc::COMPRESS_NONE;
+    }
+    call->service = service;
+    call->method = method;
+    call->receive_time = receive_time;
+    call->timeout_ms = header.timeout_ms();
+    // 调用方在请求头中指定的优先级优先，否则使用方法配置的优先级
+    Zrpc::RpcPriority priority = header.priority();
+    if (priority == Zrpc::PRIORITY_UNSET) {
+        auto pit = m_method_priority.find(service_name + "." + method_name);
+        priority = pit != m_method_priority.end() ? pit->second : Zrpc::PRIORITY_NORMAL;
+    }
+    call->priority_class = std::min(std::max(static_cast<int>(priority), 1), static_cast<int>(Zrpc::PRIORITY_BACKGROUND)) - 1;
+
+    // 服务方法可能阻塞，交给业务线程池执行，IO线程继续处理其他连接；按优先级放入对应的队列
+    if (m_executor) {
+        m_executor->Submit([this, call] { RunCall(call); }, call->priority_class);
+    } else {
+        RunCall(call);
+    }
+}
+
+void ZrpcProvider::RunCall(RpcCall *call) {
+    int64_t now_us = muduo::Timestamp::now().microSecondsSinceEpoch();
+    int64_t queued_us = now_us - call->receive_time.microSecondsSinceEpoch();  // 收到请求到开始执行之间的排队时间
+
+    // 每个请求的排队时间都交给所属优先级的准入控制统计，包括下面因超过截止时间而拒绝的请求
+    // 各优先级分开统计，后台请求积压时只拒绝后台请求，不会因此拒绝关键请求
+    bool shed = false;
+    if (!m_codels.empty()) {
+        ZrpcCodel &codel = *m_codels[call->priority_class];
+        shed = codel.ShouldDrop(queued_us, now_us);
+        if (m_adaptive_lifo) {
+            m_executor->SetLifo(call->priority_class, codel.Overloaded());
+        }
+    }
+
+    // 按接收时间换算请求的截止时间：在服务端排队期间已经超时的请求，调用方不再等待结果，直接拒绝而不执行
+    std::chrono::steady_clock::time_point deadline;
+    if (call->timeout_ms > 0) {
+        if (queued_us >= static_cast<int64_t>(call->timeout_ms) * 1000) {
+            LOG(WARNING) << call->method->service()->name() << "." << call->method->name() << " dropped: queued " << queued_us / 1000 << "ms, budget " << call->timeout_ms << "ms";
+            DropCall(call, Zrpc::RPC_DEADLINE_EXCEEDED, "deadline exceeded");
+            return;
+        }
+        deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<int64_t>(call->timeout_ms) * 1000 - queued_us);
+    }
+
+    // 持续过载时排队过久的请求以RPC_OVERLOADED快速拒绝，调用方的过载保护据此减少发往本实例的请求
+    if (shed) {
+        DropCall(call, Zrpc::RPC_OVERLOADED, "overloaded, queued " + std::to_string(queued_us / 1000) + "ms");
+        return;
+    }
+
+    // 绑定回调函数，用于在方法调用完成后发送响应；响应交给发送目标，由连接所属的IO线程写出
+    google::protobuf::Closure *done = google::protobuf::NewCallback<ZrpcProvider, RpcCall *>(this,
+                                                                                          &ZrpcProvider::SendRpcResponse,
+                                                                                          call);
 
     // 在框架上根据远端RPC请求，调用当前RPC节点上发布的方法
-    service->CallMethod(method, nullptr, request, response, done);  // 调用服务方法
+    // 处理期间在当前线程上记录截止时间，处理函数中同步发起的嵌套调用会继承剩余的预算
+    if (call->timeout_ms > 0) {
+        ZrpcDeadlineScope deadline_scope(deadline);
+        call->service->CallMethod(call->method, nullptr, call->request, call->response, done);  // 调用服务方法
+    } else {
+        call->service->CallMethod(call->method, nullptr, call->request, call->response, done);  // 调用服务方法
+    }
+}
+
+void ZrpcProvider::DropCall(RpcCall *call, Zrpc::RpcErrorCode error_code, const std::string &error_text) {
+    SendErrorResponse(call->responder, call->request_id, error_code,
+                      call->method->service()->name() + "." + call->method->name() + " " + error_text, call->batch);
+    delete call->request;
+    delete call->response;
+    delete call;
+}
+
+// 设置响应体压缩策略
+void ZrpcProvider::SetCompression(Zrpc::CompressType type, uint32_t min_bytes, const std::string &method) {
+    ZrpcCompressPolicy policy;
+    policy.type = type;
+    policy.min_bytes = min_bytes;
+    if (method.empty()) {
+        m_default_compress = policy;
+    } else {
+        m_method_compress[method] = policy;
+    }
+}
+
+// 设置方法的优先级
+void ZrpcProvider::SetMethodPriority(const std::string &method, Zrpc::RpcPriority priority) {
+    m_method_priority[method] = priority;
 }
 
 // 发送RPC响应给客户端
-void ZrpcProvider::SendRpcResponse(const muduo::net::TcpConnectionPtr &conn, google::protobuf::Message *response) {
-    std::string response_str;
-    if (response->SerializeToString(&response_str)) {
-        // 序列化成功，通过网络把RPC方法执行的结果返回给RPC调用方
-        conn->send(response_str);
+void ZrpcProvider::SendRpcResponse(RpcCall *call) {
+    bool sent;
+    if (!call->batch) {
+        // 单个调用的响应交给发送目标编码并发送：套接字连接编码后交给muduo，共享内存会话直接编码到环上
+        sent = call->responder->SendResponse(call->request_id, *call->response, &call->compress);
     } else {
+        std::string response_str;
+        sent = ZrpcCodec::EncodeResponse(call->request_id, *call->response, &response_str, &call->compress);
+        if (sent) {
+            SendFrame(call->responder, response_str, call->batch);
+        }
+    }
+    if (!sent) {
         std::cout << "serialize error!" << std::endl;
+        SendErrorResponse(call->responder, call->request_id, Zrpc::RPC_INTERNAL_ERROR, "serialize response error", call->batch);
     }
     // conn->shutdown(); // 模拟HTTP短链接，由RpcProvider主动断开连接
+    delete call->request;
+    delete call->response;
+    delete call;
+}
+
+// 发送失败响应，让调用方尽快得到失败原因
+void ZrpcProvider::SendErrorResponse(const ZrpcResponderPtr &responder, uint64_t request_id,
+                                     Zrpc::RpcErrorCode error_code, const std::string &error_text,
+                                     const std::shared_ptr<BatchReply> &batch) {
+    std::string response_str;
+    if (!ZrpcCodec::EncodeErrorResponse(request_id, error_code, error_text, &response_str)) {
+        response_str.clear();  // 批量请求中仍需计数，否则整批响应永远不会发出
+    }
+    SendFrame(responder, response_str, batch);
+}
+
+// 单个调用直接发送响应帧；批量请求中的调用先收集，最后一个完成时合并为一个批量响应帧发送
+void ZrpcProvider::SendFrame(const ZrpcResponderPtr &responder, const std::string &frame,
+                             const std::shared_ptr<BatchReply> &batch) {
+    if (!batch) {
+        if (!frame.empty()) {
+            responder->Send(frame);
+        }
+        return;
+    }
+
+    std::string batch_frame;
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if (!frame.empty()) {
+            batch->frames.append(frame);
+        } else {
+            batch->count--;  // 没有编码出响应帧的调用不计入批量响应
+        }
+        if (--batch->remaining > 0) {
+            return;
+        }
+        if (batch->count == 0 || !ZrpcCodec::EncodeBatchResponse(batch->frames, batch->count, &batch_frame)) {
+            return;
+        }
+    }
+    responder->Send(batch_frame);
 }
 
 // 析构函数，退出事件循环
@@ -0,0 +1,50 @@
+#ifndef _ZrpcBuffer_H
+#define _ZrpcBuffer_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <sys/types.h>
+
+// 可增长、可复用的字节缓冲区，用于增量地接收和解析报文
+// +-------------------+------------------+------------------+
+// | 已读取(可回收)     |  可读数据         |  可写空间         |
+// +-------------------+------------------+------------------+
+// 0             m_reader_index     m_writer_index      capacity
+// 数据被取走后只移动下标，空间不足时优先回收已读取的部分，不够再扩容；缓冲区本身可以跨调用复用
+class ZrpcBuffer
+{
+public:
+    static const size_t kInitialSize = 4096;
+
+    explicit ZrpcBuffer(size_t initial_size = kInitialSize);
+
+    size_t ReadableBytes() const { return m_writer_index - m_reader_index; }
+    size_t WritableBytes() const { return m_buffer.size() - m_writer_index; }
+    const char *Peek() const { return m_buffer.data() + m_reader_index; }
+
+    // 取走len字节的可读数据
+    void Retrieve(size_t len);
+    void RetrieveAll();
+
+    void Append(const char *data, size_t len);
+    void Append(const std::string &data) { Append(data.data(), data.size()); }
+
+    // 直接写入可写空间，写完后调用HasWritten
+    void EnsureWritable(size_t len);
+    char *BeginWrite() { return m_buffer.data() + m_writer_index; }
+    void HasWritten(size_t len) { m_writer_index += len; }
+
+    // 从fd读取数据：先读入缓冲区剩余空间，多出的部分借助栈上的临时空间一次读完
+    // 返回读到的字节数，出错时返回-1并通过saved_errno带回错误码
+    ssize_t ReadFd(int fd, int *saved_errno);
+
+private:
+    void MakeSpace(size_t len);
+
+    std::vector<char> m_buffer;
+    size_t m_reader_index;
+    size_t m_writer_index;
+};
+
+#endif
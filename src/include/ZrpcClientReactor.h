@@ -0,0 +1,124 @@
+#ifndef _ZrpcClientReactor_H
+#define _ZrpcClientReactor_H
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "ZrpcTimerWheel.h"
+#include "ZrpcUring.h"
+
+class ZrpcMuxConnection;
+struct epoll_event;
+
+// 客户端共享的事件循环（epoll，配置rpcioengine=io_uring时使用io_uring）
+// 一个进程只有一个reactor线程，负责驱动所有多路复用连接的读写、定时器（调用超时、对冲等），并在该线程上执行异步调用的done回调
+// io_uring引擎下连接的数据由多发接收直接交给连接解析，请求不在调用线程上发送，而是由reactor合并成一批发送操作一次提交
+// 所有channel的调用超时都登记在同一个分层时间轮上，未完成调用再多，添加/取消超时也是O(1)
+// 注意：done回调运行在reactor线程上，不要在其中发起同步RPC调用，否则会阻塞所有连接
+class ZrpcClientReactor
+{
+public:
+    typedef std::function<void()> Functor;
+    typedef ZrpcTimerWheel::TimerId TimerId;
+
+    static ZrpcClientReactor &GetInstance();
+
+    // 注册/注销连接，连接的fd必须是非阻塞的
+    // fd为-1时注册conn->GetFd()；一个连接可以注册多个fd（如共享内存连接的门铃），任一fd上的事件都交给该连接处理
+    bool AddConnection(const std::shared_ptr<ZrpcMuxConnection> &conn, int fd = -1);
+    void RemoveConnection(int fd);
+
+    // 连接有待发送的数据时关注可写事件，发送完毕后取消（只用于epoll）
+    void EnableWriting(int fd, bool enable);
+
+    // 是否使用io_uring引擎，此时连接不自己发送，有数据待发送时调用RequestSend
+    bool UsesIoUring() const { return m_uring != nullptr; }
+    // 连接的输出缓冲区从空变为非空：由reactor在本轮事件处理之后取出并提交发送
+    void RequestSend(const std::shared_ptr<ZrpcMuxConnection> &conn);
+
+    // 在reactor线程中执行任务
+    void RunInLoop(Functor cb);
+    // 总是排队到本轮事件处理之后执行，即使当前就在reactor线程上；用于合并同一轮中产生的多个操作（如批量发送）
+    void QueueInLoop(Functor cb);
+    // 定时任务：到期后在reactor线程中执行，可以在到期前取消
+    TimerId RunAt(std::chrono::steady_clock::time_point when, Functor cb);
+    TimerId RunAfter(int delay_ms, Functor cb);
+    void CancelTimer(TimerId id);
+    bool IsInLoopThread() const;
+
+private:
+    ZrpcClientReactor();
+    ~ZrpcClientReactor();
+    ZrpcClientReactor(const ZrpcClientReactor &) = delete;
+    ZrpcClientReactor &operator=(const ZrpcClientReactor &) = delete;
+
+    // io_uring引擎下一个注册的fd
+    struct UringEntry
+    {
+        std::shared_ptr<ZrpcMuxConnection> conn;
+        int fd = -1;
+        int slot = -1;               // 固定文件表中的槽位
+        bool stream = true;          // 套接字字节流用多发接收，其他fd（共享内存连接的门铃等）用多发poll
+        bool armed = false;          // 多发接收/poll仍然有效
+        bool removed = false;        // 已经注销，所有操作完成后释放
+        bool send_inflight = false;
+        std::string sending;         // 正在发送的数据，发送操作完成前不能改动
+        size_t sending_offset = 0;
+    };
+
+    void Loop();
+    void PollEpoll(int timeout_ms, std::vector<struct epoll_event> *events);
+    void PollUring(int timeout_ms);
+    void Wakeup();
+    void HandleWakeup();
+    void DoPendingFunctors();
+    void RunExpiredTimers();
+
+    // 以下只在reactor线程中调用
+    void ArmUringEntry(const std::shared_ptr<ZrpcMuxConnection> &conn, int fd);
+    void DisarmUringEntry(int fd);
+    bool ArmUringRead(uint64_t token, UringEntry &entry);
+    void HandleUringCompletion(const ZrpcUring::Completion &completion);
+    void HandleUringSend(uint64_t token, UringEntry &entry, int res);
+    void StartUringSend(const std::shared_ptr<ZrpcMuxConnection> &conn);
+    void ReleaseUringEntry(uint64_t token);
+
+    int m_epollfd;
+    int m_wakeupfd;  // eventfd，用于唤醒阻塞在epoll_wait（或io_uring_enter）上的reactor线程
+    std::atomic<bool> m_wakeup_pending;  // 已经写过eventfd、reactor还没有处理，之后的唤醒不必再写
+    uint64_t m_wakeup_value;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    std::thread::id m_thread_id;
+
+    std::mutex m_mutex;
+    std::unordered_map<int, std::shared_ptr<ZrpcMuxConnection>> m_connections;  // fd -> 连接
+    std::vector<Functor> m_pending_functors;
+
+    ZrpcTimerWheel m_timer_wheel;
+    // reactor计划醒来的时刻（steady_clock的纳秒数），新定时器早于它时才需要唤醒reactor
+    std::atomic<int64_t> m_wakeup_at;
+
+    // io_uring引擎，为空时使用epoll；以下只在reactor线程访问
+    std::unique_ptr<ZrpcUring> m_uring;
+    std::unordered_map<uint64_t, UringEntry> m_uring_entries;  // 编号 -> 注册项，元素的引用在插入其他元素后仍然有效
+    std::unordered_map<int, uint64_t> m_uring_tokens;          // fd -> 编号
+    uint64_t m_next_uring_token;
+
+    // epoll_wait的最长等待时间（毫秒）
+    static constexpr int kPollTimeoutMs = 100;
+    // io_uring引擎的提交队列长度、接收缓冲区、固定文件表容量
+    static constexpr unsigned kUringEntries = 256;
+    static constexpr unsigned kUringBufferCount = 256;
+    static constexpr unsigned kUringBufferSize = 16 * 1024;
+    static constexpr unsigned kUringFixedFiles = 1024;
+};
+
+#endif
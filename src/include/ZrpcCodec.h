@@ -0,0 +1,86 @@
+#ifndef _ZrpcCodec_H
+#define _ZrpcCodec_H
+
+#include <google/protobuf/message.h>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include "Zrpcheader.pb.h"
+#include "ZrpcCompression.h"
+
+// RPC报文编解码工具
+// 请求与响应采用统一的帧格式：varint32(header_size) + header + body
+// 请求头为 Zrpc::RpcHeader，响应头为 Zrpc::RpcResponseHeader，两者都携带 request_id
+// 编码时头部和消息体直接序列化到out的尾部，out可以是调用方复用的缓冲区，保留的容量避免每次调用重新分配
+class ZrpcCodec
+{
+public:
+    // 单个报文的最大长度，超过视为格式错误，防止异常的长度字段导致无限制地分配内存
+    static const uint32_t kMaxFrameSize = 64 * 1024 * 1024;
+
+    // 帧的输出位置：返回至少frame_len字节的连续可写内存，无法提供时返回nullptr（编码失败）
+    // 用于把帧直接编码到调用方管理的内存中（如共享内存环上预留的空间），不经过中间字符串
+    typedef std::function<uint8_t *(size_t frame_len)> FrameAllocator;
+
+    // 将一次调用编码为完整的请求帧，追加到out中
+    // timeout_ms为调用方剩余的时间预算，随请求头发给服务端，0表示不限
+    // compress非空时按策略压缩请求体，调用方需确认对端支持该算法
+    // priority为调用方指定的优先级，PRIORITY_UNSET时由服务端按方法决定
+    static bool EncodeRequest(const std::string &service_name,
+                              const std::string &method_name,
+                              uint64_t request_id,
+                              const google::protobuf::Message &request,
+                              std::string *out,
+                              uint32_t timeout_ms = 0,
+                              const ZrpcCompressPolicy *compress = nullptr,
+                              Zrpc::RpcPriority priority = Zrpc::PRIORITY_UNSET);
+
+    // 将响应消息编码为完整的响应帧，追加到out中
+    static bool EncodeResponse(uint64_t request_id,
+                               const google::protobuf::Message &response,
+                               std::string *out,
+                               const ZrpcCompressPolicy *compress = nullptr);
+
+    // 同上，帧写入alloc分配的内存；alloc只调用一次，帧长此时已经确定
+    static bool EncodeRequest(const std::string &service_name,
+                              const std::string &method_name,
+                              uint64_t request_id,
+                              const google::protobuf::Message &request,
+                              const FrameAllocator &alloc,
+                              uint32_t timeout_ms = 0,
+                              const ZrpcCompressPolicy *compress = nullptr,
+                              Zrpc::RpcPriority priority = Zrpc::PRIORITY_UNSET);
+    static bool EncodeResponse(uint64_t request_id,
+                               const google::protobuf::Message &response,
+                               const FrameAllocator &alloc,
+                               const ZrpcCompressPolicy *compress = nullptr);
+
+    // 编码一个失败的响应帧（不带响应体），调用方据此得到失败原因而不是一直等待
+    static bool EncodeErrorResponse(uint64_t request_id,
+                                    Zrpc::RpcErrorCode error_code,
+                                    const std::string &error_text,
+                                    std::string *out);
+
+    // 把已编码好的多个请求帧（依次拼接在frames中）包装为一个批量请求帧，追加到out中
+    static bool EncodeBatchRequest(const std::string &frames, uint32_t count, std::string *out);
+    // 把多个响应帧包装为一个批量响应帧
+    static bool EncodeBatchResponse(const std::string &frames, uint32_t count, std::string *out);
+
+    // 尝试从data中解析出一个完整的请求帧，返回值含义同DecodeResponse，body长度为header->args_size()
+    static int DecodeRequest(const char *data, size_t len,
+                             Zrpc::RpcHeader *header,
+                             const char **body);
+
+    // 尝试从data中解析出一个完整的响应帧
+    // 返回值：>0 表示完整帧的总长度，0 表示数据还不完整，-1 表示报文格式错误
+    // 解析成功时body指向响应体的起始位置，长度为header->body_size()
+    static int DecodeResponse(const char *data, size_t len,
+                              Zrpc::RpcResponseHeader *header,
+                              const char **body);
+
+    // 反序列化消息体，compress_type为头部中的压缩算法，压缩过的消息体先解压
+    static bool ParseBody(Zrpc::CompressType compress_type, const char *body, size_t len,
+                          google::protobuf::Message *message);
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _ZrpcCodel_H
+#define _ZrpcCodel_H
+
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// 服务端按排队时间做准入控制（CoDel，Controlled Delay）
+// 排队时间指请求从收到到服务方法开始执行之间的时间。一个interval内所有请求排队时间的最小值都超过target，
+// 说明队列中积压的不是会很快消化的突发流量，而是持续的过载：此后排队超过target的请求直接以过载拒绝，调用方尽快失败或换实例，
+// 不再让所有请求一起排到超时；没有过载时只拒绝排队超过interval的请求，短时间的突发照常排队处理
+// 所有接口都是线程安全的
+class ZrpcCodel
+{
+public:
+    ZrpcCodel(int64_t target_us, int64_t interval_us);
+
+    // 一个请求开始执行前调用，delay_us为它的排队时间，now_us为当前时刻（微秒）；返回true表示应当拒绝这个请求
+    bool ShouldDrop(int64_t delay_us, int64_t now_us);
+    // 上一个interval是否处于过载状态
+    bool Overloaded() const { return m_overloaded.load(std::memory_order_relaxed); }
+
+    int64_t TargetUs() const { return m_target_us; }
+
+private:
+    ZrpcCodel(const ZrpcCodel &) = delete;
+    ZrpcCodel &operator=(const ZrpcCodel &) = delete;
+
+    const int64_t m_target_us;
+    const int64_t m_interval_us;
+
+    std::mutex m_mutex;
+    int64_t m_interval_end_us;  // 当前interval结束的时刻，0表示还没有开始
+    int64_t m_min_delay_us;     // 当前interval内的最小排队时间，没有请求时为INT64_MAX
+    std::atomic<bool> m_overloaded;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _ZrpcCompression_H
+#define _ZrpcCompression_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "Zrpcheader.pb.h"
+
+// 消息体压缩
+// 可用的算法取决于编译时找到的压缩库（ZRPC_HAVE_LZ4/ZRPC_HAVE_ZSTD/ZRPC_HAVE_SNAPPY），
+// 每个请求头和响应头都用accept_compress告诉对端本端能解压哪些算法，只向声明支持该算法的对端发送压缩过的消息体
+// 压缩后的格式：varint32(原始长度) + 压缩数据，解压前据此检查长度并一次分配好空间
+class ZrpcCompression
+{
+public:
+    // 本端支持的算法，按位表示（1 << CompressType）
+    static uint32_t SupportedMask();
+    static bool IsSupported(Zrpc::CompressType type);
+    static const char *Name(Zrpc::CompressType type);
+
+    // 压缩data，结果追加到out中；算法不支持或压缩失败时返回false
+    static bool Compress(Zrpc::CompressType type, const char *data, size_t len, std::string *out);
+    // 解压data，结果写入out（覆盖原有内容）；格式错误或原始长度超过上限时返回false
+    static bool Decompress(Zrpc::CompressType type, const char *data, size_t len, std::string *out);
+};
+
+// 按方法配置的压缩策略：消息体序列化后不小于min_bytes字节时压缩，压缩后没有变小则按原样发送
+// 小消息压缩的收益抵不过CPU开销，阈值应大于典型的小请求
+struct ZrpcCompressPolicy
+{
+    Zrpc::CompressType type = Zrpc::COMPRESS_NONE;
+    uint32_t min_bytes = 1024;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <queue>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
@@ -15,7 +16,8 @@
 // 连接对象
 class ZrpcConnection {
 public:
-    ZrpcConnection(const std::string& host, uint16_t port);
+    // unix_path非空时（服务端在同一主机上）优先通过Unix域套接字连接，失败时回退到TCP
+    ZrpcConnection(const std::string& host, uint16_t port, const std::string& unix_path = "");
     ~ZrpcConnection();
     
     // 连接操作
@@ -24,14 +26,21 @@ public:
     bool IsValid() const;
     bool IsExpired() const;
     
-    // 数据发送接收
-    bool Send(const char* data, size_t len);
-    bool Receive(char* buffer, size_t len);
+    // 数据发送接收（阻塞，直到发送/接收完len个字节、出错或超时）
+    // timeout_ms < 0表示不限时间；超时时关闭连接（帧可能只发/收了一半），返回false并把errno设为ETIMEDOUT
+    bool Send(const char* data, size_t len, int timeout_ms = -1);
+    bool Receive(char* buffer, size_t len, int timeout_ms = -1);
+    // 等待连接可读，超时返回false并把errno设为ETIMEDOUT
+    bool WaitReadable(int timeout_ms);
     
     // 获取连接信息
     int GetSocket() const { return m_socket; }
     const std::string& GetHost() const { return m_host; }
     uint16_t GetPort() const { return m_port; }
+
+    // 对端能解压的算法（1 << CompressType），每次收到响应后更新；为0时请求不压缩
+    uint32_t GetPeerCompressMask() const { return m_peer_compress_mask; }
+    void SetPeerCompressMask(uint32_t mask) { m_peer_compress_mask = mask; }
     
     // 连接状态管理
     void UpdateLastUsed();
@@ -40,15 +49,19 @@ public:
 private:
     std::string m_host;
     uint16_t m_port;
+    std::string m_unix_path;
     int m_socket;
     std::atomic<bool> m_connected;
     std::chrono::steady_clock::time_point m_last_used;
     std::chrono::steady_clock::time_point m_created_time;
+    uint32_t m_peer_compress_mask;  // 连接同一时刻只被一个调用借用，不需要同步
     
     // 连接超时设置（30分钟）
-    static const int CONNECTION_TIMEOUT_SECONDS = 1800;
+    static constexpr int CONNECTION_TIMEOUT_SECONDS = 1800;
     
     bool ConnectInternal(int timeout_ms);
+    int ConnectTcp(int timeout_ms);
+    bool WaitReady(short events, std::chrono::steady_clock::time_point deadline, bool has_deadline);
 };
 
 // 连接池配置
@@ -72,9 +85,15 @@ public:
     bool Initialize(const ConnectionPoolConfig& config = ConnectionPoolConfig());
     void Shutdown();
     
-    // 获取和归还连接
-    std::shared_ptr<ZrpcConnection> GetConnection(const std::string& host, uint16_t port);
+    // 获取和归还连接；timeout_ms >= 0时等待空闲连接和建立连接的时间都不超过它（调用剩余的时间预算）
+    // unix_path为服务发现给出的同一主机上实例的Unix域套接字路径，之后为该服务端新建的连接都优先使用它
+    std::shared_ptr<ZrpcConnection> GetConnection(const std::string& host, uint16_t port, int timeout_ms = -1,
+                                                  const std::string& unix_path = "");
     void ReturnConnection(std::shared_ptr<ZrpcConnection> conn);
+
+    // 预建到指定服务端的连接，使池中至少有count个连接（不超过max_connections），每个连接的建立时间不超过timeout_ms
+    // 返回池中到该服务端的连接数；超过min_connections的部分长时间空闲后照常回收
+    size_t Prewarm(const std::string& host, uint16_t port, size_t count, int timeout_ms, const std::string& unix_path = "");
     
     // 连接池状态
     size_t GetTotalConnections(const std::string& endpoint);
@@ -96,12 +115,16 @@ public:
     
 private:
     ZrpcConnectionPool() = default;
-    ~ZrpcConnectionPool() = default;
+    ~ZrpcConnectionPool();
     ZrpcConnectionPool(const ZrpcConnectionPool&) = delete;
     ZrpcConnectionPool& operator=(const ZrpcConnectionPool&) = delete;
     
     // 连接池管理
     struct EndpointPool {
+        std::string host;
+        uint16_t port = 0;
+        std::string unix_path;  // 非空时新建的连接优先走Unix域套接字
+        bool warmed = false;  // 是否已经预建过initial_connections个连接
         std::queue<std::shared_ptr<ZrpcConnection>> idle_connections;
         std::unordered_map<ZrpcConnection*, std::shared_ptr<ZrpcConnection>> active_connections;
         size_t total_connections = 0;
@@ -122,6 +145,9 @@ private:
     ConnectionPoolConfig m_config;
     std::atomic<bool> m_shutdown{false};
     std::atomic<bool> m_initialized{false};
+    std::mutex m_init_mutex;          // 串行化Initialize/Shutdown
+    std::mutex m_loop_mutex;          // 配合m_loop_cv，让后台线程能被Shutdown及时唤醒
+    std::condition_variable m_loop_cv;
     
     // 后台清理线程
     std::thread m_cleanup_thread;
@@ -130,18 +156,23 @@ private:
     // 内部方法
     std::string MakeEndpoint(const std::string& host, uint16_t port);
     EndpointPool* GetOrCreatePool(const std::string& endpoint);
-    std::shared_ptr<ZrpcConnection> CreateConnection(const std::string& host, uint16_t port);
+    std::shared_ptr<ZrpcConnection> CreateConnection(const std::string& host, uint16_t port, int timeout_ms,
+                                                     const std::string& unix_path);
+    void SetUnixPath(EndpointPool* pool, const std::string& unix_path);
     void CleanupIdleConnections();
     void HeartbeatCheck();
     void RunCleanupLoop();
     void RunHeartbeatLoop();
     bool IsConnectionValid(std::shared_ptr<ZrpcConnection> conn);
+    void DestroyConnection(EndpointPool* pool, std::shared_ptr<ZrpcConnection> conn);  // 调用方需持有pool->mutex
+    void FillPool(EndpointPool* pool, size_t target, int timeout_ms);  // 补足空闲连接到target个
+    bool WaitFor(int seconds);  // 等待指定时间，Shutdown时提前返回false
 };
 
 // RAII连接管理器
 class ZrpcConnectionGuard {
 public:
-    ZrpcConnectionGuard(const std::string& host, uint16_t port);
+    ZrpcConnectionGuard(const std::string& host, uint16_t port, int timeout_ms = -1, const std::string& unix_path = "");
     ~ZrpcConnectionGuard();
     
     std::shared_ptr<ZrpcConnection> GetConnection();
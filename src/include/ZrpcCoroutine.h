@@ -0,0 +1,277 @@
+#ifndef _ZrpcCoroutine_H
+#define _ZrpcCoroutine_H
+
+// C++20协程客户端接口
+// 只有以C++20编译（cmake -DZRPC_ENABLE_COROUTINE=ON）时才可用，此时定义ZRPC_HAS_COROUTINE
+//
+// 用法：
+//   ZrpcTask<std::string> GetValue(Kuser::CacheServiceRpc_Stub &cache, std::string key) {
+//       Kuser::CacheGetRequest req;
+//       req.set_key(key);
+//       Zrpccontroller ctl;
+//       Kuser::CacheGetResponse resp = co_await ZrpcCall(cache, &Kuser::CacheServiceRpc_Stub::Get, &ctl, req);
+//       co_return ctl.Failed() ? "" : resp.value();
+//   }
+//
+// co_await ZrpcCall 以异步方式发起调用（done非空），不占用线程；响应到达后协程在客户端reactor线程上恢复执行。
+// 因此协程中不要发起同步RPC或做其他阻塞操作，否则会阻塞reactor上的所有连接。
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#define ZRPC_HAS_COROUTINE 1
+
+#include "ZrpcClientReactor.h"
+#include "ZrpcLogger.h"
+#include <google/protobuf/service.h>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+// 协程调度器：让协程在客户端reactor线程上恢复执行
+class ZrpcReactorScheduler
+{
+public:
+    // 在reactor线程上恢复协程，已在reactor线程上时直接恢复
+    static void Resume(std::coroutine_handle<> handle) {
+        ZrpcClientReactor &reactor = ZrpcClientReactor::GetInstance();
+        if (reactor.IsInLoopThread()) {
+            handle.resume();
+        } else {
+            reactor.RunInLoop([handle] { handle.resume(); });
+        }
+    }
+
+    // co_await ZrpcReactorScheduler::Schedule() 把当前协程切换到reactor线程上继续执行
+    struct ScheduleAwaiter
+    {
+        bool await_ready() const noexcept { return ZrpcClientReactor::GetInstance().IsInLoopThread(); }
+        void await_suspend(std::coroutine_handle<> handle) {
+            ZrpcClientReactor::GetInstance().RunInLoop([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    static ScheduleAwaiter Schedule() { return ScheduleAwaiter(); }
+};
+
+template <typename T = void>
+class ZrpcTask;
+
+// 协程任务的promise公共部分：惰性启动，结束时通过对称转移恢复等待它的协程
+class ZrpcTaskPromiseBase
+{
+public:
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().m_continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { m_exception = std::current_exception(); }
+
+    std::coroutine_handle<> m_continuation;  // 等待该任务完成的协程
+    std::exception_ptr m_exception;
+};
+
+template <typename T>
+class ZrpcTaskPromise : public ZrpcTaskPromiseBase
+{
+public:
+    ZrpcTask<T> get_return_object();
+    void return_value(T value) { m_value.emplace(std::move(value)); }
+    T Result() {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+};
+
+template <>
+class ZrpcTaskPromise<void> : public ZrpcTaskPromiseBase
+{
+public:
+    ZrpcTask<void> get_return_object();
+    void return_void() {}
+    void Result() {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+    }
+};
+
+// 协程任务：co_await 时才开始执行，完成后恢复等待方；只能被等待一次
+template <typename T>
+class ZrpcTask
+{
+public:
+    typedef ZrpcTaskPromise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    explicit ZrpcTask(Handle handle) : m_handle(handle) {}
+    ZrpcTask(ZrpcTask &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    ZrpcTask &operator=(ZrpcTask &&other) noexcept {
+        if (this != &other) {
+            if (m_handle) {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ZrpcTask(const ZrpcTask &) = delete;
+    ZrpcTask &operator=(const ZrpcTask &) = delete;
+    ~ZrpcTask() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    struct Awaiter
+    {
+        Handle handle;
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+            handle.promise().m_continuation = continuation;
+            return handle;  // 对称转移，开始执行任务
+        }
+        T await_resume() { return handle.promise().Result(); }
+    };
+    Awaiter operator co_await() && noexcept { return Awaiter{m_handle}; }
+
+private:
+    Handle m_handle;
+};
+
+template <typename T>
+inline ZrpcTask<T> ZrpcTaskPromise<T>::get_return_object() {
+    return ZrpcTask<T>(std::coroutine_handle<ZrpcTaskPromise<T>>::from_promise(*this));
+}
+
+inline ZrpcTask<void> ZrpcTaskPromise<void>::get_return_object() {
+    return ZrpcTask<void>(std::coroutine_handle<ZrpcTaskPromise<void>>::from_promise(*this));
+}
+
+// 异步RPC调用的awaiter，由ZrpcCall创建
+// 请求和控制器必须在co_await期间保持有效，响应作为co_await表达式的结果返回；调用是否成功由控制器判断
+template <typename Stub, typename Class, typename Request, typename Response>
+class ZrpcCallAwaiter
+{
+public:
+    typedef void (Class::*Method)(google::protobuf::RpcController *, const Request *, Response *, google::protobuf::Closure *);
+
+    ZrpcCallAwaiter(Stub &stub, Method method, google::protobuf::RpcController *controller, const Request &request)
+        : m_stub(stub), m_method(method), m_controller(controller), m_request(request) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // done非空，channel走异步路径立即返回；done通常在reactor线程上执行，此时直接恢复协程，
+        // 调用在发出前就失败时done会在当前线程执行，由调度器转到reactor线程上恢复
+        (m_stub.*m_method)(m_controller, &m_request, &m_response,
+                           google::protobuf::NewCallback(&ZrpcCallAwaiter::OnDone, handle));
+    }
+
+    Response await_resume() { return std::move(m_response); }
+
+private:
+    static void OnDone(std::coroutine_handle<> handle) {
+        ZrpcReactorScheduler::Resume(handle);
+    }
+
+    Stub &m_stub;
+    Method m_method;
+    google::protobuf::RpcController *m_controller;
+    const Request &m_request;
+    Response m_response;
+};
+
+// 以协程方式调用生成的stub方法：
+//   auto resp = co_await ZrpcCall(stub, &Kuser::CacheServiceRpc_Stub::Get, &controller, request);
+template <typename Stub, typename Class, typename Request, typename Response>
+ZrpcCallAwaiter<Stub, Class, Request, Response>
+ZrpcCall(Stub &stub,
+         void (Class::*method)(google::protobuf::RpcController *, const Request *, Response *, google::protobuf::Closure *),
+         google::protobuf::RpcController *controller, const Request &request) {
+    static_assert(std::is_base_of<Class, Stub>::value, "method must belong to the stub");
+    return ZrpcCallAwaiter<Stub, Class, Request, Response>(stub, method, controller, request);
+}
+
+// 不被等待的协程，执行结束后自动销毁
+struct ZrpcDetachedTask
+{
+    struct promise_type
+    {
+        ZrpcDetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// 启动一个独立运行的协程任务，调用方不等待其结果
+inline ZrpcDetachedTask ZrpcSpawn(ZrpcTask<void> task) {
+    try {
+        co_await std::move(task);
+    } catch (const std::exception &e) {
+        LOG(ERROR) << "spawned coroutine failed: " << e.what();
+    }
+}
+
+// 在普通线程中阻塞等待协程任务完成并取得结果，用于把协程接入同步代码（例如main函数）
+// 不要在reactor线程（即协程或done回调）中调用，否则会死锁
+template <typename T>
+T ZrpcSyncWait(ZrpcTask<T> task) {
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        std::exception_ptr exception;
+        std::conditional_t<std::is_void<T>::value, bool, std::optional<T>> value;
+    } state;
+
+    // 参数按值进入协程帧，不捕获任何局部变量
+    auto runner = [](ZrpcTask<T> inner, State *s) -> ZrpcDetachedTask {
+        try {
+            if constexpr (std::is_void<T>::value) {
+                co_await std::move(inner);
+            } else {
+                s->value.emplace(co_await std::move(inner));
+            }
+        } catch (...) {
+            s->exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->finished = true;
+        s->cv.notify_all();
+    };
+    runner(std::move(task), &state);
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&state] { return state.finished; });
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+    if constexpr (!std::is_void<T>::value) {
+        return std::move(*state.value);
+    }
+}
+
+#endif  // __cpp_impl_coroutine
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef _ZrpcCpuSet_H
+#define _ZrpcCpuSet_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// 线程绑核使用的CPU列表，格式与taskset相同（如"0-15,32-47"）
+// 一组线程（IO线程或业务线程）共用一个列表，各线程启动时按顺序轮流绑定到列表中的下一个CPU
+class ZrpcCpuSet
+{
+public:
+    ZrpcCpuSet() : m_next(0) {}
+
+    // 解析CPU列表，格式错误时返回false并保持为空（不绑核）
+    bool Parse(const std::string &spec);
+    bool Empty() const { return m_cpus.empty(); }
+    size_t Size() const { return m_cpus.size(); }
+
+    // 把当前线程绑定到列表中的下一个CPU，列表为空时什么也不做；可以在多个线程上同时调用
+    void PinCurrentThread();
+
+private:
+    ZrpcCpuSet(const ZrpcCpuSet &) = delete;
+    ZrpcCpuSet &operator=(const ZrpcCpuSet &) = delete;
+
+    std::vector<int> m_cpus;
+    std::atomic<size_t> m_next;
+};
+
+#endif
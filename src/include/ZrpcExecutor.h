@@ -0,0 +1,79 @@
+#ifndef _ZrpcExecutor_H
+#define _ZrpcExecutor_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// 服务端的业务线程池：IO线程收到请求并反序列化后，服务方法交给这里的工作线程执行
+// 服务方法阻塞（sleep、同步发起的嵌套调用）时只占住一个工作线程，IO线程上其他连接的收发不受影响
+// 任务按类别（服务端用作优先级）放在各自的队列中，空闲的工作线程按权重加权公平地从各队列取任务：
+// 各类别都有积压时取到的任务数与权重成正比，低权重的后台任务再多也只占自己的份额，不会推高高权重任务的排队时间；
+// 只有一个类别时就是普通的队列
+// 每个队列平时先进先出，过载时可以切换为后进先出（adaptive LIFO）：
+// 积压时先处理刚到的请求，它们的调用方大多还在等待，排在前面的旧请求留到之后按排队时间拒绝
+// Submit可以在任意线程上调用
+class ZrpcExecutor
+{
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void()> ThreadInitCallback;
+
+    // weights为各类别的权重（至少1），类别数等于weights的长度
+    explicit ZrpcExecutor(int num_threads, const std::vector<uint32_t> &weights = std::vector<uint32_t>(1, 1));
+    ~ZrpcExecutor();  // 执行完已提交的任务后退出
+
+    // 每个工作线程开始执行任务前先在该线程上调用cb（如绑核），在Start之前设置
+    void SetThreadInitCallback(const ThreadInitCallback &cb) { m_thread_init_callback = cb; }
+    void Start();
+    void Stop();
+
+    // 把任务提交到类别cls的队列，超出范围的类别归入最后一个；已经停止时在当前线程上直接执行
+    void Submit(Task task, int cls = 0);
+
+    // 切换类别cls的队列为后进先出/先进先出，之后取出的任务按新的顺序
+    void SetLifo(int cls, bool lifo);
+
+    int ThreadNum() const { return m_num_threads; }
+    int ClassNum() const { return static_cast<int>(m_queues.size()); }
+    size_t QueueSize();
+
+private:
+    ZrpcExecutor(const ZrpcExecutor &) = delete;
+    ZrpcExecutor &operator=(const ZrpcExecutor &) = delete;
+
+    // 一个类别的队列；按步长调度（stride scheduling）：每取出一个任务pass增加stride（与权重成反比），
+    // 总是从pass最小的非空队列取任务
+    struct TaskQueue
+    {
+        std::deque<Task> tasks;
+        uint64_t stride = 0;
+        uint64_t pass = 0;
+        std::atomic<bool> lifo{false};
+    };
+
+    void WorkerLoop();
+    bool PopTask(Task *task);  // 调用方需持有m_mutex
+
+    static constexpr uint64_t kStrideBase = 1 << 20;
+
+    int m_num_threads;
+    ThreadInitCallback m_thread_init_callback;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<std::unique_ptr<TaskQueue>> m_queues;
+    size_t m_size;            // 所有队列中的任务总数
+    uint64_t m_virtual_time;  // 最近取出任务的队列的pass，空闲后重新有任务的队列从这里开始，不能攒下空闲期间的份额
+    bool m_running;
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef _ZrpcFuture_H
+#define _ZrpcFuture_H
+
+#include <google/protobuf/service.h>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+// 异步调用的结果
+// 与std::future不同，ZrpcFuture可以注册完成回调，因此能组合出WhenAll/WhenAny而不必为每个调用占用一个等待线程。
+// 回调在设置结果的线程上执行（对RPC来说是客户端reactor线程），回调中不要做阻塞操作；
+// 同理，不要在reactor线程（done回调、Then回调、协程）中调用Get/Wait，否则会死锁。
+
+template <typename T>
+class ZrpcFutureState
+{
+public:
+    typedef std::function<void(const T &)> Callback;
+
+    // 只有第一次设置生效，之后的调用被忽略
+    void SetValue(T value) {
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_ready) {
+                return;
+            }
+            m_value = std::move(value);
+            m_ready = true;
+            callbacks.swap(m_callbacks);
+        }
+        m_cv.notify_all();
+        for (Callback &cb : callbacks) {
+            cb(m_value);  // 结果设置后不再修改，可以不加锁读取
+        }
+    }
+
+    // 已完成时在当前线程立即执行，否则在设置结果的线程上执行
+    void OnReady(Callback cb) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_ready) {
+                m_callbacks.push_back(std::move(cb));
+                return;
+            }
+        }
+        cb(m_value);
+    }
+
+    const T &Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_ready; });
+        return m_value;
+    }
+
+    bool WaitFor(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return m_ready; });
+    }
+
+    bool IsReady() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ready;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_ready = false;
+    T m_value{};
+    std::vector<Callback> m_callbacks;
+};
+
+template <typename T>
+class ZrpcFuture
+{
+public:
+    ZrpcFuture() = default;
+    explicit ZrpcFuture(std::shared_ptr<ZrpcFutureState<T>> state) : m_state(std::move(state)) {}
+
+    bool Valid() const { return m_state != nullptr; }
+    bool IsReady() const { return m_state->IsReady(); }
+
+    // 阻塞等待结果
+    const T &Get() const { return m_state->Wait(); }
+    // 等待指定时间，超时返回false
+    bool WaitFor(int timeout_ms) const { return m_state->WaitFor(timeout_ms); }
+    // 注册完成回调
+    void Then(std::function<void(const T &)> cb) const { m_state->OnReady(std::move(cb)); }
+
+private:
+    std::shared_ptr<ZrpcFutureState<T>> m_state;
+};
+
+template <typename T>
+class ZrpcPromise
+{
+public:
+    ZrpcPromise() : m_state(std::make_shared<ZrpcFutureState<T>>()) {}
+
+    ZrpcFuture<T> GetFuture() const { return ZrpcFuture<T>(m_state); }
+    void SetValue(T value) const { m_state->SetValue(std::move(value)); }
+
+private:
+    std::shared_ptr<ZrpcFutureState<T>> m_state;
+};
+
+// 所有future都完成后完成，结果按输入顺序排列
+template <typename T>
+ZrpcFuture<std::vector<T>> WhenAll(const std::vector<ZrpcFuture<T>> &futures) {
+    struct Context
+    {
+        ZrpcPromise<std::vector<T>> promise;
+        std::vector<std::unique_ptr<T>> results;  // 每个结果单独存放，避免并发写入相邻元素（如vector<bool>）
+        std::atomic<size_t> remaining{0};
+    };
+
+    auto context = std::make_shared<Context>();
+    ZrpcFuture<std::vector<T>> result = context->promise.GetFuture();
+    if (futures.empty()) {
+        context->promise.SetValue(std::vector<T>());
+        return result;
+    }
+
+    context->results.resize(futures.size());
+    context->remaining = futures.size();
+    for (size_t i = 0; i < futures.size(); ++i) {
+        futures[i].Then([context, i](const T &value) {
+            context->results[i].reset(new T(value));
+            if (context->remaining.fetch_sub(1) == 1) {  // 最后一个完成的负责汇总
+                std::vector<T> values;
+                values.reserve(context->results.size());
+                for (auto &item : context->results) {
+                    values.push_back(std::move(*item));
+                }
+                context->promise.SetValue(std::move(values));
+            }
+        });
+    }
+    return result;
+}
+
+// 任意一个future完成后完成，结果为最先完成的future的下标；输入为空时立即完成，结果为0（调用方应检查下标是否小于输入个数）
+// 注意：其余调用仍在进行，它们的请求、响应和控制器要保持有效直到各自完成
+template <typename T>
+ZrpcFuture<size_t> WhenAny(const std::vector<ZrpcFuture<T>> &futures) {
+    ZrpcPromise<size_t> promise;
+    ZrpcFuture<size_t> result = promise.GetFuture();
+    if (futures.empty()) {
+        promise.SetValue(0);
+        return result;
+    }
+    for (size_t i = 0; i < futures.size(); ++i) {
+        futures[i].Then([promise, i](const T &) { promise.SetValue(i); });  // 只有第一次设置生效
+    }
+    return result;
+}
+
+// RPC完成时（done回调中）设置future的结果
+inline void ZrpcCompletePromise(ZrpcPromise<bool> promise, google::protobuf::RpcController *controller) {
+    promise.SetValue(controller == nullptr || !controller->Failed());
+}
+
+// 以future方式调用生成的stub方法，结果表示调用是否成功（失败原因见controller）：
+//   ZrpcFuture<bool> f = ZrpcCallAsync(stub, &Kuser::UserServiceRpc_Stub::Login, &controller, &request, &response);
+// 请求、响应和控制器必须保持有效直到future完成
+template <typename Stub, typename Class, typename Request, typename Response>
+ZrpcFuture<bool> ZrpcCallAsync(Stub &stub,
+                               void (Class::*method)(google::protobuf::RpcController *, const Request *, Response *, google::protobuf::Closure *),
+                               google::protobuf::RpcController *controller, const Request *request, Response *response) {
+    static_assert(std::is_base_of<Class, Stub>::value, "method must belong to the stub");
+    ZrpcPromise<bool> promise;
+    ZrpcFuture<bool> future = promise.GetFuture();
+    (stub.*method)(controller, request, response, google::protobuf::NewCallback(&ZrpcCompletePromise, promise, controller));
+    return future;
+}
+
+#endif
@@ -72,7 +72,7 @@ private:
     std::atomic<bool> m_stop_requested;
     
     // 心跳检测间隔（秒）
-    static const int HEARTBEAT_INTERVAL = 5;
+    static constexpr int HEARTBEAT_INTERVAL = 5;
     
     // 自定义心跳检测回调
     std::function<bool(const std::string&, const std::string&, uint16_t)> m_heartbeat_callback;
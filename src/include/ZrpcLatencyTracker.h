@@ -0,0 +1,31 @@
+#ifndef _ZrpcLatencyTracker_H
+#define _ZrpcLatencyTracker_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// 记录最近一段时间的调用延迟，用于计算延迟的百分位数（例如对冲请求的触发时间）
+// 只保留最近kCapacity个样本，旧样本被覆盖，因此百分位数能跟随服务端延迟的变化
+class ZrpcLatencyTracker
+{
+public:
+    ZrpcLatencyTracker();
+
+    void Record(int64_t latency_us);
+
+    // 最近样本延迟的百分位数（微秒），percentile取值(0,1]；样本不足kMinSamples时返回-1
+    int64_t Percentile(double percentile);
+
+    static constexpr size_t kCapacity = 256;
+    static constexpr size_t kMinSamples = 20;  // 样本太少时百分位数不可靠
+
+private:
+    std::mutex m_mutex;
+    std::vector<int64_t> m_samples;  // 环形缓冲区
+    size_t m_next;                   // 下一个写入位置
+    std::vector<int64_t> m_scratch;  // 计算百分位数时使用，避免每次分配
+};
+
+#endif
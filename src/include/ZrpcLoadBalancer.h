@@ -0,0 +1,155 @@
+#ifndef _ZrpcLoadBalancer_H
+#define _ZrpcLoadBalancer_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "Zrpcheader.pb.h"
+
+// 单个服务实例的调用统计，同一地址在进程内共享一份，供负载均衡策略和过载保护使用
+//
+// 过载保护包括两部分，只对开启了过载保护的调用生效（TryStart），统计则来自所有调用：
+// 1. 自适应并发限制（梯度算法）：按采样窗口统计平均延迟，以最小的窗口延迟作为无排队时的基线，每个窗口结束时按
+//    gradient = 1.5 * 基线 / 窗口平均延迟（限制在[0.5, 1]）调整上限：new_limit = limit * gradient + sqrt(limit)。
+//    延迟明显高于基线说明请求在实例上排队，上限随之降低；延迟正常时上限缓慢增长；窗口内有调用失败时按比例降低。
+//    实例可能确实变慢，基线每隔几分钟重新测量一次：上限临时减半两个窗口，排队的请求消化后取第二个窗口的延迟作为新基线
+// 2. 熔断器：一个统计窗口内失败率过高时打开，打开期间直接拒绝；到期后放行一个探测请求，成功则关闭，失败则加倍打开时间
+class ZrpcEndpointStats
+{
+public:
+    // 开启过载保护的调用的准入结果
+    enum Admission
+    {
+        ADMITTED,      // 放行，在途请求数已加一
+        LIMITED,       // 在途请求数已达到并发上限
+        CIRCUIT_OPEN,  // 熔断器打开
+    };
+
+    // 获取指定地址（ip:port）的统计对象，不存在时创建
+    static std::shared_ptr<ZrpcEndpointStats> ForAddress(const std::string &address);
+
+    // 调用开始/结束时更新统计；开启过载保护的调用用TryStart代替OnCallStart，被拒绝时不需要调用OnCallFinish
+    void OnCallStart();
+    Admission TryStart();
+    void OnCallFinish(int64_t latency_us, Zrpc::RpcErrorCode code);
+    // 调用被放弃（例如对冲请求中落后的一个），只减少在途请求数，不计入延迟
+    void OnCallCanceled();
+
+    int Outstanding() const { return m_outstanding.load(std::memory_order_relaxed); }
+    int64_t EwmaLatencyUs() const { return m_ewma_latency_us.load(std::memory_order_relaxed); }
+    int ConcurrencyLimit() const { return m_limit.load(std::memory_order_relaxed); }
+    // 熔断器打开且还没到探测时间，负载均衡据此避开该实例
+    bool IsCircuitOpen() const;
+
+    // 实例本身出了问题的失败（超时、连接失败、服务端内部错误、过载）；参数错误、方法不存在等不算
+    static bool IsEndpointFailure(Zrpc::RpcErrorCode code);
+
+private:
+    enum CircuitState
+    {
+        CLOSED,
+        OPEN,
+        HALF_OPEN,  // 打开时间已到，只放行一个探测请求
+    };
+
+    void UpdateLimit(int64_t latency_us, bool failed, std::chrono::steady_clock::time_point now);
+    void UpdateCircuit(bool failed, std::chrono::steady_clock::time_point now);
+
+    std::atomic<int> m_outstanding{0};          // 正在进行中的请求数
+    std::atomic<int64_t> m_ewma_latency_us{0};  // 延迟的指数加权移动平均（微秒），0表示还没有样本
+    std::atomic<int> m_limit{kInitialLimit};    // 当前的并发上限
+
+    mutable std::mutex m_mutex;  // 保护以下并发限制和熔断器的状态
+    double m_limit_value = kInitialLimit;
+    int64_t m_min_rtt_us = 0;      // 无排队时的延迟基线，0表示还没有样本
+    int m_period_windows = 0;      // 距上次重新测量基线的窗口数
+    int m_probe_windows = 0;       // 正在重新测量基线时剩余的窗口数
+    double m_probe_saved_limit = 0;
+    std::chrono::steady_clock::time_point m_sample_start;  // 当前采样窗口
+    int64_t m_sample_rtt_sum = 0;
+    int m_sample_count = 0;
+    int m_sample_max_inflight = 0;
+    bool m_sample_failed = false;
+    CircuitState m_circuit = CLOSED;
+    bool m_probe_inflight = false;
+    std::chrono::steady_clock::time_point m_window_start;
+    int m_window_requests = 0;
+    int m_window_failures = 0;
+    std::chrono::steady_clock::time_point m_open_until;
+    int m_open_ms = kMinOpenMs;   // 下次打开的持续时间，连续打开时加倍
+
+    static constexpr double kEwmaAlpha = 0.2;  // 新样本的权重
+
+    static constexpr int kInitialLimit = 20;
+    static constexpr int kMinLimit = 1;
+    static constexpr int kMaxLimit = 1000;
+    static constexpr double kBackoffRatio = 0.9;    // 窗口内有调用失败时并发上限乘以该系数
+    static constexpr int kSampleWindowMs = 500;     // 采样窗口的最短时长
+    static constexpr int kMinSampleCount = 10;      // 采样窗口的最少样本数
+    static constexpr int kMinRttPeriodWindows = 300;  // 每隔多少个窗口重新测量基线（约2.5分钟）
+    static constexpr double kRttTolerance = 1.5;    // 延迟不超过基线的该倍数时不降低上限
+    static constexpr double kLimitSmoothing = 0.2;  // 每个窗口对上限的调整只生效该比例，避免抖动
+
+    static constexpr int kWindowMs = 10000;        // 熔断器的统计窗口
+    static constexpr int kMinWindowRequests = 20;  // 窗口内请求太少时不做判断
+    static constexpr int kFailurePercent = 50;     // 失败率达到该百分比时打开
+    static constexpr int kMinOpenMs = 1000;
+    static constexpr int kMaxOpenMs = 30000;
+};
+
+// 服务实例
+struct ZrpcEndpoint
+{
+    std::string ip;
+    uint16_t port = 0;
+    int weight = 100;  // 权重，用于加权负载均衡
+    uint64_t address_hash = 0;  // 地址的哈希值，按key路由时使用
+    std::string unix_path;  // 实例与本进程在同一主机上时为它的Unix域套接字路径，非空时优先用它连接
+    std::string shm_path;   // 实例在同一主机上且提供共享内存传输时为握手路径，开启了共享内存的channel优先使用
+    std::shared_ptr<ZrpcEndpointStats> stats;
+
+    std::string Address() const { return ip + ":" + std::to_string(port); }
+};
+
+typedef std::vector<ZrpcEndpoint> ZrpcEndpointList;
+
+// 客户端负载均衡：从服务发现得到的实例列表中为每次调用选出一个实例
+class ZrpcLoadBalancer
+{
+public:
+    enum Policy
+    {
+        ROUND_ROBIN,        // 轮询
+        WEIGHTED,           // 按权重随机
+        POWER_OF_TWO,       // 随机选两个，取正在进行中请求数较少的一个
+        LEAST_LATENCY,      // 选延迟EWMA（按在途请求数放大）最小的实例，没有样本的实例优先探测
+    };
+
+    explicit ZrpcLoadBalancer(Policy policy = ROUND_ROBIN);
+
+    void SetPolicy(Policy policy) { m_policy = policy; }
+    Policy GetPolicy() const { return m_policy; }
+
+    // 选出一个实例，列表为空时返回nullptr
+    const ZrpcEndpoint *Select(const ZrpcEndpointList &endpoints);
+
+    // 按key选出一个实例（带权重的rendezvous哈希），与策略无关：
+    // 相同key总是落在同一个实例上；实例增减时只有落在该实例上的key会迁移
+    static const ZrpcEndpoint *SelectByKey(const ZrpcEndpointList &endpoints, const std::string &key);
+
+    static uint64_t Hash(const char *data, size_t len);
+
+private:
+    const ZrpcEndpoint *SelectWeighted(const ZrpcEndpointList &endpoints);
+    const ZrpcEndpoint *SelectPowerOfTwo(const ZrpcEndpointList &endpoints);
+    const ZrpcEndpoint *SelectLeastLatency(const ZrpcEndpointList &endpoints);
+
+    std::atomic<Policy> m_policy;
+    std::atomic<uint64_t> m_counter;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef _ZrpcMuxConnection_H
+#define _ZrpcMuxConnection_H
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include "ZrpcBuffer.h"
+#include "ZrpcTimerWheel.h"
+#include "Zrpcheader.pb.h"
+
+// 批量发送的策略：同一连接上排队的小请求攒够max_calls个或max_bytes字节时立即发送，
+// 否则最多等待max_delay_us微秒（不足1毫秒时在reactor本轮事件处理之后发送，把同一时刻产生的请求合并在一起）
+struct ZrpcBatchPolicy
+{
+    size_t max_calls = 32;
+    size_t max_bytes = 64 * 1024;
+    int max_delay_us = 200;
+};
+
+// 多路复用连接：同一条TCP连接上可以同时存在多个未完成的请求
+// 连接的读写由共享的ZrpcClientReactor驱动，响应按request_id分发给对应的调用方
+// 每个调用的超时登记在reactor的时间轮上，到期时以RPC_DEADLINE_EXCEEDED失败，收到响应时取消
+class ZrpcMuxConnection : public std::enable_shared_from_this<ZrpcMuxConnection>
+{
+public:
+    // 调用完成回调：code为RPC_OK表示成功，否则errtxt为失败原因
+    // （超时为RPC_DEADLINE_EXCEEDED，连接失败为RPC_UNAVAILABLE，其余为服务端返回的错误码）
+    // body指向连接的接收缓冲区，只在回调执行期间有效，调用方应在回调内完成反序列化
+    typedef std::function<void(Zrpc::RpcErrorCode code, const char *body, size_t len, const std::string &errtxt)> Completion;
+
+    // 获取到指定服务端的共享连接，同一endpoint在进程内只保留一条，连接断开后自动重建
+    // unix_path非空时（服务端在同一主机上）优先通过Unix域套接字连接，失败时回退到TCP
+    static std::shared_ptr<ZrpcMuxConnection> GetConnection(const std::string &ip, uint16_t port, int timeout_ms,
+                                                            const std::string &unix_path = "");
+
+    ZrpcMuxConnection(int fd, const std::string &endpoint);
+    virtual ~ZrpcMuxConnection();
+
+    // 分配连接内唯一的请求序号
+    uint64_t NextRequestId();
+
+    // 异步发送已编码好的请求帧，立即返回
+    // 响应到达、超时或连接断开时在reactor线程上执行done；若连接已关闭，done在当前线程立即执行
+    // batch非空时请求先进入连接的批量缓冲区，按策略与其他请求合并为一个批量帧发送
+    void CallAsync(uint64_t request_id, const std::string &frame, int timeout_ms, Completion done,
+                   const ZrpcBatchPolicy *batch = nullptr);
+
+    // 同步调用：发送请求帧并阻塞等待request_id对应的响应体，返回值含义同Completion的code
+    Zrpc::RpcErrorCode Call(uint64_t request_id, const std::string &frame, int timeout_ms,
+                            std::string *body, std::string *errtxt, const ZrpcBatchPolicy *batch = nullptr);
+
+    // 放弃一个未完成的调用：不再执行它的done，之后到达的响应被丢弃（服务端仍会处理该请求）
+    bool Cancel(uint64_t request_id);
+
+    bool IsClosed() const;
+    int GetFd() const { return m_fd; }
+
+    // 对端能解压的算法（1 << CompressType），由最近一次收到的响应头给出；收到第一个响应之前为0，请求不压缩
+    uint32_t PeerCompressMask() const { return m_peer_compress_mask.load(std::memory_order_relaxed); }
+
+    // 以下接口由ZrpcClientReactor在reactor线程中调用
+    virtual void HandleRead();
+    virtual void HandleWrite();
+    // io_uring引擎：多发接收收到的数据直接交给连接解析，data只在调用期间有效
+    void HandleData(const char *data, size_t len);
+    // io_uring引擎：取出输出缓冲区中待发送的全部数据交给reactor发送，没有数据时返回false
+    bool TakeOutput(std::string *out);
+    // 连接的fd上是否是响应的字节流；共享内存连接的fd只用于通知，io_uring引擎下不能直接接收其上的数据
+    virtual bool IsStream() const { return true; }
+
+protected:
+    // 登记一个未完成的调用及其超时定时器，登记之后才能发送请求；连接已关闭时立即执行done并返回false
+    bool AddPending(uint64_t request_id, int timeout_ms, Completion done);
+    // 以code结束一个还没有完成的调用（如请求没能发出）
+    void FailPending(uint64_t request_id, Zrpc::RpcErrorCode code, const std::string &reason);
+    // 分发一个完整的响应帧（批量响应帧拆开后逐个分发），帧格式错误时返回false
+    bool DispatchFrame(const Zrpc::RpcResponseHeader &header, const char *body);
+    // 发送一个完整的帧，子类可以换用其他传输方式
+    virtual void SendFrame(const std::string &frame);
+    virtual void HandleClose(const std::string &reason);
+
+    int m_fd;
+    std::string m_endpoint;
+    std::atomic<bool> m_closed;
+
+private:
+    friend class ZrpcClientReactor;  // io_uring引擎下由reactor判断连接关闭
+
+    ZrpcMuxConnection(const ZrpcMuxConnection &) = delete;
+    ZrpcMuxConnection &operator=(const ZrpcMuxConnection &) = delete;
+
+    // 一次未完成的调用
+    struct PendingCall
+    {
+        Completion done;
+        ZrpcTimerWheel::TimerId timer = 0;  // 超时定时器
+    };
+
+    static int Connect(const std::string &ip, uint16_t port, int timeout_ms, const std::string &unix_path);
+    void FailAll(const std::string &reason);
+    bool RemovePending(uint64_t request_id, PendingCall *call);
+    void OnTimeout(uint64_t request_id, int timeout_ms);
+    void EnqueueBatch(const std::string &frame, const ZrpcBatchPolicy &policy);
+    void FlushBatch(uint64_t generation);
+    void TakeBatch(std::string *frame);  // 调用方需持有m_batch_mutex
+    void DispatchResponse(const Zrpc::RpcResponseHeader &header, const char *body);
+    // 解析并分发data中的完整响应帧，返回消耗的字节数，报文格式错误时关闭连接并返回-1
+    ssize_t ParseResponses(const char *data, size_t len);
+
+    std::atomic<uint64_t> m_next_request_id;
+    std::atomic<uint32_t> m_peer_compress_mask;
+
+    std::mutex m_send_mutex;  // 保护发送缓冲区，保证请求帧完整有序地写入连接
+    std::string m_output;     // 内核发送缓冲区写满时暂存的数据；io_uring引擎下是等待reactor发送的数据
+    ZrpcBuffer m_input;       // 接收缓冲区，只在reactor线程访问
+
+    std::mutex m_pending_mutex;
+    std::unordered_map<uint64_t, PendingCall> m_pending;
+
+    std::mutex m_batch_mutex;        // 保护批量缓冲区
+    std::string m_batch;             // 等待合并发送的请求帧
+    uint32_t m_batch_count = 0;
+    uint64_t m_batch_generation = 0; // 每开始一批加一，过期的延迟发送任务据此忽略
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _ZrpcResponder_H
+#define _ZrpcResponder_H
+
+#include <muduo/net/TcpConnection.h>
+#include <muduo/net/EventLoop.h>
+#include <google/protobuf/message.h>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "ZrpcCodec.h"
+
+// 服务端发送响应的目标：TCP/Unix域套接字上的连接，或同一主机上调用方的共享内存会话（见ZrpcShmSession）
+// 服务方法可能在其他线程上执行done，发送接口可以在任意线程上调用
+class ZrpcResponder
+{
+public:
+    virtual ~ZrpcResponder() {}
+
+    // 发送一个已编码好的完整响应帧
+    virtual void Send(const std::string &frame) = 0;
+
+    // 编码并发送一个响应，序列化失败时返回false
+    // 默认先编码到字符串再发送；共享内存会话直接编码到环上，不经过中间字符串
+    virtual bool SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                              const ZrpcCompressPolicy *compress) {
+        std::string frame;
+        if (!ZrpcCodec::EncodeResponse(request_id, response, &frame, compress)) {
+            return false;
+        }
+        Send(frame);
+        return true;
+    }
+};
+typedef std::shared_ptr<ZrpcResponder> ZrpcResponderPtr;
+
+// 套接字连接上的响应交给muduo发送，连接已断开时muduo会丢弃
+// 在业务线程上完成的响应通过runInLoop交回连接所属的IO线程写出，编码好的帧移动过去，不再拷贝一次
+class ZrpcConnectionResponder : public ZrpcResponder
+{
+public:
+    explicit ZrpcConnectionResponder(const muduo::net::TcpConnectionPtr &conn) : m_conn(conn) {}
+
+    void Send(const std::string &frame) override {
+        if (m_conn->getLoop()->isInLoopThread()) {
+            m_conn->send(frame);
+        } else {
+            SendInLoop(std::string(frame));
+        }
+    }
+
+    bool SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                      const ZrpcCompressPolicy *compress) override {
+        std::string frame;
+        if (!ZrpcCodec::EncodeResponse(request_id, response, &frame, compress)) {
+            return false;
+        }
+        if (m_conn->getLoop()->isInLoopThread()) {
+            m_conn->send(frame);
+        } else {
+            SendInLoop(std::move(frame));
+        }
+        return true;
+    }
+
+private:
+    void SendInLoop(std::string &&frame) {
+        muduo::net::TcpConnectionPtr conn = m_conn;
+        m_conn->getLoop()->runInLoop([conn, frame = std::move(frame)] { conn->send(frame); });
+    }
+
+    muduo::net::TcpConnectionPtr m_conn;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef _ZrpcServiceRegistry_H
+#define _ZrpcServiceRegistry_H
+
+#include "zookeeperutil.h"
+#include "ZrpcLoadBalancer.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <utility>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// 进程内共享的服务发现客户端
+// 每个服务端实例在 /service/method 下注册一个以 "ip:port" 命名的临时子节点，节点数据为实例属性（如 "weight=100;unix=/tmp/zrpc-8000.sock;host=node1"）
+// 整个进程只维护一个ZooKeeper会话，把 /service/method 对应的实例列表缓存在不可变的快照中：
+// 读路径只原子地取出当前快照，不加锁；首次查询某个方法或ZooKeeper通知子节点变化时，
+// 拷贝一份新快照修改后整体替换（copy-on-write），已取出旧快照的读者不受影响
+class ZrpcServiceRegistry
+{
+public:
+    static ZrpcServiceRegistry &GetInstance();
+
+    // 查询提供该方法的所有实例，命中快照时无锁返回，未命中时同步查询ZooKeeper并注册watcher
+    // 查询失败返回nullptr；返回的列表不可修改，可在调用期间安全持有
+    std::shared_ptr<const ZrpcEndpointList> Lookup(const std::string &service_name, const std::string &method_name);
+
+    // 预先解析多个方法（service_name, method_name）的实例列表：对未缓存的方法同时发出异步查询，最多等待timeout_ms毫秒
+    // 完成后结果已在快照中，之后的Lookup直接命中。实例属性（权重）在列表发布后异步补齐
+    // 返回是否全部解析成功，失败或超时的方法路径追加到failed
+    bool Prefetch(const std::vector<std::pair<std::string, std::string>> &methods, int timeout_ms,
+                  std::vector<std::string> *failed);
+
+private:
+    typedef std::unordered_map<std::string, std::shared_ptr<const ZrpcEndpointList>> EndpointMap;  // method_path -> 实例列表
+
+    // 一次Prefetch中尚未完成的异步查询，由各查询的完成回调共享
+    struct PrefetchBatch
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::set<std::string> pending;
+        std::vector<std::string> failed;
+    };
+    struct PrefetchRequest
+    {
+        std::string method_path;
+        std::shared_ptr<PrefetchBatch> batch;
+    };
+
+    ZrpcServiceRegistry();
+    ~ZrpcServiceRegistry() = default;
+    ZrpcServiceRegistry(const ZrpcServiceRegistry &) = delete;
+    ZrpcServiceRegistry &operator=(const ZrpcServiceRegistry &) = delete;
+
+    std::shared_ptr<const EndpointMap> LoadSnapshot() const;
+    // 发布新快照，endpoints为空表示删除该路径；调用方需持有m_update_mutex
+    void Publish(const std::string &method_path, std::shared_ptr<const ZrpcEndpointList> endpoints);
+    // 确保ZooKeeper会话可用，会话过期后重建并重新拉取所有已缓存的路径；调用方需持有m_update_mutex
+    void EnsureSession();
+    // 同步拉取子节点及其数据，并注册子节点watcher；调用方需持有m_update_mutex
+    bool FetchAndWatch(const std::string &method_path, ZrpcEndpointList *endpoints);
+    // 用拉取到的子节点列表更新快照，rc为ZooKeeper的返回码
+    void UpdateChildren(const std::string &method_path, int rc, const struct String_vector *strings);
+
+    // 子节点名 "ip:port" -> 实例地址
+    static bool ParseEndpoint(const std::string &name, ZrpcEndpoint *endpoint);
+    // 节点数据 "key=value;key=value" -> 实例属性
+    static void ParseInstanceData(const char *data, int len, ZrpcEndpoint *endpoint);
+    // ZooKeeper回调，运行在ZooKeeper客户端的回调线程中
+    static void ChildrenWatcher(zhandle_t *zh, int type, int state, const char *path, void *watcher_ctx);
+    static void ChildrenCompletion(int rc, const struct String_vector *strings, const void *data);
+    static void PrefetchCompletion(int rc, const struct String_vector *strings, const void *data);
+    static void InstanceDataCompletion(int rc, const char *value, int value_len, const struct Stat *stat, const void *data);
+
+    std::unique_ptr<ZkClient> m_zkclient;
+    std::shared_ptr<const EndpointMap> m_snapshot;  // 只通过std::atomic_load/atomic_store访问
+    std::mutex m_update_mutex;                      // 串行化快照的更新和会话重建
+    std::atomic<bool> m_session_expired;
+};
+
+#endif
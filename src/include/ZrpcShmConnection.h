@@ -0,0 +1,44 @@
+#ifndef _ZrpcShmConnection_H
+#define _ZrpcShmConnection_H
+
+#include <memory>
+#include <string>
+#include <google/protobuf/message.h>
+#include "ZrpcMuxConnection.h"
+#include "ZrpcShmRing.h"
+
+// 共享内存连接：与同一主机上的服务端之间通过共享内存环收发请求和响应（见ZrpcShmLink）
+// 请求直接编码到环上，响应在reactor线程上直接从环上解析；握手用的Unix域套接字保留下来，只用于感知服务端退出
+// 调用的登记、超时和响应分发与多路复用连接相同，done同样在reactor线程上执行
+class ZrpcShmConnection : public ZrpcMuxConnection
+{
+public:
+    // 获取到path上共享内存服务端的连接，同一path在进程内只保留一条，断开后自动重建
+    // 握手失败时返回nullptr，调用方改用套接字连接；失败后一段时间内不再尝试，避免每次调用都重新握手
+    static std::shared_ptr<ZrpcShmConnection> GetConnection(const std::string &path, int timeout_ms);
+
+    ZrpcShmConnection(int control_fd, const std::string &endpoint, std::unique_ptr<ZrpcShmLink> link);
+
+    // 异步调用：请求直接编码到共享内存环上，其余同ZrpcMuxConnection::CallAsync
+    // 同一主机上压缩只会增加开销，请求体不压缩
+    void CallAsync(uint64_t request_id, const std::string &service_name, const std::string &method_name,
+                   const google::protobuf::Message &request, int timeout_ms, Completion done,
+                   Zrpc::RpcPriority priority = Zrpc::PRIORITY_UNSET);
+    using ZrpcMuxConnection::CallAsync;
+
+    void HandleRead() override;
+    void HandleWrite() override {}
+    bool IsStream() const override { return false; }
+
+protected:
+    void SendFrame(const std::string &frame) override;
+    void HandleClose(const std::string &reason) override;
+
+private:
+    std::unique_ptr<ZrpcShmLink> m_link;
+
+    // 握手失败后多久内不再尝试
+    static constexpr int kRetryIntervalMs = 1000;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef _ZrpcShmRing_H
+#define _ZrpcShmRing_H
+
+#include <atomic>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "ZrpcCodec.h"
+
+// 放在共享内存中的单生产者单消费者环形缓冲区
+// 记录格式：8字节记录头（数据长度 + 标志）+ 数据，按8字节对齐；环尾放不下一条完整的记录时写一条填充记录，从环首重新开始，
+// 因此每条记录在内存中都是连续的，帧可以直接编码到环上，也可以直接在环上解析
+// 读写位置是单调递增的字节数，生产者只写tail，消费者只写head，两端之间不需要锁
+class ZrpcShmRing
+{
+public:
+    static constexpr uint32_t kFlagPadding = 1;  // 填充记录，下一条记录从环首开始
+    static constexpr uint32_t kFlagMore = 2;     // 超长的帧拆成多条记录，除最后一条外都带此标志
+
+    // 环的控制块，与数据一起放在共享内存中；生产者和消费者各自写的字段分在不同的缓存行上
+    struct Control
+    {
+        alignas(64) std::atomic<uint64_t> tail;       // 生产者已发布的位置
+        std::atomic<uint32_t> producer_waiting;      // 生产者有数据在等空间，消费者腾出空间后敲它的门铃
+        alignas(64) std::atomic<uint64_t> head;       // 消费者已释放的位置
+        std::atomic<uint32_t> consumer_waiting;      // 消费者准备睡眠，生产者发布新记录后敲它的门铃
+    };
+
+    ZrpcShmRing();
+    // capacity为2的幂；控制块和数据区由ZrpcShmLink在共享内存中分配
+    void Init(Control *control, char *data, uint32_t capacity);
+
+    // 单条记录的数据长度上限，更长的帧由ZrpcShmLink拆成多条记录
+    size_t MaxRecordSize() const { return m_capacity / 2 - kRecordHeaderSize; }
+
+    // 生产者：预留一条len字节的记录，返回数据的写入位置；空间不足时返回nullptr
+    // 预留的记录在EndWrite之前对消费者不可见，放弃时不调用EndWrite即可
+    char *BeginWrite(size_t len);
+    // 生产者：发布BeginWrite预留的记录，返回true表示消费者在睡眠，需要敲它的门铃
+    bool EndWrite(uint32_t flags);
+    // 生产者：没有空间写入len字节的记录，准备等待；返回false表示此时已经有了空间，应重试
+    bool ArmProducer(size_t len);
+
+    // 消费者：取出下一条记录；返回1表示取到，0表示环为空，-1表示记录格式错误（共享内存被对端写坏）
+    int Peek(const char **data, size_t *len, uint32_t *flags);
+    // 消费者：释放Peek取到的记录，返回true表示生产者在等空间，需要敲它的门铃
+    bool Consume();
+    // 消费者：准备睡眠；返回false表示环中又有了记录，应继续处理
+    bool ArmConsumer();
+
+private:
+    static constexpr size_t kRecordHeaderSize = 8;
+    static size_t RecordSize(size_t len) { return (kRecordHeaderSize + len + 7) & ~static_cast<size_t>(7); }
+    bool HasSpace(uint64_t tail, size_t len) const;
+
+    Control *m_control;
+    char *m_data;
+    uint32_t m_capacity;
+    // 读写位置在本端另存一份，不依赖共享内存中可能被对端改坏的值
+    uint64_t m_tail;           // 生产者：已发布的位置
+    uint64_t m_reserved_tail;  // 生产者：BeginWrite预留的记录之后的位置
+    char *m_reserved_header;   // 生产者：BeginWrite预留的记录头
+    uint64_t m_head;           // 消费者：已释放的位置
+    uint64_t m_next_head;      // 消费者：Peek取到的记录之后的位置
+};
+
+// 同一主机上两个进程之间的共享内存链路：一块memfd上两个方向相反的环，加上两端各自的eventfd门铃
+// 调用方创建链路，通过Unix域套接字把memfd和门铃传给服务端（SCM_RIGHTS），服务端映射同一块内存；套接字保留下来感知对端退出
+// 门铃只在对端睡眠或在等空间时才敲，两端都忙碌时收发帧不经过任何系统调用
+class ZrpcShmLink
+{
+public:
+    // 收到一个完整的帧：data通常直接指向共享内存，只在回调执行期间有效，应在回调内完成反序列化
+    typedef std::function<void(const char *data, size_t len)> FrameHandler;
+    // 把一帧编码到给定的分配函数分配的内存中
+    typedef std::function<bool(const ZrpcCodec::FrameAllocator &alloc)> FrameEncoder;
+
+    // 每个方向的环默认容量
+    static constexpr uint32_t kDefaultCapacity = 1024 * 1024;
+
+    // 调用方：连接path上的服务端，创建链路并完成握手，成功时*control_fd为保留的套接字（非阻塞）
+    static std::unique_ptr<ZrpcShmLink> Connect(const std::string &path, uint32_t capacity, int timeout_ms, int *control_fd);
+    // 服务端：在可读的套接字上接收调用方发来的共享内存并映射，回复握手；失败时返回nullptr，套接字由调用方关闭
+    static std::unique_ptr<ZrpcShmLink> Accept(int control_fd);
+
+    ~ZrpcShmLink();
+
+    // 本端的门铃，可读时应调用Poll
+    int WaitFd() const { return m_wait_fd; }
+
+    // 发送一帧，可以在任意线程调用：encode把帧直接编码到发送环上；环满或帧超过单条记录的上限时
+    // 先编码到溢出队列，再分段拷贝进环（对端腾出空间后在Poll中继续）。编码失败或溢出队列超过上限时返回false
+    bool Send(const FrameEncoder &encode);
+    bool SendFrame(const std::string &frame);
+
+    // 门铃可读时调用，同一时刻只能有一个线程调用：依次处理收到的帧，继续发送溢出队列，最后准备睡眠
+    // 返回false表示对端写坏了共享内存，应关闭链路
+    bool Poll(const FrameHandler &handler);
+
+private:
+    ZrpcShmLink();
+    ZrpcShmLink(const ZrpcShmLink &) = delete;
+    ZrpcShmLink &operator=(const ZrpcShmLink &) = delete;
+
+    static std::unique_ptr<ZrpcShmLink> Create(uint32_t capacity);
+    static std::unique_ptr<ZrpcShmLink> Attach(int memfd, int server_doorbell, int client_doorbell);
+    bool Map(size_t size);
+    void InitRings(uint32_t capacity, bool server);
+    void Notify();
+    void FlushOverflow();  // 调用方需持有m_send_mutex
+
+    // 溢出队列的上限，超过时认为对端已经不再接收
+    static constexpr size_t kMaxOverflowBytes = ZrpcCodec::kMaxFrameSize;
+
+    int m_memfd;
+    int m_wait_fd;    // 本端的门铃
+    int m_notify_fd;  // 对端的门铃
+    char *m_base;
+    size_t m_size;
+    ZrpcShmRing m_send;
+    ZrpcShmRing m_recv;
+
+    std::mutex m_send_mutex;          // 发送环只能有一个生产者，多个调用线程的发送在这里串行
+    std::deque<std::string> m_overflow;
+    size_t m_overflow_bytes;
+    size_t m_overflow_offset;         // 队首的帧已经写入环的字节数
+    std::string m_partial;            // 拆成多条记录的帧，收齐之前暂存在这里，只在Poll中访问
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _ZrpcShmServer_H
+#define _ZrpcShmServer_H
+
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/Channel.h>
+#include <muduo/base/Timestamp.h>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include "ZrpcShmRing.h"
+#include "ZrpcResponder.h"
+
+// 服务端与一个调用方之间的共享内存会话
+// 门铃和保留的套接字都注册在一个IO线程上：门铃可读时在该线程上依次处理请求帧，套接字挂断表示调用方已退出
+// 响应可以在任意线程上发送，直接编码到发往调用方的环上
+class ZrpcShmSession : public ZrpcResponder, public std::enable_shared_from_this<ZrpcShmSession>
+{
+public:
+    // 收到一个请求帧：data直接指向共享内存，只在回调执行期间有效
+    typedef std::function<void(const std::shared_ptr<ZrpcShmSession> &, const char *data, size_t len, muduo::Timestamp)> FrameCallback;
+    typedef std::function<void(const std::shared_ptr<ZrpcShmSession> &)> CloseCallback;
+
+    ZrpcShmSession(muduo::net::EventLoop *loop, const std::string &name, int control_fd, std::unique_ptr<ZrpcShmLink> link);
+    ~ZrpcShmSession();
+
+    void SetFrameCallback(const FrameCallback &cb) { m_frame_callback = cb; }
+    void SetCloseCallback(const CloseCallback &cb) { m_close_callback = cb; }
+
+    // 以下两个接口在loop线程中调用
+    void Start();
+    void Close();
+
+    const std::string &Name() const { return m_name; }
+    muduo::net::EventLoop *GetLoop() const { return m_loop; }
+
+    // 关闭保留的套接字，调用方随即让会话上的调用失败；会话由IO线程在挂断事件中关闭，可以在任意线程上调用
+    void Abort(const std::string &reason);
+
+    void Send(const std::string &frame) override;
+    // 调用方在同一主机上，压缩只会增加开销，忽略协商出的压缩策略
+    bool SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                      const ZrpcCompressPolicy *compress) override;
+
+private:
+    void HandleDoorbell(muduo::Timestamp receive_time);
+    void HandleControl();
+
+    muduo::net::EventLoop *m_loop;
+    std::string m_name;
+    int m_control_fd;
+    std::unique_ptr<ZrpcShmLink> m_link;
+    std::unique_ptr<muduo::net::Channel> m_doorbell_channel;
+    std::unique_ptr<muduo::net::Channel> m_control_channel;
+    FrameCallback m_frame_callback;
+    CloseCallback m_close_callback;
+    std::atomic<bool> m_closed;
+};
+typedef std::shared_ptr<ZrpcShmSession> ZrpcShmSessionPtr;
+
+// 共享内存传输的服务端：在单独的Unix域套接字上接受调用方的握手（收到memfd和门铃），
+// 之后请求和响应都经过共享内存，会话轮流分配给TcpServer的IO线程
+class ZrpcShmServer
+{
+public:
+    ZrpcShmServer(muduo::net::EventLoop *loop, const std::string &path, const std::string &name);
+    ~ZrpcShmServer();
+
+    void SetFrameCallback(const ZrpcShmSession::FrameCallback &cb) { m_frame_callback = cb; }
+
+    // 开始监听，必须在loop所在的线程中调用，要求同ZrpcUnixServer::Start；监听失败返回false
+    bool Start(const std::shared_ptr<muduo::net::EventLoopThreadPool> &pool);
+
+    const std::string &Path() const { return m_path; }
+
+private:
+    void HandleAccept();
+    void HandleHandshake(int fd);
+    void RemoveSession(const ZrpcShmSessionPtr &session);
+
+    muduo::net::EventLoop *m_loop;  // 接受连接和握手的线程
+    std::string m_path;
+    std::string m_name;
+    int m_listenfd;
+    std::unique_ptr<muduo::net::Channel> m_accept_channel;
+    std::shared_ptr<muduo::net::EventLoopThreadPool> m_pool;
+    ZrpcShmSession::FrameCallback m_frame_callback;
+    // 以下只在m_loop线程中访问
+    std::unordered_map<int, std::shared_ptr<muduo::net::Channel>> m_handshakes;  // 已接受、还没有收到握手的连接
+    std::unordered_map<std::string, ZrpcShmSessionPtr> m_sessions;
+    int m_next_session_id;
+};
+
+#endif
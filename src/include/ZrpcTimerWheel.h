@@ -0,0 +1,71 @@
+#ifndef _ZrpcTimerWheel_H
+#define _ZrpcTimerWheel_H
+
+#include <functional>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// 分层时间轮：精度1毫秒，共4层（256 + 3 * 64个槽），可表示约18.6小时内的定时，更远的定时会在到达范围内后重新放置
+// 添加和取消都是O(1)，推进时只处理到期的槽，高层的槽在低层转完一圈时才向下分散一次，
+// 因此大量未完成调用的超时定时（绝大多数会在到期前被取消）开销很小。
+// 定时器节点放在数组中复用，TimerId由节点下标和代数组成，节点被复用后旧的TimerId自动失效。
+// 所有接口都是线程安全的；Advance不执行回调，而是把到期的回调交给调用方在锁外执行。
+class ZrpcTimerWheel
+{
+public:
+    typedef std::function<void()> Callback;
+    typedef uint64_t TimerId;  // 0表示无效
+
+    ZrpcTimerWheel();
+
+    // 添加一个在when时刻到期的定时器，when早于当前时刻时在下一次推进时到期
+    TimerId Add(std::chrono::steady_clock::time_point when, Callback cb);
+    // 取消定时器，已到期或已取消时返回false
+    bool Cancel(TimerId id);
+
+    // 推进到now，取出所有到期的回调
+    void Advance(std::chrono::steady_clock::time_point now, std::vector<Callback> *expired);
+    // 距离下一个可能到期的时刻还有多少毫秒，最多max_ms；没有定时器时返回max_ms
+    int NextTimeoutMs(std::chrono::steady_clock::time_point now, int max_ms);
+
+    size_t Size();
+
+private:
+    static constexpr int kRootBits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr int kLevels = 4;
+    static constexpr uint32_t kRootSize = 1u << kRootBits;
+    static constexpr uint32_t kLevelSize = 1u << kLevelBits;
+    static constexpr int64_t kMaxSpan = (int64_t(1) << (kRootBits + (kLevels - 1) * kLevelBits)) - 1;
+    static constexpr int32_t kNil = -1;
+
+    struct Node
+    {
+        int64_t expire = 0;       // 到期的tick
+        uint32_t generation = 1;  // 节点每次复用时加一
+        int32_t prev = kNil;
+        int32_t next = kNil;
+        int32_t slot = kNil;      // 所在槽的下标，kNil表示空闲
+        Callback cb;
+    };
+
+    int64_t ToTick(std::chrono::steady_clock::time_point when) const;
+    int32_t SlotFor(int64_t expire) const;
+    void Link(int32_t index);
+    void Unlink(int32_t index);
+    void Release(int32_t index);
+    void Cascade(int level);
+
+    std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_origin;  // tick 0对应的时刻
+    int64_t m_current;        // 下一个要处理的tick
+    size_t m_size;            // 未到期的定时器个数
+    std::vector<int32_t> m_slots;  // 每个槽的链表头，第0层kRootSize个，其余每层kLevelSize个
+    std::vector<Node> m_nodes;
+    int32_t m_free;           // 空闲节点链表头（复用next字段）
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _ZrpcUnixServer_H
+#define _ZrpcUnixServer_H
+
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/TcpConnection.h>
+#include <muduo/net/Callbacks.h>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+// Unix域套接字上的服务端：muduo的TcpServer只能监听IP地址，这里自己接受连接，
+// 再像TcpServer一样把连接包装成muduo::net::TcpConnection，分配到TcpServer的IO线程上，
+// 因此两种连接共用同一套连接回调和消息回调，服务端处理请求的代码不区分传输方式
+class ZrpcUnixServer
+{
+public:
+    ZrpcUnixServer(muduo::net::EventLoop *loop, const std::string &path, const std::string &name);
+    ~ZrpcUnixServer();
+
+    void setConnectionCallback(const muduo::net::ConnectionCallback &cb) { m_connection_callback = cb; }
+    void setMessageCallback(const muduo::net::MessageCallback &cb) { m_message_callback = cb; }
+
+    // 开始监听，新连接轮流分配给pool中的IO线程（通常是TcpServer::threadPool()，需在TcpServer::start之后调用）
+    // 必须在loop所在的线程中调用；监听失败返回false，此时只提供TCP服务
+    bool Start(const std::shared_ptr<muduo::net::EventLoopThreadPool> &pool);
+
+    const std::string &Path() const { return m_path; }
+
+private:
+    void HandleAccept();
+    void RemoveConnection(const muduo::net::TcpConnectionPtr &conn);
+    void RemoveConnectionInLoop(const muduo::net::TcpConnectionPtr &conn);
+
+    muduo::net::EventLoop *m_loop;  // 接受连接的线程
+    std::string m_path;
+    std::string m_name;
+    int m_listenfd;
+    std::unique_ptr<muduo::net::Channel> m_accept_channel;
+    std::shared_ptr<muduo::net::EventLoopThreadPool> m_pool;
+    muduo::net::ConnectionCallback m_connection_callback;
+    muduo::net::MessageCallback m_message_callback;
+    std::unordered_map<std::string, muduo::net::TcpConnectionPtr> m_connections;  // 只在m_loop线程中访问
+    int m_next_conn_id;
+};
+
+#endif
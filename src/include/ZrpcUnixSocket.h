@@ -0,0 +1,32 @@
+#ifndef _ZrpcUnixSocket_H
+#define _ZrpcUnixSocket_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+
+// 同一主机上的服务之间使用Unix域套接字通信，不经过TCP/IP协议栈（没有校验和、拥塞控制、回环网卡的排队），本地调用延迟更低
+// 服务端除TCP端口外还在Unix域套接字上监听，并把路径和主机标识作为实例属性注册到ZooKeeper（"unix=路径;host=主机名"）；
+// 调用方发现实例与自己在同一主机上时自动改用Unix域套接字连接，连接失败（如容器间不共享文件系统）时回退到TCP
+class ZrpcUnixSocket
+{
+public:
+    // 本机标识（主机名），与实例属性中的host相同时认为在同一主机上
+    static const std::string &LocalHostId();
+    // 未配置路径时服务端使用的默认路径
+    static std::string DefaultPath(uint16_t port);
+
+    // 非阻塞地连接，最多等待timeout_ms毫秒；成功返回非阻塞的fd，失败返回-1
+    static int Connect(const std::string &path, int timeout_ms);
+    // 在path上监听（先删除残留的套接字文件），成功返回非阻塞的监听fd，失败返回-1
+    static int Listen(const std::string &path);
+
+    // 在已连接的套接字上发送data，同时传递count个fd（SCM_RIGHTS），用于把共享内存交给同一主机上的对端
+    static bool SendFds(int sockfd, const int *fds, int count, const void *data, size_t len);
+    // 接收SendFds发来的数据和fd：返回收到的数据字节数（0表示对端已关闭，-1表示出错），*count为收到的fd数
+    // 收到的fd超过max_count时多余的直接关闭
+    static ssize_t RecvFds(int sockfd, int *fds, int max_count, int *count, void *data, size_t len);
+};
+
+#endif
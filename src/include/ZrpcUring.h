@@ -0,0 +1,93 @@
+#ifndef _ZrpcUring_H
+#define _ZrpcUring_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// io_uring的薄封装（直接使用系统调用，不依赖liburing），供io_uring引擎的服务端（ZrpcUringServer）和客户端reactor使用
+// 提交队列上的操作先攒在用户态，由Submit一次提交并顺带等待完成事件，一次系统调用处理一整批收发
+// 接收使用多发（multishot）模式，一次提交持续收取，数据放在预先注册的缓冲区环中由内核挑选，不必为每个连接预留接收缓冲区
+// 套接字登记到固定文件表后，每次操作不再查找和引用计数fd
+// 需要内核6.0及以上；编译时没有较新的内核头文件（未定义ZRPC_HAVE_IO_URING）或运行时内核不支持时Init返回false，调用方改用epoll
+// 接口都不是线程安全的，只在拥有该实例的线程中调用
+class ZrpcUring
+{
+public:
+    // 一个完成事件
+    struct Completion
+    {
+        uint64_t user_data;
+        int32_t res;
+        uint32_t flags;
+    };
+
+    ZrpcUring();
+    ~ZrpcUring();
+    ZrpcUring(const ZrpcUring &) = delete;
+    ZrpcUring &operator=(const ZrpcUring &) = delete;
+
+    // 创建提交队列长度为entries的实例；内核不支持所需的特性时返回false
+    bool Init(unsigned entries);
+
+    // 注册count个大小为size的接收缓冲区（count必须是2的幂），多发接收从中挑选缓冲区
+    bool SetupBuffers(unsigned count, unsigned size);
+    const char *Buffer(uint16_t bid) const { return m_buffers + static_cast<size_t>(bid) * m_buffer_size; }
+    // 完成事件处理完后把缓冲区还给内核
+    void RecycleBuffer(uint16_t bid);
+
+    // 注册容量为count的固定文件表，RegisterFile返回fd占用的槽位，表满或失败时返回-1（调用方直接使用fd）
+    bool SetupFiles(unsigned count);
+    int RegisterFile(int fd);
+    void UnregisterFile(int slot);
+
+    // 以下准备一个操作，在下一次Submit时提交；slot为RegisterFile返回的槽位，-1表示直接使用fd
+    // 提交队列已满时先提交已准备好的操作，仍然失败时返回false
+    bool PrepareRecvMultishot(int fd, int slot, uint64_t user_data);
+    bool PrepareSend(int fd, int slot, const void *data, size_t len, uint64_t user_data);
+    bool PrepareAcceptMultishot(int fd, uint64_t user_data);
+    bool PrepareRead(int fd, void *buf, size_t len, uint64_t user_data);
+    bool PreparePollMultishot(int fd, uint64_t user_data);
+    bool PrepareCancel(uint64_t target_user_data, uint64_t user_data);
+
+    // 提交已准备好的操作，并在完成队列为空时最多等待timeout_ms毫秒（-1表示一直等待，0表示不等待）直到有完成事件
+    int Submit(int timeout_ms);
+    // 取出下一个完成事件，完成队列为空时返回false
+    bool NextCompletion(Completion *completion);
+
+    // 完成事件的标志位
+    static bool HasMore(uint32_t flags);  // 多发操作仍然有效，之后还会有完成事件
+    static bool HasBuffer(uint32_t flags);
+    static uint16_t BufferId(uint32_t flags);
+
+private:
+    void *GetSqe();
+
+    int m_ringfd;
+    void *m_ring;  // 提交队列和完成队列共用的映射
+    size_t m_ring_size;
+    void *m_sqes;
+    size_t m_sqes_size;
+    unsigned m_sq_entries;
+    unsigned *m_sq_head;
+    unsigned *m_sq_tail;
+    unsigned m_sq_mask;
+    unsigned *m_cq_head;
+    unsigned *m_cq_tail;
+    unsigned m_cq_mask;
+    void *m_cqes;
+    unsigned m_sq_local_tail;  // 已准备、尚未发布给内核的提交队列尾
+    unsigned m_to_submit;      // 已准备、尚未提交的操作数
+
+    void *m_buf_ring;  // 接收缓冲区环
+    size_t m_buf_ring_size;
+    char *m_buffers;
+    size_t m_buffers_size;
+    unsigned m_buffer_size;
+    unsigned m_buffer_mask;
+    uint16_t m_buf_tail;
+
+    std::vector<int> m_free_slots;  // 固定文件表中空闲的槽位
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef _ZrpcUringServer_H
+#define _ZrpcUringServer_H
+
+#include <muduo/base/Timestamp.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include "ZrpcUring.h"
+#include "ZrpcBuffer.h"
+#include "ZrpcResponder.h"
+#include "Zrpcheader.pb.h"
+
+class ZrpcUringLoop;
+
+// io_uring引擎下服务端的一条TCP连接
+// 接收由所属loop上的多发接收驱动，请求帧尽量直接在内核填充的缓冲区上解析；响应可以在任意线程上发送，
+// 先追加到输出缓冲区，由loop在本轮事件处理之后合并成一次发送操作提交
+class ZrpcUringConnection : public ZrpcResponder, public std::enable_shared_from_this<ZrpcUringConnection>
+{
+public:
+    ZrpcUringConnection(ZrpcUringLoop *loop, int fd);
+    ~ZrpcUringConnection();
+
+    void Send(const std::string &frame) override;
+    // 响应直接编码到输出缓冲区，不经过中间字符串
+    bool SendResponse(uint64_t request_id, const google::protobuf::Message &response,
+                      const ZrpcCompressPolicy *compress) override;
+
+private:
+    friend class ZrpcUringLoop;
+
+    void ScheduleSend();  // 调用方需持有m_send_mutex
+
+    ZrpcUringLoop *m_loop;
+    int m_fd;
+    std::atomic<bool> m_closed;
+
+    // 以下只在loop线程中访问
+    uint64_t m_token;          // 在loop中的编号，用于把完成事件对应到连接
+    int m_slot;                // 固定文件表中的槽位，-1表示没有登记
+    bool m_recv_armed;         // 多发接收仍然有效
+    bool m_send_inflight;      // 有一个发送操作还没有完成
+    ZrpcBuffer m_input;        // 跨越缓冲区边界的半个请求帧
+    std::string m_sending;     // 正在发送的数据，发送操作完成前不能改动
+    size_t m_sending_offset;
+
+    std::mutex m_send_mutex;   // 保护以下两项
+    std::string m_output;      // 等待发送的响应
+    bool m_writing;            // 已经安排了发送，之后追加的响应会随同发出
+};
+typedef std::shared_ptr<ZrpcUringConnection> ZrpcUringConnectionPtr;
+
+// 一个io_uring事件循环线程：拥有自己的io_uring实例、接收缓冲区环和固定文件表，驱动分配给它的连接
+class ZrpcUringLoop
+{
+public:
+    typedef std::function<void()> Functor;
+    // 收到一个完整的请求帧：args指向接收缓冲区，只在回调执行期间有效；返回false时关闭连接
+    typedef std::function<bool(const ZrpcResponderPtr &, const Zrpc::RpcHeader &, const char *args, size_t args_size,
+                               muduo::Timestamp)> RequestCallback;
+    typedef std::function<void(int fd)> AcceptCallback;
+    typedef std::function<void()> ThreadInitCallback;
+
+    ZrpcUringLoop();
+    ~ZrpcUringLoop();
+
+    // 在启动线程前调用，io_uring不可用时返回false
+    bool Init();
+    void SetRequestCallback(const RequestCallback &cb) { m_request_callback = cb; }
+    // 在本loop上用多发accept接受listenfd上的连接，在Start之前调用
+    void SetAcceptor(int listenfd, const AcceptCallback &cb);
+    // loop线程开始运行前先在该线程上调用cb（如绑核），在Start之前设置
+    void SetThreadInitCallback(const ThreadInitCallback &cb) { m_thread_init_callback = cb; }
+    void Start();
+    void Stop();
+
+    void RunInLoop(Functor cb);
+    void QueueInLoop(Functor cb);
+    bool IsInLoopThread() const { return std::this_thread::get_id() == m_thread_id; }
+
+    // 以下在loop线程中调用
+    void AddConnection(const ZrpcUringConnectionPtr &conn);
+    void StartSend(const ZrpcUringConnectionPtr &conn);
+
+private:
+    void Loop();
+    void Wakeup();
+    void ArmWakeup();
+    void ArmAccept();
+    void DoPendingFunctors();
+    void HandleCompletion(const ZrpcUring::Completion &completion, muduo::Timestamp receive_time);
+    void HandleRecv(const ZrpcUringConnectionPtr &conn, const ZrpcUring::Completion &completion, muduo::Timestamp receive_time);
+    void HandleSend(const ZrpcUringConnectionPtr &conn, int res);
+    // 解析data中的完整请求帧并交给回调，返回消耗的字节数，报文格式错误时返回-1
+    ssize_t ParseRequests(const ZrpcUringConnectionPtr &conn, const char *data, size_t len, muduo::Timestamp receive_time);
+    void CloseConnection(const ZrpcUringConnectionPtr &conn);
+    void ReleaseIfIdle(const ZrpcUringConnectionPtr &conn);
+
+    ZrpcUring m_ring;
+    int m_wakeupfd;  // eventfd，其他线程有任务时唤醒阻塞在io_uring_enter上的loop
+    uint64_t m_wakeup_value;
+    std::atomic<bool> m_wakeup_pending;  // 已经写过eventfd、loop还没有处理，之后的任务不必再写
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    std::thread::id m_thread_id;  // Start等到loop线程写入后才返回，之后只读
+
+    std::mutex m_mutex;
+    std::condition_variable m_started;
+    std::vector<Functor> m_pending_functors;
+
+    int m_listenfd;
+    AcceptCallback m_accept_callback;
+    RequestCallback m_request_callback;
+    ThreadInitCallback m_thread_init_callback;
+
+    std::unordered_map<uint64_t, ZrpcUringConnectionPtr> m_connections;  // 编号 -> 连接，只在loop线程访问
+    uint64_t m_next_token;
+
+    static constexpr unsigned kRingEntries = 1024;
+    static constexpr unsigned kBufferCount = 512;         // 接收缓冲区个数，必须是2的幂
+    static constexpr unsigned kBufferSize = 16 * 1024;
+    static constexpr unsigned kFixedFiles = 16384;        // 固定文件表的容量，超出的连接直接使用fd
+};
+
+// io_uring引擎的TCP服务端，用法与muduo的TcpServer相同：第一个loop接受连接，连接轮流分配给各个loop；
+// 开启SO_REUSEPORT时每个loop各自监听同一端口、只接受分给自己的连接，由内核分散新连接
+// 与muduo的区别在于每个loop一次io_uring_enter同时提交一批收发并取回完成事件，连接数较多时系统调用次数大幅减少
+class ZrpcUringServer
+{
+public:
+    ZrpcUringServer(const std::string &ip, uint16_t port, const std::string &name);
+    ~ZrpcUringServer();
+
+    void SetThreadNum(int num_threads) { m_num_threads = num_threads > 0 ? num_threads : 1; }
+    void SetRequestCallback(const ZrpcUringLoop::RequestCallback &cb) { m_request_callback = cb; }
+    void SetThreadInitCallback(const ZrpcUringLoop::ThreadInitCallback &cb) { m_thread_init_callback = cb; }
+    void SetReusePort(bool on) { m_reuse_port = on; }
+
+    // 监听并启动各个loop线程；io_uring不可用或监听失败时返回false，调用方改用muduo的TcpServer
+    bool Start();
+
+private:
+    void HandleAccept(int fd);
+    int Listen();  // 创建监听套接字，失败时返回-1
+
+    std::string m_ip;
+    uint16_t m_port;
+    std::string m_name;
+    int m_num_threads;
+    bool m_reuse_port;
+    std::vector<int> m_listenfds;  // 开启SO_REUSEPORT时每个loop一个
+    ZrpcUringLoop::RequestCallback m_request_callback;
+    ZrpcUringLoop::ThreadInitCallback m_thread_init_callback;
+    std::vector<std::unique_ptr<ZrpcUringLoop>> m_loops;
+    size_t m_next_loop;  // 只在接受连接的loop线程中访问
+};
+
+#endif
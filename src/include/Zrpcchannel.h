@@ -3,9 +3,37 @@
 // 此类是继承自google::protobuf::RpcChannel
 // 目的是为了给客户端进行方法调用的时候，统一接收的
 #include <google/protobuf/service.h>
-#include "zookeeperutil.h"
 #include "ZrpcHeartbeat.h"
+#include "ZrpcLoadBalancer.h"
+#include "ZrpcFuture.h"
+#include "ZrpcLatencyTracker.h"
+#include "ZrpcMuxConnection.h"
+#include "ZrpcCompression.h"
 #include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class Zrpccontroller;
+
+// 预热参数
+struct ZrpcPrewarmOptions
+{
+    int timeout_ms = 3000;                // 整个预热（服务发现和建立连接）的时间上限
+    size_t connections_per_endpoint = 4;  // 同步调用走连接池时每个实例预建的连接数
+};
+
+// 预热结果
+struct ZrpcPrewarmResult
+{
+    bool ready = false;      // 每个方法都找到了实例，且至少有一个实例已经建好连接
+    size_t methods = 0;      // 预热的方法数
+    size_t endpoints = 0;    // 这些方法涉及的实例数（去重后）
+    size_t connections = 0;  // 已建好的到这些实例的连接数
+    std::vector<std::string> failures;  // 失败的方法或实例及原因
+};
 
 class ZrpcChannel : public google::protobuf::RpcChannel
 {
@@ -14,30 +42,114 @@ public:
     virtual ~ZrpcChannel()
     {
     }
+    // done为空时同步阻塞；done非空时异步调用，立即返回，由客户端reactor线程收到响应后执行done
     void CallMethod(const ::google::protobuf::MethodDescriptor *method,
                     ::google::protobuf::RpcController *controller,
                     const ::google::protobuf::Message *request,
                     ::google::protobuf::Message *response,
                     ::google::protobuf::Closure *done) override; // override可以验证是否是虚函数
+
+    // 新增：以future方式发起异步调用，future的结果表示调用是否成功（失败原因见controller）
+    // 请求、响应和控制器必须保持有效直到future完成；多个future可以用WhenAll/WhenAny组合
+    ZrpcFuture<bool> CallMethodAsync(const ::google::protobuf::MethodDescriptor *method,
+                                     ::google::protobuf::RpcController *controller,
+                                     const ::google::protobuf::Message *request,
+                                     ::google::protobuf::Message *response);
     
     // 新增：心跳相关功能
     void EnableHeartbeat(bool enable = true);
     bool IsHeartbeatEnabled() const;
+
+    // 新增：多路复用模式，同一条连接上可以同时存在多个未完成的请求，channel可被多线程共享
+    void EnableMultiplex(bool enable = true);
+    bool IsMultiplexEnabled() const;
+
+    // 新增：服务有多个实例时的负载均衡策略，默认轮询
+    void SetLoadBalancePolicy(ZrpcLoadBalancer::Policy policy);
+    ZrpcLoadBalancer::Policy GetLoadBalancePolicy() const;
+
+    // 新增：请求对冲的触发时间，对控制器开启了对冲的调用生效
+    // 调用在该方法近期延迟的percentile百分位数（至少min_delay_ms毫秒）内没有响应时，向另一个实例再发一份请求
+    void SetHedgingPolicy(double percentile = 0.95, int min_delay_ms = 1);
+
+    // 新增：批量调用，适合大量的小请求；调用走多路复用连接，同一连接上的请求按策略合并为一个批量帧发送
+    // 服务端拆开批量帧逐个分发，响应同样合并为一个批量帧返回。对冲调用不参与合并
+    void EnableBatching(bool enable = true, const ZrpcBatchPolicy &policy = ZrpcBatchPolicy());
+    bool IsBatchingEnabled() const;
+
+    // 新增：请求体压缩，method_name为空时作为所有方法的默认策略，否则只对该方法（如"Set"）生效
+    // 只有对端在响应头中声明支持该算法后才会压缩，与旧版本或未编译该压缩库的服务端通信时按原样发送
+    void SetCompression(Zrpc::CompressType type, uint32_t min_bytes = 1024, const std::string &method_name = "");
+
+    // 新增：共享内存传输，适合同一主机上延迟敏感的调用（如sidecar）
+    // 实例在同一主机上且提供共享内存时，请求直接编码到与服务端共享的环上，服务端在环上直接解析，双方都忙碌时收发不经过系统调用
+    // 调用走reactor驱动的共享内存连接，实例不在同一主机或握手失败时回退到多路复用连接
+    // 共享内存上没有需要摊薄的系统调用，批量策略对它不生效；对冲调用仍走多路复用连接
+    void EnableSharedMemory(bool enable = true);
+    bool IsSharedMemoryEnabled() const;
+
+    // 新增：过载保护，按实例自适应地限制并发请求数，实例失败率过高时熔断，直接以RPC_OVERLOADED失败而不再发出请求
+    // 并发上限和熔断状态按实例地址在进程内共享（见ZrpcEndpointStats），负载均衡会避开熔断中的实例
+    void EnableOverloadProtection(bool enable = true);
+    bool IsOverloadProtectionEnabled() const;
+
+    // 新增：预热，在进程接入流量前调用，避免第一批请求依次等待ZooKeeper会话、服务发现和建立连接
+    // 同时查询这些服务所有方法的实例（异步读取ZooKeeper），再并行地与每个实例建立连接：
+    // 总是建立多路复用连接（异步调用、按key路由和对冲调用都走它），同步调用走连接池时再预建connections_per_endpoint个池化连接
+    // 阻塞到完成或超时，返回结果中的ready可作为就绪检查的依据
+    ZrpcPrewarmResult Prewarm(const std::vector<const google::protobuf::ServiceDescriptor *> &services,
+                              const ZrpcPrewarmOptions &options = ZrpcPrewarmOptions());
     
 private:
-    int m_clientfd; // 存放客户端套接字
-    std::string service_name;
-    std::string m_ip;
-    uint16_t m_port;
-    std::string method_name;
-    int m_idx; // 用来划分服务器ip和port的下标
-    bool newConnect(const char *ip, uint16_t port);
-    bool newConnectWithTimeout(const char *ip, uint16_t port, int timeout_ms);
-    std::string QueryServiceHost(ZkClient *zkclient, std::string service_name, std::string method_name, int &idx);
+    // 同步阻塞调用每次都按负载均衡策略选择实例；开启心跳时每个实例（"服务名.方法名@ip:port"）只在第一次选中时登记
+    std::unordered_set<std::string> m_heartbeat_services;
+    bool CheckHeartbeat(const google::protobuf::MethodDescriptor *method, const ZrpcEndpoint &endpoint,
+                        google::protobuf::RpcController *controller);
+    bool ResolveEndpoint(const google::protobuf::MethodDescriptor *method, const Zrpccontroller *controller, ZrpcEndpoint *endpoint);
+    const ZrpcEndpoint *SelectEndpoint(const ZrpcEndpointList &endpoints, const Zrpccontroller *controller);
+    void CallMethodMultiplexed(const ::google::protobuf::MethodDescriptor *method,
+                               ::google::protobuf::RpcController *controller,
+                               const ::google::protobuf::Message *request,
+                               ::google::protobuf::Message *response,
+                               ::google::protobuf::Closure *done);
+    void CallMethodHedged(const ::google::protobuf::MethodDescriptor *method,
+                          Zrpccontroller *controller,
+                          const ::google::protobuf::Message *request,
+                          ::google::protobuf::Message *response,
+                          ::google::protobuf::Closure *done);
+    std::shared_ptr<ZrpcLatencyTracker> GetLatencyTracker(const google::protobuf::MethodDescriptor *method);
+    ZrpcCompressPolicy GetCompressPolicy(const google::protobuf::MethodDescriptor *method) const;
     
     // 新增：心跳相关成员
     bool m_heartbeat_enabled;
-    std::string m_service_key;
     mutable std::mutex m_mutex;
+
+    // 新增：多路复用开关
+    bool m_multiplex_enabled;
+
+    // 新增：批量调用
+    bool m_batching_enabled;
+    ZrpcBatchPolicy m_batch_policy;
+
+    // 新增：共享内存开关
+    bool m_shm_enabled;
+
+    // 新增：过载保护开关
+    bool m_overload_protection;
+
+    // 新增：请求体压缩策略
+    ZrpcCompressPolicy m_default_compress;
+    std::unordered_map<std::string, ZrpcCompressPolicy> m_method_compress;
+
+    // 新增：在服务的多个实例之间选择
+    ZrpcLoadBalancer m_balancer;
+
+    // 新增：请求对冲，延迟样本按方法分别统计
+    double m_hedge_percentile;
+    int m_hedge_min_delay_ms;
+    std::unordered_map<std::string, std::shared_ptr<ZrpcLatencyTracker>> m_latency_trackers;
+
+    // 预热时并行建立连接的线程数上限
+    static constexpr size_t kPrewarmThreads = 16;
 };
 #endif
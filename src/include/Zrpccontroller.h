@@ -5,6 +5,7 @@
 #include<string>
 #include<chrono>
 #include<atomic>
+#include "Zrpcheader.pb.h"
 //用于描述RPC调用的控制器
 //其主要作用是跟踪RPC方法调用的状态、错误信息并提供控制功能(如取消调用)。
 class Zrpccontroller:public google::protobuf::RpcController
@@ -15,6 +16,9 @@ public:
  bool Failed() const;
 std::string ErrorText() const;
 void SetFailed(const std::string &reason);
+// 新增：带错误码的失败，例如超时为RPC_DEADLINE_EXCEEDED；调用成功时ErrorCode()为RPC_OK
+void SetFailed(Zrpc::RpcErrorCode code, const std::string &reason);
+Zrpc::RpcErrorCode ErrorCode() const;
 
 //目前未实现具体的功能
 void StartCancel();
@@ -27,15 +31,58 @@ int GetTimeout() const;
 bool IsTimeout() const;
 void SetStartTime();
 void CheckTimeout();
+// 新增：截止时间 = 开始时间 + 超时时间；在服务端处理请求期间发起的嵌套调用，截止时间不晚于上游请求的截止时间
+std::chrono::steady_clock::time_point GetDeadline() const;
+int RemainingMs() const;  // 距截止时间的剩余毫秒数，已超时返回0
+
+// 新增：按key路由，设置后channel用一致性哈希把相同key的调用发往同一个服务实例
+void SetHashKey(const std::string &key);
+const std::string &GetHashKey() const;
+bool HasHashKey() const;
+
+// 新增：请求对冲，只能对幂等的方法开启（例如缓存的Get/Exists/BatchGet）
+// 开启后若在近期延迟的百分位数内没有收到响应，channel会向另一个实例再发一份请求，采用先到的响应
+void SetHedging(bool enable);
+bool IsHedgingEnabled() const;
+
+// 新增：调用的优先级，随请求头发给服务端，覆盖服务端为该方法配置的优先级（例如把一次批量统计调用降为BACKGROUND）
+// 默认PRIORITY_UNSET，由服务端决定
+void SetPriority(Zrpc::RpcPriority priority);
+Zrpc::RpcPriority GetPriority() const;
 
 private:
  bool m_failed;//RPC方法执行过程中的状态
  std::string m_errText;//RPC方法执行过程中的错误信息
+ Zrpc::RpcErrorCode m_errCode;//失败时的错误码
  
  // 新增：超时控制相关成员
  int m_timeout_ms;  // 超时时间（毫秒）
  std::chrono::steady_clock::time_point m_start_time;  // 开始时间
+ std::chrono::steady_clock::time_point m_deadline;  // 截止时间
  std::atomic<bool> m_canceled;  // 取消标志
+
+ std::string m_hash_key;  // 路由key，为空表示按负载均衡策略选择实例
+ bool m_hedging;  // 是否允许对冲请求
+ Zrpc::RpcPriority m_priority;  // 调用方指定的优先级
+};
+
+// 服务端处理一个请求期间的截止时间（由请求头中的时间预算换算而来），保存在处理线程上
+// 处理函数中的嵌套调用在SetStartTime时继承剩余预算，上游已经放弃的请求不会再向下游扩散
+class ZrpcDeadlineScope
+{
+public:
+ explicit ZrpcDeadlineScope(std::chrono::steady_clock::time_point deadline);
+ ~ZrpcDeadlineScope();  // 恢复外层的截止时间
+
+ // 当前线程上正在处理的请求的截止时间，没有时返回false
+ static bool Current(std::chrono::steady_clock::time_point *deadline);
+
+private:
+ ZrpcDeadlineScope(const ZrpcDeadlineScope &) = delete;
+ ZrpcDeadlineScope &operator=(const ZrpcDeadlineScope &) = delete;
+
+ bool m_prev_valid;
+ std::chrono::steady_clock::time_point m_prev;
 };
 
 #endif
\ No newline at end of file
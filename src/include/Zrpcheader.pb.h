@@ -8,12 +8,12 @@
 #include <string>
 
 #include <google/protobuf/port_def.inc>
-#if PROTOBUF_VERSION < 3012000
+#if PROTOBUF_VERSION < 3021000
 #error This file was generated by a newer version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please update
 #error your headers.
 #endif
-#if 3012004 < PROTOBUF_MIN_PROTOC_VERSION
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
 #error This file was generated by an older version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please
 #error regenerate this file with a newer version of protoc.
@@ -23,14 +23,13 @@
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/arena.h>
 #include <google/protobuf/arenastring.h>
-#include <google/protobuf/generated_message_table_driven.h>
 #include <google/protobuf/generated_message_util.h>
-#include <google/protobuf/inlined_string_field.h>
 #include <google/protobuf/metadata_lite.h>
 #include <google/protobuf/generated_message_reflection.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>  // IWYU pragma: export
 #include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
 #include <google/protobuf/unknown_field_set.h>
 // @@protoc_insertion_point(includes)
 #include <google/protobuf/port_def.inc>
@@ -43,34 +42,116 @@ PROTOBUF_NAMESPACE_CLOSE
 
 // Internal implementation detail -- do not use these members.
 struct TableStruct_Zrpcheader_2eproto {
-  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTableField entries[]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::AuxillaryParseTableField aux[]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTable schema[1]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::FieldMetadata field_metadata[];
-  static const ::PROTOBUF_NAMESPACE_ID::internal::SerializationTable serialization_table[];
-  static const ::PROTOBUF_NAMESPACE_ID::uint32 offsets[];
+  static const uint32_t offsets[];
 };
 extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_Zrpcheader_2eproto;
 namespace Zrpc {
 class RpcHeader;
-class RpcHeaderDefaultTypeInternal;
+struct RpcHeaderDefaultTypeInternal;
 extern RpcHeaderDefaultTypeInternal _RpcHeader_default_instance_;
+class RpcResponseHeader;
+struct RpcResponseHeaderDefaultTypeInternal;
+extern RpcResponseHeaderDefaultTypeInternal _RpcResponseHeader_default_instance_;
 }  // namespace Zrpc
 PROTOBUF_NAMESPACE_OPEN
 template<> ::Zrpc::RpcHeader* Arena::CreateMaybeMessage<::Zrpc::RpcHeader>(Arena*);
+template<> ::Zrpc::RpcResponseHeader* Arena::CreateMaybeMessage<::Zrpc::RpcResponseHeader>(Arena*);
 PROTOBUF_NAMESPACE_CLOSE
 namespace Zrpc {
 
+enum CompressType : int {
+  COMPRESS_NONE = 0,
+  COMPRESS_LZ4 = 1,
+  COMPRESS_ZSTD = 2,
+  COMPRESS_SNAPPY = 3,
+  CompressType_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  CompressType_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
+};
+bool CompressType_IsValid(int value);
+constexpr CompressType CompressType_MIN = COMPRESS_NONE;
+constexpr CompressType CompressType_MAX = COMPRESS_SNAPPY;
+constexpr int CompressType_ARRAYSIZE = CompressType_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* CompressType_descriptor();
+template<typename T>
+inline const std::string& CompressType_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, CompressType>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function CompressType_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    CompressType_descriptor(), enum_t_value);
+}
+inline bool CompressType_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, CompressType* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<CompressType>(
+    CompressType_descriptor(), name, value);
+}
+enum RpcPriority : int {
+  PRIORITY_UNSET = 0,
+  PRIORITY_CRITICAL = 1,
+  PRIORITY_NORMAL = 2,
+  PRIORITY_BACKGROUND = 3,
+  RpcPriority_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  RpcPriority_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
+};
+bool RpcPriority_IsValid(int value);
+constexpr RpcPriority RpcPriority_MIN = PRIORITY_UNSET;
+constexpr RpcPriority RpcPriority_MAX = PRIORITY_BACKGROUND;
+constexpr int RpcPriority_ARRAYSIZE = RpcPriority_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* RpcPriority_descriptor();
+template<typename T>
+inline const std::string& RpcPriority_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, RpcPriority>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function RpcPriority_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    RpcPriority_descriptor(), enum_t_value);
+}
+inline bool RpcPriority_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, RpcPriority* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<RpcPriority>(
+    RpcPriority_descriptor(), name, value);
+}
+enum RpcErrorCode : int {
+  RPC_OK = 0,
+  RPC_SERVICE_NOT_FOUND = 1,
+  RPC_METHOD_NOT_FOUND = 2,
+  RPC_BAD_REQUEST = 3,
+  RPC_INTERNAL_ERROR = 4,
+  RPC_DEADLINE_EXCEEDED = 5,
+  RPC_UNAVAILABLE = 6,
+  RPC_OVERLOADED = 7,
+  RpcErrorCode_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  RpcErrorCode_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
+};
+bool RpcErrorCode_IsValid(int value);
+constexpr RpcErrorCode RpcErrorCode_MIN = RPC_OK;
+constexpr RpcErrorCode RpcErrorCode_MAX = RPC_OVERLOADED;
+constexpr int RpcErrorCode_ARRAYSIZE = RpcErrorCode_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* RpcErrorCode_descriptor();
+template<typename T>
+inline const std::string& RpcErrorCode_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, RpcErrorCode>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function RpcErrorCode_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    RpcErrorCode_descriptor(), enum_t_value);
+}
+inline bool RpcErrorCode_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, RpcErrorCode* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<RpcErrorCode>(
+    RpcErrorCode_descriptor(), name, value);
+}
 // ===================================================================
 
-class RpcHeader PROTOBUF_FINAL :
+class RpcHeader final :
     public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:Zrpc.RpcHeader) */ {
  public:
-  inline RpcHeader() : RpcHeader(nullptr) {};
-  virtual ~RpcHeader();
+  inline RpcHeader() : RpcHeader(nullptr) {}
+  ~RpcHeader() override;
+  explicit PROTOBUF_CONSTEXPR RpcHeader(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
 
   RpcHeader(const RpcHeader& from);
   RpcHeader(RpcHeader&& from) noexcept
@@ -83,8 +164,13 @@ class RpcHeader PROTOBUF_FINAL :
     return *this;
   }
   inline RpcHeader& operator=(RpcHeader&& from) noexcept {
-    if (GetArena() == from.GetArena()) {
-      if (this != &from) InternalSwap(&from);
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
     } else {
       CopyFrom(from);
     }
@@ -95,14 +181,14 @@ class RpcHeader PROTOBUF_FINAL :
     return GetDescriptor();
   }
   static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
-    return GetMetadataStatic().descriptor;
+    return default_instance().GetMetadata().descriptor;
   }
   static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
-    return GetMetadataStatic().reflection;
+    return default_instance().GetMetadata().reflection;
+  }
+  static const RpcHeader& default_instance() {
+    return *internal_default_instance();
   }
-  static const RpcHeader& default_instance();
-
-  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
   static inline const RpcHeader* internal_default_instance() {
     return reinterpret_cast<const RpcHeader*>(
                &_RpcHeader_default_instance_);
@@ -115,7 +201,12 @@ class RpcHeader PROTOBUF_FINAL :
   }
   inline void Swap(RpcHeader* other) {
     if (other == this) return;
-    if (GetArena() == other->GetArena()) {
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
       InternalSwap(other);
     } else {
       ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
@@ -123,56 +214,53 @@ class RpcHeader PROTOBUF_FINAL :
   }
   void UnsafeArenaSwap(RpcHeader* other) {
     if (other == this) return;
-    GOOGLE_DCHECK(GetArena() == other->GetArena());
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
     InternalSwap(other);
   }
 
   // implements Message ----------------------------------------------
 
-  inline RpcHeader* New() const final {
-    return CreateMaybeMessage<RpcHeader>(nullptr);
-  }
-
-  RpcHeader* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+  RpcHeader* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
     return CreateMaybeMessage<RpcHeader>(arena);
   }
-  void CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
-  void MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const RpcHeader& from);
-  void MergeFrom(const RpcHeader& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const RpcHeader& from) {
+    RpcHeader::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
 
   size_t ByteSizeLong() const final;
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
-  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
-      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  inline void SharedCtor();
-  inline void SharedDtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(RpcHeader* other);
+
+  private:
   friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
   static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
     return "Zrpc.RpcHeader";
   }
   protected:
-  explicit RpcHeader(::PROTOBUF_NAMESPACE_ID::Arena* arena);
-  private:
-  static void ArenaDtor(void* object);
-  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  explicit RpcHeader(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
   public:
 
-  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
-  private:
-  static ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadataStatic() {
-    ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&::descriptor_table_Zrpcheader_2eproto);
-    return ::descriptor_table_Zrpcheader_2eproto.file_level_metadata[kIndexInFileMessages];
-  }
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
 
-  public:
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
 
   // nested types ----------------------------------------------------
 
@@ -181,65 +269,103 @@ class RpcHeader PROTOBUF_FINAL :
   enum : int {
     kServiceNameFieldNumber = 1,
     kMethodNameFieldNumber = 2,
+    kRequestIdFieldNumber = 4,
     kArgsSizeFieldNumber = 3,
+    kTimeoutMsFieldNumber = 5,
+    kBatchCountFieldNumber = 6,
+    kCompressTypeFieldNumber = 7,
+    kAcceptCompressFieldNumber = 8,
+    kPriorityFieldNumber = 9,
   };
   // bytes service_name = 1;
   void clear_service_name();
   const std::string& service_name() const;
-  void set_service_name(const std::string& value);
-  void set_service_name(std::string&& value);
-  void set_service_name(const char* value);
-  void set_service_name(const void* value, size_t size);
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_service_name(ArgT0&& arg0, ArgT... args);
   std::string* mutable_service_name();
-  std::string* release_service_name();
+  PROTOBUF_NODISCARD std::string* release_service_name();
   void set_allocated_service_name(std::string* service_name);
-  GOOGLE_PROTOBUF_RUNTIME_DEPRECATED("The unsafe_arena_ accessors for"
-  "    string fields are deprecated and will be removed in a"
-  "    future release.")
-  std::string* unsafe_arena_release_service_name();
-  GOOGLE_PROTOBUF_RUNTIME_DEPRECATED("The unsafe_arena_ accessors for"
-  "    string fields are deprecated and will be removed in a"
-  "    future release.")
-  void unsafe_arena_set_allocated_service_name(
-      std::string* service_name);
   private:
   const std::string& _internal_service_name() const;
-  void _internal_set_service_name(const std::string& value);
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_service_name(const std::string& value);
   std::string* _internal_mutable_service_name();
   public:
 
   // bytes method_name = 2;
   void clear_method_name();
   const std::string& method_name() const;
-  void set_method_name(const std::string& value);
-  void set_method_name(std::string&& value);
-  void set_method_name(const char* value);
-  void set_method_name(const void* value, size_t size);
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_method_name(ArgT0&& arg0, ArgT... args);
   std::string* mutable_method_name();
-  std::string* release_method_name();
+  PROTOBUF_NODISCARD std::string* release_method_name();
   void set_allocated_method_name(std::string* method_name);
-  GOOGLE_PROTOBUF_RUNTIME_DEPRECATED("The unsafe_arena_ accessors for"
-  "    string fields are deprecated and will be removed in a"
-  "    future release.")
-  std::string* unsafe_arena_release_method_name();
-  GOOGLE_PROTOBUF_RUNTIME_DEPRECATED("The unsafe_arena_ accessors for"
-  "    string fields are deprecated and will be removed in a"
-  "    future release.")
-  void unsafe_arena_set_allocated_method_name(
-      std::string* method_name);
   private:
   const std::string& _internal_method_name() const;
-  void _internal_set_method_name(const std::string& value);
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_method_name(const std::string& value);
   std::string* _internal_mutable_method_name();
   public:
 
+  // uint64 request_id = 4;
+  void clear_request_id();
+  uint64_t request_id() const;
+  void set_request_id(uint64_t value);
+  private:
+  uint64_t _internal_request_id() const;
+  void _internal_set_request_id(uint64_t value);
+  public:
+
   // uint32 args_size = 3;
   void clear_args_size();
-  ::PROTOBUF_NAMESPACE_ID::uint32 args_size() const;
-  void set_args_size(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t args_size() const;
+  void set_args_size(uint32_t value);
+  private:
+  uint32_t _internal_args_size() const;
+  void _internal_set_args_size(uint32_t value);
+  public:
+
+  // uint32 timeout_ms = 5;
+  void clear_timeout_ms();
+  uint32_t timeout_ms() const;
+  void set_timeout_ms(uint32_t value);
+  private:
+  uint32_t _internal_timeout_ms() const;
+  void _internal_set_timeout_ms(uint32_t value);
+  public:
+
+  // uint32 batch_count = 6;
+  void clear_batch_count();
+  uint32_t batch_count() const;
+  void set_batch_count(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_args_size() const;
-  void _internal_set_args_size(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_batch_count() const;
+  void _internal_set_batch_count(uint32_t value);
+  public:
+
+  // .Zrpc.CompressType compress_type = 7;
+  void clear_compress_type();
+  ::Zrpc::CompressType compress_type() const;
+  void set_compress_type(::Zrpc::CompressType value);
+  private:
+  ::Zrpc::CompressType _internal_compress_type() const;
+  void _internal_set_compress_type(::Zrpc::CompressType value);
+  public:
+
+  // uint32 accept_compress = 8;
+  void clear_accept_compress();
+  uint32_t accept_compress() const;
+  void set_accept_compress(uint32_t value);
+  private:
+  uint32_t _internal_accept_compress() const;
+  void _internal_set_accept_compress(uint32_t value);
+  public:
+
+  // .Zrpc.RpcPriority priority = 9;
+  void clear_priority();
+  ::Zrpc::RpcPriority priority() const;
+  void set_priority(::Zrpc::RpcPriority value);
+  private:
+  ::Zrpc::RpcPriority _internal_priority() const;
+  void _internal_set_priority(::Zrpc::RpcPriority value);
   public:
 
   // @@protoc_insertion_point(class_scope:Zrpc.RpcHeader)
@@ -249,10 +375,238 @@ class RpcHeader PROTOBUF_FINAL :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr service_name_;
-  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr method_name_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 args_size_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr service_name_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr method_name_;
+    uint64_t request_id_;
+    uint32_t args_size_;
+    uint32_t timeout_ms_;
+    uint32_t batch_count_;
+    int compress_type_;
+    uint32_t accept_compress_;
+    int priority_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_Zrpcheader_2eproto;
+};
+// -------------------------------------------------------------------
+
+class RpcResponseHeader final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:Zrpc.RpcResponseHeader) */ {
+ public:
+  inline RpcResponseHeader() : RpcResponseHeader(nullptr) {}
+  ~RpcResponseHeader() override;
+  explicit PROTOBUF_CONSTEXPR RpcResponseHeader(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  RpcResponseHeader(const RpcResponseHeader& from);
+  RpcResponseHeader(RpcResponseHeader&& from) noexcept
+    : RpcResponseHeader() {
+    *this = ::std::move(from);
+  }
+
+  inline RpcResponseHeader& operator=(const RpcResponseHeader& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline RpcResponseHeader& operator=(RpcResponseHeader&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const RpcResponseHeader& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const RpcResponseHeader* internal_default_instance() {
+    return reinterpret_cast<const RpcResponseHeader*>(
+               &_RpcResponseHeader_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    1;
+
+  friend void swap(RpcResponseHeader& a, RpcResponseHeader& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(RpcResponseHeader* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(RpcResponseHeader* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  RpcResponseHeader* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<RpcResponseHeader>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const RpcResponseHeader& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const RpcResponseHeader& from) {
+    RpcResponseHeader::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(RpcResponseHeader* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "Zrpc.RpcResponseHeader";
+  }
+  protected:
+  explicit RpcResponseHeader(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kErrorTextFieldNumber = 4,
+    kRequestIdFieldNumber = 1,
+    kBodySizeFieldNumber = 2,
+    kErrorCodeFieldNumber = 3,
+    kBatchCountFieldNumber = 5,
+    kCompressTypeFieldNumber = 6,
+    kAcceptCompressFieldNumber = 7,
+  };
+  // bytes error_text = 4;
+  void clear_error_text();
+  const std::string& error_text() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_error_text(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_error_text();
+  PROTOBUF_NODISCARD std::string* release_error_text();
+  void set_allocated_error_text(std::string* error_text);
+  private:
+  const std::string& _internal_error_text() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_error_text(const std::string& value);
+  std::string* _internal_mutable_error_text();
+  public:
+
+  // uint64 request_id = 1;
+  void clear_request_id();
+  uint64_t request_id() const;
+  void set_request_id(uint64_t value);
+  private:
+  uint64_t _internal_request_id() const;
+  void _internal_set_request_id(uint64_t value);
+  public:
+
+  // uint32 body_size = 2;
+  void clear_body_size();
+  uint32_t body_size() const;
+  void set_body_size(uint32_t value);
+  private:
+  uint32_t _internal_body_size() const;
+  void _internal_set_body_size(uint32_t value);
+  public:
+
+  // .Zrpc.RpcErrorCode error_code = 3;
+  void clear_error_code();
+  ::Zrpc::RpcErrorCode error_code() const;
+  void set_error_code(::Zrpc::RpcErrorCode value);
+  private:
+  ::Zrpc::RpcErrorCode _internal_error_code() const;
+  void _internal_set_error_code(::Zrpc::RpcErrorCode value);
+  public:
+
+  // uint32 batch_count = 5;
+  void clear_batch_count();
+  uint32_t batch_count() const;
+  void set_batch_count(uint32_t value);
+  private:
+  uint32_t _internal_batch_count() const;
+  void _internal_set_batch_count(uint32_t value);
+  public:
+
+  // .Zrpc.CompressType compress_type = 6;
+  void clear_compress_type();
+  ::Zrpc::CompressType compress_type() const;
+  void set_compress_type(::Zrpc::CompressType value);
+  private:
+  ::Zrpc::CompressType _internal_compress_type() const;
+  void _internal_set_compress_type(::Zrpc::CompressType value);
+  public:
+
+  // uint32 accept_compress = 7;
+  void clear_accept_compress();
+  uint32_t accept_compress() const;
+  void set_accept_compress(uint32_t value);
+  private:
+  uint32_t _internal_accept_compress() const;
+  void _internal_set_accept_compress(uint32_t value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:Zrpc.RpcResponseHeader)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr error_text_;
+    uint64_t request_id_;
+    uint32_t body_size_;
+    int error_code_;
+    uint32_t batch_count_;
+    int compress_type_;
+    uint32_t accept_compress_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_Zrpcheader_2eproto;
 };
 // ===================================================================
@@ -268,54 +622,38 @@ class RpcHeader PROTOBUF_FINAL :
 
 // bytes service_name = 1;
 inline void RpcHeader::clear_service_name() {
-  service_name_.ClearToEmpty(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  _impl_.service_name_.ClearToEmpty();
 }
 inline const std::string& RpcHeader::service_name() const {
   // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.service_name)
   return _internal_service_name();
 }
-inline void RpcHeader::set_service_name(const std::string& value) {
-  _internal_set_service_name(value);
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcHeader::set_service_name(ArgT0&& arg0, ArgT... args) {
+ 
+ _impl_.service_name_.SetBytes(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.service_name)
 }
 inline std::string* RpcHeader::mutable_service_name() {
+  std::string* _s = _internal_mutable_service_name();
   // @@protoc_insertion_point(field_mutable:Zrpc.RpcHeader.service_name)
-  return _internal_mutable_service_name();
+  return _s;
 }
 inline const std::string& RpcHeader::_internal_service_name() const {
-  return service_name_.Get();
+  return _impl_.service_name_.Get();
 }
 inline void RpcHeader::_internal_set_service_name(const std::string& value) {
   
-  service_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), value, GetArena());
-}
-inline void RpcHeader::set_service_name(std::string&& value) {
-  
-  service_name_.Set(
-    &::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::move(value), GetArena());
-  // @@protoc_insertion_point(field_set_rvalue:Zrpc.RpcHeader.service_name)
-}
-inline void RpcHeader::set_service_name(const char* value) {
-  GOOGLE_DCHECK(value != nullptr);
-  
-  service_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::string(value),
-              GetArena());
-  // @@protoc_insertion_point(field_set_char:Zrpc.RpcHeader.service_name)
-}
-inline void RpcHeader::set_service_name(const void* value,
-    size_t size) {
-  
-  service_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::string(
-      reinterpret_cast<const char*>(value), size), GetArena());
-  // @@protoc_insertion_point(field_set_pointer:Zrpc.RpcHeader.service_name)
+  _impl_.service_name_.Set(value, GetArenaForAllocation());
 }
 inline std::string* RpcHeader::_internal_mutable_service_name() {
   
-  return service_name_.Mutable(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  return _impl_.service_name_.Mutable(GetArenaForAllocation());
 }
 inline std::string* RpcHeader::release_service_name() {
   // @@protoc_insertion_point(field_release:Zrpc.RpcHeader.service_name)
-  return service_name_.Release(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  return _impl_.service_name_.Release();
 }
 inline void RpcHeader::set_allocated_service_name(std::string* service_name) {
   if (service_name != nullptr) {
@@ -323,80 +661,49 @@ inline void RpcHeader::set_allocated_service_name(std::string* service_name) {
   } else {
     
   }
-  service_name_.SetAllocated(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), service_name,
-      GetArena());
-  // @@protoc_insertion_point(field_set_allocated:Zrpc.RpcHeader.service_name)
-}
-inline std::string* RpcHeader::unsafe_arena_release_service_name() {
-  // @@protoc_insertion_point(field_unsafe_arena_release:Zrpc.RpcHeader.service_name)
-  GOOGLE_DCHECK(GetArena() != nullptr);
-  
-  return service_name_.UnsafeArenaRelease(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(),
-      GetArena());
-}
-inline void RpcHeader::unsafe_arena_set_allocated_service_name(
-    std::string* service_name) {
-  GOOGLE_DCHECK(GetArena() != nullptr);
-  if (service_name != nullptr) {
-    
-  } else {
-    
+  _impl_.service_name_.SetAllocated(service_name, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.service_name_.IsDefault()) {
+    _impl_.service_name_.Set("", GetArenaForAllocation());
   }
-  service_name_.UnsafeArenaSetAllocated(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(),
-      service_name, GetArena());
-  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:Zrpc.RpcHeader.service_name)
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:Zrpc.RpcHeader.service_name)
 }
 
 // bytes method_name = 2;
 inline void RpcHeader::clear_method_name() {
-  method_name_.ClearToEmpty(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  _impl_.method_name_.ClearToEmpty();
 }
 inline const std::string& RpcHeader::method_name() const {
   // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.method_name)
   return _internal_method_name();
 }
-inline void RpcHeader::set_method_name(const std::string& value) {
-  _internal_set_method_name(value);
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcHeader::set_method_name(ArgT0&& arg0, ArgT... args) {
+ 
+ _impl_.method_name_.SetBytes(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.method_name)
 }
 inline std::string* RpcHeader::mutable_method_name() {
+  std::string* _s = _internal_mutable_method_name();
   // @@protoc_insertion_point(field_mutable:Zrpc.RpcHeader.method_name)
-  return _internal_mutable_method_name();
+  return _s;
 }
 inline const std::string& RpcHeader::_internal_method_name() const {
-  return method_name_.Get();
+  return _impl_.method_name_.Get();
 }
 inline void RpcHeader::_internal_set_method_name(const std::string& value) {
   
-  method_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), value, GetArena());
-}
-inline void RpcHeader::set_method_name(std::string&& value) {
-  
-  method_name_.Set(
-    &::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::move(value), GetArena());
-  // @@protoc_insertion_point(field_set_rvalue:Zrpc.RpcHeader.method_name)
-}
-inline void RpcHeader::set_method_name(const char* value) {
-  GOOGLE_DCHECK(value != nullptr);
-  
-  method_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::string(value),
-              GetArena());
-  // @@protoc_insertion_point(field_set_char:Zrpc.RpcHeader.method_name)
-}
-inline void RpcHeader::set_method_name(const void* value,
-    size_t size) {
-  
-  method_name_.Set(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), ::std::string(
-      reinterpret_cast<const char*>(value), size), GetArena());
-  // @@protoc_insertion_point(field_set_pointer:Zrpc.RpcHeader.method_name)
+  _impl_.method_name_.Set(value, GetArenaForAllocation());
 }
 inline std::string* RpcHeader::_internal_mutable_method_name() {
   
-  return method_name_.Mutable(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  return _impl_.method_name_.Mutable(GetArenaForAllocation());
 }
 inline std::string* RpcHeader::release_method_name() {
   // @@protoc_insertion_point(field_release:Zrpc.RpcHeader.method_name)
-  return method_name_.Release(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArena());
+  return _impl_.method_name_.Release();
 }
 inline void RpcHeader::set_allocated_method_name(std::string* method_name) {
   if (method_name != nullptr) {
@@ -404,58 +711,359 @@ inline void RpcHeader::set_allocated_method_name(std::string* method_name) {
   } else {
     
   }
-  method_name_.SetAllocated(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), method_name,
-      GetArena());
+  _impl_.method_name_.SetAllocated(method_name, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.method_name_.IsDefault()) {
+    _impl_.method_name_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   // @@protoc_insertion_point(field_set_allocated:Zrpc.RpcHeader.method_name)
 }
-inline std::string* RpcHeader::unsafe_arena_release_method_name() {
-  // @@protoc_insertion_point(field_unsafe_arena_release:Zrpc.RpcHeader.method_name)
-  GOOGLE_DCHECK(GetArena() != nullptr);
+
+// uint32 args_size = 3;
+inline void RpcHeader::clear_args_size() {
+  _impl_.args_size_ = 0u;
+}
+inline uint32_t RpcHeader::_internal_args_size() const {
+  return _impl_.args_size_;
+}
+inline uint32_t RpcHeader::args_size() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.args_size)
+  return _internal_args_size();
+}
+inline void RpcHeader::_internal_set_args_size(uint32_t value) {
   
-  return method_name_.UnsafeArenaRelease(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(),
-      GetArena());
+  _impl_.args_size_ = value;
 }
-inline void RpcHeader::unsafe_arena_set_allocated_method_name(
-    std::string* method_name) {
-  GOOGLE_DCHECK(GetArena() != nullptr);
-  if (method_name != nullptr) {
+inline void RpcHeader::set_args_size(uint32_t value) {
+  _internal_set_args_size(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.args_size)
+}
+
+// uint64 request_id = 4;
+inline void RpcHeader::clear_request_id() {
+  _impl_.request_id_ = uint64_t{0u};
+}
+inline uint64_t RpcHeader::_internal_request_id() const {
+  return _impl_.request_id_;
+}
+inline uint64_t RpcHeader::request_id() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.request_id)
+  return _internal_request_id();
+}
+inline void RpcHeader::_internal_set_request_id(uint64_t value) {
+  
+  _impl_.request_id_ = value;
+}
+inline void RpcHeader::set_request_id(uint64_t value) {
+  _internal_set_request_id(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.request_id)
+}
+
+// uint32 timeout_ms = 5;
+inline void RpcHeader::clear_timeout_ms() {
+  _impl_.timeout_ms_ = 0u;
+}
+inline uint32_t RpcHeader::_internal_timeout_ms() const {
+  return _impl_.timeout_ms_;
+}
+inline uint32_t RpcHeader::timeout_ms() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.timeout_ms)
+  return _internal_timeout_ms();
+}
+inline void RpcHeader::_internal_set_timeout_ms(uint32_t value) {
+  
+  _impl_.timeout_ms_ = value;
+}
+inline void RpcHeader::set_timeout_ms(uint32_t value) {
+  _internal_set_timeout_ms(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.timeout_ms)
+}
+
+// uint32 batch_count = 6;
+inline void RpcHeader::clear_batch_count() {
+  _impl_.batch_count_ = 0u;
+}
+inline uint32_t RpcHeader::_internal_batch_count() const {
+  return _impl_.batch_count_;
+}
+inline uint32_t RpcHeader::batch_count() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.batch_count)
+  return _internal_batch_count();
+}
+inline void RpcHeader::_internal_set_batch_count(uint32_t value) {
+  
+  _impl_.batch_count_ = value;
+}
+inline void RpcHeader::set_batch_count(uint32_t value) {
+  _internal_set_batch_count(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.batch_count)
+}
+
+// .Zrpc.CompressType compress_type = 7;
+inline void RpcHeader::clear_compress_type() {
+  _impl_.compress_type_ = 0;
+}
+inline ::Zrpc::CompressType RpcHeader::_internal_compress_type() const {
+  return static_cast< ::Zrpc::CompressType >(_impl_.compress_type_);
+}
+inline ::Zrpc::CompressType RpcHeader::compress_type() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.compress_type)
+  return _internal_compress_type();
+}
+inline void RpcHeader::_internal_set_compress_type(::Zrpc::CompressType value) {
+  
+  _impl_.compress_type_ = value;
+}
+inline void RpcHeader::set_compress_type(::Zrpc::CompressType value) {
+  _internal_set_compress_type(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.compress_type)
+}
+
+// uint32 accept_compress = 8;
+inline void RpcHeader::clear_accept_compress() {
+  _impl_.accept_compress_ = 0u;
+}
+inline uint32_t RpcHeader::_internal_accept_compress() const {
+  return _impl_.accept_compress_;
+}
+inline uint32_t RpcHeader::accept_compress() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.accept_compress)
+  return _internal_accept_compress();
+}
+inline void RpcHeader::_internal_set_accept_compress(uint32_t value) {
+  
+  _impl_.accept_compress_ = value;
+}
+inline void RpcHeader::set_accept_compress(uint32_t value) {
+  _internal_set_accept_compress(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.accept_compress)
+}
+
+// .Zrpc.RpcPriority priority = 9;
+inline void RpcHeader::clear_priority() {
+  _impl_.priority_ = 0;
+}
+inline ::Zrpc::RpcPriority RpcHeader::_internal_priority() const {
+  return static_cast< ::Zrpc::RpcPriority >(_impl_.priority_);
+}
+inline ::Zrpc::RpcPriority RpcHeader::priority() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.priority)
+  return _internal_priority();
+}
+inline void RpcHeader::_internal_set_priority(::Zrpc::RpcPriority value) {
+  
+  _impl_.priority_ = value;
+}
+inline void RpcHeader::set_priority(::Zrpc::RpcPriority value) {
+  _internal_set_priority(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.priority)
+}
+
+// -------------------------------------------------------------------
+
+// RpcResponseHeader
+
+// uint64 request_id = 1;
+inline void RpcResponseHeader::clear_request_id() {
+  _impl_.request_id_ = uint64_t{0u};
+}
+inline uint64_t RpcResponseHeader::_internal_request_id() const {
+  return _impl_.request_id_;
+}
+inline uint64_t RpcResponseHeader::request_id() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.request_id)
+  return _internal_request_id();
+}
+inline void RpcResponseHeader::_internal_set_request_id(uint64_t value) {
+  
+  _impl_.request_id_ = value;
+}
+inline void RpcResponseHeader::set_request_id(uint64_t value) {
+  _internal_set_request_id(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.request_id)
+}
+
+// uint32 body_size = 2;
+inline void RpcResponseHeader::clear_body_size() {
+  _impl_.body_size_ = 0u;
+}
+inline uint32_t RpcResponseHeader::_internal_body_size() const {
+  return _impl_.body_size_;
+}
+inline uint32_t RpcResponseHeader::body_size() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.body_size)
+  return _internal_body_size();
+}
+inline void RpcResponseHeader::_internal_set_body_size(uint32_t value) {
+  
+  _impl_.body_size_ = value;
+}
+inline void RpcResponseHeader::set_body_size(uint32_t value) {
+  _internal_set_body_size(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.body_size)
+}
+
+// .Zrpc.RpcErrorCode error_code = 3;
+inline void RpcResponseHeader::clear_error_code() {
+  _impl_.error_code_ = 0;
+}
+inline ::Zrpc::RpcErrorCode RpcResponseHeader::_internal_error_code() const {
+  return static_cast< ::Zrpc::RpcErrorCode >(_impl_.error_code_);
+}
+inline ::Zrpc::RpcErrorCode RpcResponseHeader::error_code() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.error_code)
+  return _internal_error_code();
+}
+inline void RpcResponseHeader::_internal_set_error_code(::Zrpc::RpcErrorCode value) {
+  
+  _impl_.error_code_ = value;
+}
+inline void RpcResponseHeader::set_error_code(::Zrpc::RpcErrorCode value) {
+  _internal_set_error_code(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.error_code)
+}
+
+// bytes error_text = 4;
+inline void RpcResponseHeader::clear_error_text() {
+  _impl_.error_text_.ClearToEmpty();
+}
+inline const std::string& RpcResponseHeader::error_text() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.error_text)
+  return _internal_error_text();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcResponseHeader::set_error_text(ArgT0&& arg0, ArgT... args) {
+ 
+ _impl_.error_text_.SetBytes(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.error_text)
+}
+inline std::string* RpcResponseHeader::mutable_error_text() {
+  std::string* _s = _internal_mutable_error_text();
+  // @@protoc_insertion_point(field_mutable:Zrpc.RpcResponseHeader.error_text)
+  return _s;
+}
+inline const std::string& RpcResponseHeader::_internal_error_text() const {
+  return _impl_.error_text_.Get();
+}
+inline void RpcResponseHeader::_internal_set_error_text(const std::string& value) {
+  
+  _impl_.error_text_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcResponseHeader::_internal_mutable_error_text() {
+  
+  return _impl_.error_text_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcResponseHeader::release_error_text() {
+  // @@protoc_insertion_point(field_release:Zrpc.RpcResponseHeader.error_text)
+  return _impl_.error_text_.Release();
+}
+inline void RpcResponseHeader::set_allocated_error_text(std::string* error_text) {
+  if (error_text != nullptr) {
     
   } else {
     
   }
-  method_name_.UnsafeArenaSetAllocated(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(),
-      method_name, GetArena());
-  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:Zrpc.RpcHeader.method_name)
+  _impl_.error_text_.SetAllocated(error_text, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.error_text_.IsDefault()) {
+    _impl_.error_text_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:Zrpc.RpcResponseHeader.error_text)
 }
 
-// uint32 args_size = 3;
-inline void RpcHeader::clear_args_size() {
-  args_size_ = 0u;
+// uint32 batch_count = 5;
+inline void RpcResponseHeader::clear_batch_count() {
+  _impl_.batch_count_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 RpcHeader::_internal_args_size() const {
-  return args_size_;
+inline uint32_t RpcResponseHeader::_internal_batch_count() const {
+  return _impl_.batch_count_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 RpcHeader::args_size() const {
-  // @@protoc_insertion_point(field_get:Zrpc.RpcHeader.args_size)
-  return _internal_args_size();
+inline uint32_t RpcResponseHeader::batch_count() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.batch_count)
+  return _internal_batch_count();
 }
-inline void RpcHeader::_internal_set_args_size(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void RpcResponseHeader::_internal_set_batch_count(uint32_t value) {
   
-  args_size_ = value;
+  _impl_.batch_count_ = value;
 }
-inline void RpcHeader::set_args_size(::PROTOBUF_NAMESPACE_ID::uint32 value) {
-  _internal_set_args_size(value);
-  // @@protoc_insertion_point(field_set:Zrpc.RpcHeader.args_size)
+inline void RpcResponseHeader::set_batch_count(uint32_t value) {
+  _internal_set_batch_count(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.batch_count)
+}
+
+// .Zrpc.CompressType compress_type = 6;
+inline void RpcResponseHeader::clear_compress_type() {
+  _impl_.compress_type_ = 0;
+}
+inline ::Zrpc::CompressType RpcResponseHeader::_internal_compress_type() const {
+  return static_cast< ::Zrpc::CompressType >(_impl_.compress_type_);
+}
+inline ::Zrpc::CompressType RpcResponseHeader::compress_type() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.compress_type)
+  return _internal_compress_type();
+}
+inline void RpcResponseHeader::_internal_set_compress_type(::Zrpc::CompressType value) {
+  
+  _impl_.compress_type_ = value;
+}
+inline void RpcResponseHeader::set_compress_type(::Zrpc::CompressType value) {
+  _internal_set_compress_type(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.compress_type)
+}
+
+// uint32 accept_compress = 7;
+inline void RpcResponseHeader::clear_accept_compress() {
+  _impl_.accept_compress_ = 0u;
+}
+inline uint32_t RpcResponseHeader::_internal_accept_compress() const {
+  return _impl_.accept_compress_;
+}
+inline uint32_t RpcResponseHeader::accept_compress() const {
+  // @@protoc_insertion_point(field_get:Zrpc.RpcResponseHeader.accept_compress)
+  return _internal_accept_compress();
+}
+inline void RpcResponseHeader::_internal_set_accept_compress(uint32_t value) {
+  
+  _impl_.accept_compress_ = value;
+}
+inline void RpcResponseHeader::set_accept_compress(uint32_t value) {
+  _internal_set_accept_compress(value);
+  // @@protoc_insertion_point(field_set:Zrpc.RpcResponseHeader.accept_compress)
 }
 
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
 }  // namespace Zrpc
 
+PROTOBUF_NAMESPACE_OPEN
+
+template <> struct is_proto_enum< ::Zrpc::CompressType> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::Zrpc::CompressType>() {
+  return ::Zrpc::CompressType_descriptor();
+}
+template <> struct is_proto_enum< ::Zrpc::RpcPriority> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::Zrpc::RpcPriority>() {
+  return ::Zrpc::RpcPriority_descriptor();
+}
+template <> struct is_proto_enum< ::Zrpc::RpcErrorCode> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::Zrpc::RpcErrorCode>() {
+  return ::Zrpc::RpcErrorCode_descriptor();
+}
+
+PROTOBUF_NAMESPACE_CLOSE
+
 // @@protoc_insertion_point(global_scope)
 
 #include <google/protobuf/port_undef.inc>
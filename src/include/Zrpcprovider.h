@@ -2,6 +2,15 @@
 #define _Zrpcprovider_H__
 #include "google/protobuf/service.h"
 #include "zookeeperutil.h"
+#include "Zrpcheader.pb.h"
+#include "ZrpcCompression.h"
+#include "ZrpcUnixServer.h"
+#include "ZrpcShmServer.h"
+#include "ZrpcUringServer.h"
+#include "ZrpcResponder.h"
+#include "ZrpcExecutor.h"
+#include "ZrpcCpuSet.h"
+#include "ZrpcCodel.h"
 #include<muduo/net/TcpServer.h>
 #include<muduo/net/EventLoop.h>
 #include<muduo/net/InetAddress.h>
@@ -10,6 +19,9 @@
 #include<functional>
 #include<string>
 #include<unordered_map>
+#include<memory>
+#include<vector>
+#include<mutex>
 /*
 框架提供的专门用于发布rpc服务对象的网络对象类
 */
@@ -25,19 +37,81 @@ public:
     // 新增：心跳相关功能
     void EnableHeartbeatResponse(bool enable = true);
     bool IsHeartbeatResponseEnabled() const;
+
+    // 新增：响应体压缩，method为空时作为所有方法的默认策略，否则只对该方法（"服务名.方法名"，如"UserServiceRpc.GetUserProfile"）生效
+    // 只对在请求头中声明支持该算法的调用方压缩；需要在Run之前设置
+    void SetCompression(Zrpc::CompressType type, uint32_t min_bytes = 1024, const std::string& method = "");
+
+    // 新增：方法的优先级（"服务名.方法名"），业务线程池按优先级分队列、按rpcpriorityweights的权重加权公平调度
+    // 调用方没有在Zrpccontroller上指定优先级时使用这里的设置，都没有设置时为PRIORITY_NORMAL；需要在Run之前设置
+    void SetMethodPriority(const std::string& method, Zrpc::RpcPriority priority);
     
 private:
     muduo::net::EventLoop event_loop;
+    ZrpcCpuSet m_io_cpus;      // IO线程绑核使用的CPU列表（rpciocpus），为空时不绑核
+    ZrpcCpuSet m_worker_cpus;  // 业务线程绑核使用的CPU列表（rpcworkercpus）
+    // 执行服务方法的业务线程池，rpcworkerthreads为0时为空，服务方法直接在IO线程上执行；
+    // 声明在各个服务端之前，析构时IO线程先停止，再执行完已提交的调用
+    std::unique_ptr<ZrpcExecutor> m_executor;
+    // 按排队时间的准入控制，每个优先级一个，各自统计排队时间；rpcqueuetargetms为0时为空
+    std::vector<std::unique_ptr<ZrpcCodel>> m_codels;
+    bool m_adaptive_lifo = false;        // 过载期间业务线程池改为后进先出
+    std::unique_ptr<ZrpcUnixServer> m_unix_server;  // 同一主机上的调用方通过Unix域套接字连接，与TCP共用IO线程和回调
+    std::unique_ptr<ZrpcShmServer> m_shm_server;    // 同一主机上的调用方也可以通过共享内存收发请求，会话分配在同样的IO线程上
+    std::unique_ptr<ZrpcUringServer> m_uring_server;  // rpcioengine为io_uring时代替muduo的TcpServer接受TCP连接
     struct ServiceInfo
     {
         google::protobuf::Service* service;
         std::unordered_map<std::string, const google::protobuf::MethodDescriptor*> method_map;
     };
     std::unordered_map<std::string, ServiceInfo>service_map;//保存服务对象和rpc方法
+
+    // 批量请求的响应汇总：各个调用的响应帧先收集起来，全部完成后合并为一个批量响应帧发送
+    // 服务方法可能在其他线程上执行done，所以需要加锁
+    struct BatchReply
+    {
+        std::mutex mutex;
+        std::string frames;
+        uint32_t count = 0;
+        uint32_t remaining = 0;//还没有完成的调用数
+    };
+
+    // 一次RPC调用的上下文，在响应发送后释放
+    struct RpcCall
+    {
+        uint64_t request_id;//请求序号，随响应原样返回
+        ZrpcResponderPtr responder;//响应的发送目标
+        google::protobuf::Message* request;
+        google::protobuf::Message* response;
+        std::shared_ptr<BatchReply> batch;//属于批量请求时非空
+        ZrpcCompressPolicy compress;//与调用方协商后的响应压缩策略
+        google::protobuf::Service* service;
+        const google::protobuf::MethodDescriptor* method;
+        muduo::Timestamp receive_time;//收到请求的时刻，执行前据此计算排队时间
+        uint32_t timeout_ms;//调用方剩余的时间预算，0表示不限
+        int priority_class;//优先级对应的业务线程池队列，0为PRIORITY_CRITICAL
+    };
     
     void OnConnection(const muduo::net::TcpConnectionPtr& conn);
     void OnMessage(const muduo::net::TcpConnectionPtr& conn, muduo::net::Buffer* buffer, muduo::Timestamp receive_time);
-    void SendRpcResponse(const muduo::net::TcpConnectionPtr& conn, google::protobuf::Message* response);
+    // 共享内存会话上收到一个请求帧，data直接指向共享内存
+    void OnShmFrame(const ZrpcShmSessionPtr& session, const char* data, size_t len, muduo::Timestamp receive_time);
+    // 处理一个完整的请求（单个调用或批量请求），与传输方式无关
+    // 批量请求的格式有误时返回false，其中的调用都无法应答，调用方应关闭连接
+    bool HandleRequest(const ZrpcResponderPtr& responder, const Zrpc::RpcHeader& header,
+                       const char* args, size_t args_size, muduo::Timestamp receive_time);
+    // 分发一个调用：在IO线程上查找服务和方法、反序列化请求（args只在回调期间有效），再交给业务线程池执行
+    void DispatchCall(const ZrpcResponderPtr& responder, const Zrpc::RpcHeader& header,
+                      const char* args, size_t args_size, muduo::Timestamp receive_time,
+                      const std::shared_ptr<BatchReply>& batch);
+    // 执行一个调用：按排队时间做准入控制、检查截止时间后执行服务方法，在业务线程（或没有业务线程池时在IO线程）上调用
+    void RunCall(RpcCall* call);
+    // 不执行服务方法，以error_code结束一个调用并释放
+    void DropCall(RpcCall* call, Zrpc::RpcErrorCode error_code, const std::string& error_text);
+    void SendRpcResponse(RpcCall* call);
+    void SendErrorResponse(const ZrpcResponderPtr& responder, uint64_t request_id, Zrpc::RpcErrorCode error_code, const std::string& error_text,
+                           const std::shared_ptr<BatchReply>& batch = nullptr);
+    void SendFrame(const ZrpcResponderPtr& responder, const std::string& frame, const std::shared_ptr<BatchReply>& batch);
     
     // 新增：心跳处理
     void HandleHeartbeat(const muduo::net::TcpConnectionPtr& conn);
@@ -45,6 +119,13 @@ private:
     
     // 新增：心跳响应开关
     bool m_heartbeat_response_enabled;
+
+    // 新增：响应体压缩策略
+    ZrpcCompressPolicy m_default_compress;
+    std::unordered_map<std::string, ZrpcCompressPolicy> m_method_compress;
+
+    // 新增：方法的优先级
+    std::unordered_map<std::string, Zrpc::RpcPriority> m_method_priority;
 };
 #endif 
 
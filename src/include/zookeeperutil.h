@@ -4,6 +4,7 @@
 #include<semaphore.h>
 #include<zookeeper/zookeeper.h>
 #include<string>
+#include<vector>
 
 //封装的zk客户端
 class ZkClient
@@ -17,6 +18,14 @@ public:
     void Create(const char* path,const char* data,int datalen,int state=0);
     //根据参数指定的znode节点路径，或者znode节点值
     std::string GetData(const char* path);
+    //删除节点（节点不存在视为成功）
+    bool Delete(const char* path);
+    //获取子节点列表并注册一次性watcher，子节点增减时ZooKeeper回调watcher
+    bool GetChildrenWatch(const char* path,watcher_fn watcher,void* watcher_ctx,std::vector<std::string>* children);
+    //异步获取子节点列表并注册watcher，结果通过completion回调（可在watcher回调中安全使用）
+    bool AsyncGetChildrenWatch(const char* path,watcher_fn watcher,void* watcher_ctx,strings_completion_t completion,const void* data);
+    //异步获取节点值，结果通过completion回调
+    bool AsyncGetData(const char* path,data_completion_t completion,const void* data);
 private:
     //Zk的客户端句柄
     zhandle_t* m_zhandle;
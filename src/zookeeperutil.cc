@@ -78,7 +78,7 @@ void ZkClient::Create(const char *path, const char *data, int datalen, int state
 
 // 获取ZooKeeper节点的数据
 std::string ZkClient::GetData(const char *path) {
-    char buf[64];  // 用于存储节点数据
+    char buf[512];  // 用于存储节点数据（实例属性中含有Unix域套接字路径和主机名）
     int bufferlen = sizeof(buf);
 
     // 获取指定节点的数据
@@ -87,7 +87,51 @@ std::string ZkClient::GetData(const char *path) {
         LOG(ERROR) << "zoo_get error";
         return "";  // 返回空字符串
     } else {  // 获取成功
-        return buf;  // 返回节点数据
+        return std::string(buf, bufferlen > 0 ? bufferlen : 0);  // zoo_get不会在末尾补'\0'，按返回的长度构造
     }
     return "";  // 默认返回空字符串
-}
\ No newline at end of file
+}
+
+// 删除节点
+bool ZkClient::Delete(const char *path) {
+    int flag = zoo_delete(m_zhandle, path, -1);  // version为-1表示不校验版本
+    if (flag != ZOK && flag != ZNONODE) {
+        LOG(ERROR) << "zoo_delete error... path:" << path << " flag:" << flag;
+        return false;
+    }
+    return true;
+}
+
+// 获取子节点列表并注册watcher
+bool ZkClient::GetChildrenWatch(const char *path, watcher_fn watcher, void *watcher_ctx, std::vector<std::string> *children) {
+    struct String_vector strings = {0, nullptr};
+    int flag = zoo_wget_children(m_zhandle, path, watcher, watcher_ctx, &strings);
+    if (flag != ZOK) {
+        LOG(ERROR) << "zoo_wget_children error... path:" << path << " flag:" << flag;
+        return false;
+    }
+    children->assign(strings.data, strings.data + strings.count);
+    deallocate_String_vector(&strings);
+    return true;
+}
+
+// 异步获取子节点列表并注册watcher
+bool ZkClient::AsyncGetChildrenWatch(const char *path, watcher_fn watcher, void *watcher_ctx,
+                                     strings_completion_t completion, const void *data) {
+    int flag = zoo_awget_children(m_zhandle, path, watcher, watcher_ctx, completion, data);
+    if (flag != ZOK) {
+        LOG(ERROR) << "zoo_awget_children error... path:" << path << " flag:" << flag;
+        return false;
+    }
+    return true;
+}
+
+// 异步获取节点数据
+bool ZkClient::AsyncGetData(const char *path, data_completion_t completion, const void *data) {
+    int flag = zoo_aget(m_zhandle, path, 0, completion, data);
+    if (flag != ZOK) {
+        LOG(ERROR) << "zoo_aget error... path:" << path << " flag:" << flag;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#include "ZrpcCodec.h"
+#include "Zrpcheader.pb.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 请求帧解码测试：不依赖ZooKeeper和muduo，检查ZrpcCodec::DecodeRequest在各种读取边界上的结果
+// 请求体用Zrpc::RpcResponseHeader充当，只需要一个能序列化的消息
+
+static int g_failures = 0;
+
+static void expect(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cout << "FAILED: " << what << std::endl;
+        g_failures++;
+    }
+}
+
+static Zrpc::RpcResponseHeader make_args(const std::string &text) {
+    Zrpc::RpcResponseHeader args;
+    args.set_error_text(text);
+    return args;
+}
+
+// 解出一个完整的帧并检查头部和请求体
+static int decode_and_check(const char *data, size_t len, uint64_t request_id, const std::string &text) {
+    Zrpc::RpcHeader header;
+    const char *body = nullptr;
+    int frame_len = ZrpcCodec::DecodeRequest(data, len, &header, &body);
+    if (frame_len <= 0) {
+        return frame_len;
+    }
+    Zrpc::RpcResponseHeader args;
+    bool ok = header.service_name() == "UserService" && header.method_name() == "Login" &&
+              header.request_id() == request_id && header.timeout_ms() == 500 &&
+              args.ParseFromArray(body, static_cast<int>(header.args_size())) && args.error_text() == text &&
+              body + header.args_size() == data + frame_len;
+    expect(ok, "frame " + std::to_string(request_id) + " decoded with its header and body");
+    return frame_len;
+}
+
+// 一次读取中的一个帧、多个帧，以及帧在任意位置被截断
+void decode_frames_test() {
+    std::vector<std::string> texts = {"first", std::string(300, 'b'), "", "last"};
+    std::string stream;
+    std::vector<size_t> frame_ends;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        expect(ZrpcCodec::EncodeRequest("UserService", "Login", i + 1, make_args(texts[i]), &stream, 500),
+               "encode frame " + std::to_string(i + 1));
+        frame_ends.push_back(stream.size());
+    }
+
+    // 多个帧拼接在一起时依次解出，每次恰好消耗一个帧
+    size_t offset = 0;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        int frame_len = decode_and_check(stream.data() + offset, stream.size() - offset, i + 1, texts[i]);
+        expect(frame_len > 0 && offset + frame_len == frame_ends[i], "frame " + std::to_string(i + 1) + " length");
+        if (frame_len <= 0) {
+            return;
+        }
+        offset += frame_len;
+    }
+    expect(offset == stream.size(), "all bytes consumed");
+
+    // 第一个帧的任意前缀（包括只有部分长度字段、部分头部、部分请求体）都是不完整的
+    Zrpc::RpcHeader header;
+    const char *body = nullptr;
+    for (size_t len = 0; len < frame_ends[0]; ++len) {
+        expect(ZrpcCodec::DecodeRequest(stream.data(), len, &header, &body) == 0,
+               "prefix of " + std::to_string(len) + " bytes is incomplete");
+    }
+    // 后面跟着下一个帧的一部分时，仍然只解出第一个帧
+    int frame_len = decode_and_check(stream.data(), frame_ends[0] + 3, 1, texts[0]);
+    expect(frame_len == static_cast<int>(frame_ends[0]), "trailing partial frame is left in the buffer");
+}
+
+static std::string varint(uint32_t value) {
+    std::string out;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+    return out;
+}
+
+// 格式错误的帧返回-1，调用方据此关闭连接，而不是一直等待更多数据
+void malformed_frames_test() {
+    Zrpc::RpcHeader header;
+    const char *body = nullptr;
+
+    // 头部长度的varint超过5个字节
+    std::string overlong(6, static_cast<char>(0x80));
+    expect(ZrpcCodec::DecodeRequest(overlong.data(), overlong.size(), &header, &body) == -1, "overlong varint is rejected");
+
+    // 头部长度超过帧的上限：不等待收全，直接拒绝
+    std::string huge = varint(ZrpcCodec::kMaxFrameSize + 1);
+    expect(ZrpcCodec::DecodeRequest(huge.data(), huge.size(), &header, &body) == -1, "oversized header is rejected");
+
+    // 头部不是合法的protobuf
+    std::string garbage = varint(4) + std::string(4, static_cast<char>(0xFF));
+    expect(ZrpcCodec::DecodeRequest(garbage.data(), garbage.size(), &header, &body) == -1, "unparsable header is rejected");
+
+    // 请求体长度超过帧的上限
+    Zrpc::RpcHeader big;
+    big.set_service_name("UserService");
+    big.set_method_name("Login");
+    big.set_args_size(ZrpcCodec::kMaxFrameSize + 1);
+    std::string serialized = big.SerializeAsString();
+    std::string frame = varint(static_cast<uint32_t>(serialized.size())) + serialized;
+    expect(ZrpcCodec::DecodeRequest(frame.data(), frame.size(), &header, &body) == -1, "oversized body is rejected");
+}
+
+int main() {
+    std::cout << "开始请求帧解码测试..." << std::endl;
+    decode_frames_test();
+    malformed_frames_test();
+
+    if (g_failures != 0) {
+        std::cout << "请求帧解码测试失败: " << g_failures << std::endl;
+        return 1;
+    }
+    std::cout << "请求帧解码测试通过" << std::endl;
+    return 0;
+}
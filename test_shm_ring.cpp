@@ -0,0 +1,239 @@
+#include "ZrpcShmRing.h"
+#include "ZrpcUnixSocket.h"
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 共享内存环测试：不依赖ZooKeeper和muduo
+// 环本身直接在进程内的内存上测试；拆分超长帧（kFlagMore）和重新拼接经过ZrpcShmLink，两端在同一进程中通过Unix域套接字握手
+
+static int g_failures = 0;
+
+static void expect(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cout << "FAILED: " << what << std::endl;
+        g_failures++;
+    }
+}
+
+// 进程内的一个环：生产者和消费者各自持有一个ZrpcShmRing，共用控制块和数据区
+struct LocalRing
+{
+    static constexpr uint32_t kCapacity = 4096;
+
+    LocalRing() : data(kCapacity) {
+        control.tail.store(0);
+        control.producer_waiting.store(0);
+        control.head.store(0);
+        control.consumer_waiting.store(0);
+        producer.Init(&control, data.data(), kCapacity);
+        consumer.Init(&control, data.data(), kCapacity);
+    }
+
+    ZrpcShmRing::Control control;
+    std::vector<char> data;
+    ZrpcShmRing producer;
+    ZrpcShmRing consumer;
+};
+
+static bool write_record(ZrpcShmRing *ring, size_t len, char fill, uint32_t flags = 0) {
+    char *target = ring->BeginWrite(len);
+    if (target == nullptr) {
+        return false;
+    }
+    memset(target, fill, len);
+    ring->EndWrite(flags);
+    return true;
+}
+
+static bool read_record(ZrpcShmRing *ring, size_t len, char fill, const char **where = nullptr) {
+    const char *data = nullptr;
+    size_t got = 0;
+    uint32_t flags = 0;
+    if (ring->Peek(&data, &got, &flags) != 1 || got != len) {
+        return false;
+    }
+    for (size_t i = 0; i < got; ++i) {
+        if (data[i] != fill) {
+            return false;
+        }
+    }
+    if (where != nullptr) {
+        *where = data;
+    }
+    ring->Consume();
+    return true;
+}
+
+// 环尾放不下一条记录时写填充记录，记录从环首开始，内容连续且完整
+void padding_wrap_test() {
+    LocalRing ring;
+    for (char fill = 'a'; fill < 'd'; ++fill) {
+        expect(write_record(&ring.producer, 1000, fill), "write record before wrap");
+        expect(read_record(&ring.consumer, 1000, fill), "read record before wrap");
+    }
+
+    // 前3条记录各占1008字节，环尾只剩1072字节，1500字节的记录要从环首开始
+    const char *where = nullptr;
+    expect(write_record(&ring.producer, 1500, 'x'), "write record that wraps");
+    expect(read_record(&ring.consumer, 1500, 'x', &where), "read record that wraps");
+    expect(where == ring.data.data() + 8, "wrapped record starts at the beginning of the ring");
+    expect(ring.control.head.load() == LocalRing::kCapacity + 1512, "padding and record released together");
+
+    // 填满环：没有空间时BeginWrite失败，生产者登记等待，消费者释放记录后需要敲门铃
+    int written = 0;
+    while (write_record(&ring.producer, 1000, 'y')) {
+        written++;
+    }
+    expect(written > 0, "ring accepts records after wrap");
+    expect(ring.producer.ArmProducer(1000), "producer waits on a full ring");
+    const char *data = nullptr;
+    size_t len = 0;
+    uint32_t flags = 0;
+    expect(ring.consumer.Peek(&data, &len, &flags) == 1 && len == 1000, "read from a full ring");
+    expect(ring.consumer.Consume(), "consume wakes the waiting producer");
+    expect(!ring.consumer.Consume(), "producer is woken only once");
+    expect(write_record(&ring.producer, 1000, 'z'), "write after the consumer made room");
+}
+
+// 对端改坏了共享内存中的读写位置或记录头时，两端都不越界访问
+void corrupted_control_test() {
+    {
+        // tail超出head一个环以上：消费者拒绝
+        LocalRing ring;
+        expect(write_record(&ring.producer, 100, 'a'), "write record");
+        ring.control.tail.store(LocalRing::kCapacity + 8);
+        const char *data = nullptr;
+        size_t len = 0;
+        uint32_t flags = 0;
+        expect(ring.consumer.Peek(&data, &len, &flags) == -1, "tail beyond one ring is rejected");
+    }
+    {
+        // head超过了tail：生产者不再写入
+        LocalRing ring;
+        ring.control.head.store(64);
+        expect(ring.producer.BeginWrite(100) == nullptr, "head beyond tail stops the producer");
+        ring.control.head.store(0);
+        expect(ring.producer.BeginWrite(100) != nullptr, "producer writes again with a sane head");
+    }
+    {
+        // 记录头中的长度超过单条记录的上限
+        LocalRing ring;
+        expect(write_record(&ring.producer, 100, 'a'), "write record");
+        uint32_t length = static_cast<uint32_t>(ring.producer.MaxRecordSize() + 1);
+        memcpy(ring.data.data(), &length, sizeof(length));
+        const char *data = nullptr;
+        size_t len = 0;
+        uint32_t flags = 0;
+        expect(ring.consumer.Peek(&data, &len, &flags) == -1, "oversized record length is rejected");
+    }
+    {
+        // 记录超出了已发布的范围
+        LocalRing ring;
+        expect(write_record(&ring.producer, 100, 'a'), "write record");
+        uint32_t length = 200;
+        memcpy(ring.data.data(), &length, sizeof(length));
+        const char *data = nullptr;
+        size_t len = 0;
+        uint32_t flags = 0;
+        expect(ring.consumer.Peek(&data, &len, &flags) == -1, "record beyond tail is rejected");
+    }
+    {
+        // 填充记录跳过的位置超出了已发布的范围
+        LocalRing ring;
+        expect(write_record(&ring.producer, 100, 'a', ZrpcShmRing::kFlagPadding), "write padding record");
+        const char *data = nullptr;
+        size_t len = 0;
+        uint32_t flags = 0;
+        expect(ring.consumer.Peek(&data, &len, &flags) == -1, "padding beyond tail is rejected");
+        expect(ring.control.head.load() == 0, "rejected padding does not release space to the producer");
+    }
+}
+
+static std::string make_frame(size_t len, int seed) {
+    std::string frame(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        frame[i] = static_cast<char>((i * 31 + seed) & 0xFF);
+    }
+    return frame;
+}
+
+// 超过单条记录上限（以及超过整个环）的帧拆成带kFlagMore的多条记录，对端按顺序拼接成完整的帧
+void flag_more_reassembly_test() {
+    std::string path = "/tmp/zrpc_test_shm_" + std::to_string(getpid()) + ".sock";
+    int listenfd = ZrpcUnixSocket::Listen(path);
+    expect(listenfd >= 0, "listen on unix socket");
+    if (listenfd < 0) {
+        return;
+    }
+
+    // 服务端在另一个线程上接受连接并完成握手
+    std::unique_ptr<ZrpcShmLink> server;
+    int server_fd = -1;
+    std::thread acceptor([&] {
+        struct pollfd pfd;
+        pfd.fd = listenfd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 1000) > 0) {
+            server_fd = accept(listenfd, nullptr, nullptr);
+            if (server_fd >= 0) {
+                server = ZrpcShmLink::Accept(server_fd);
+            }
+        }
+    });
+    int client_fd = -1;
+    std::unique_ptr<ZrpcShmLink> client = ZrpcShmLink::Connect(path, 4096, 1000, &client_fd);
+    acceptor.join();
+    expect(client != nullptr && server != nullptr, "shared memory handshake");
+
+    if (client && server) {
+        // 大帧之后的小帧不能插队
+        std::vector<std::string> frames = {make_frame(10000, 1), make_frame(100, 2), make_frame(5000, 3)};
+        for (const std::string &frame : frames) {
+            expect(client->SendFrame(frame), "send frame of " + std::to_string(frame.size()) + " bytes");
+        }
+
+        std::vector<std::string> received;
+        auto on_frame = [&received](const char *data, size_t len) { received.emplace_back(data, len); };
+        auto ignore = [](const char *, size_t) {};
+        // 两端交替处理：服务端收取记录腾出空间，调用方继续把溢出队列写入环
+        for (int round = 0; round < 100 && received.size() < frames.size(); ++round) {
+            expect(server->Poll(on_frame), "server poll");
+            expect(client->Poll(ignore), "client poll");
+        }
+        expect(received.size() == frames.size(), "all frames received");
+        for (size_t i = 0; i < frames.size() && i < received.size(); ++i) {
+            expect(received[i] == frames[i], "frame " + std::to_string(i) + " reassembled in order");
+        }
+    }
+
+    client.reset();
+    server.reset();
+    if (client_fd >= 0) {
+        close(client_fd);
+    }
+    if (server_fd >= 0) {
+        close(server_fd);
+    }
+    close(listenfd);
+    unlink(path.c_str());
+}
+
+int main() {
+    std::cout << "开始共享内存环测试..." << std::endl;
+    padding_wrap_test();
+    corrupted_control_test();
+    flag_more_reassembly_test();
+
+    if (g_failures != 0) {
+        std::cout << "共享内存环测试失败: " << g_failures << std::endl;
+        return 1;
+    }
+    std::cout << "共享内存环测试通过" << std::endl;
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "ZrpcTimerWheel.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 分层时间轮测试：不依赖ZooKeeper和muduo，直接驱动ZrpcTimerWheel
+// 定时器在添加时向上取整到下一个tick，因此检查时允许1毫秒的误差
+
+static int g_failures = 0;
+
+static void expect(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cout << "FAILED: " << what << std::endl;
+        g_failures++;
+    }
+}
+
+static void run(std::vector<ZrpcTimerWheel::Callback> *expired) {
+    for (auto &cb : *expired) {
+        cb();
+    }
+    expired->clear();
+}
+
+// 跨层的定时器：第0层内、第1层、第2层、第3层以及超出时间轮范围的定时器都在到期的那个tick前后触发
+void cascade_test() {
+    ZrpcTimerWheel wheel;
+    auto origin = std::chrono::steady_clock::now();
+    const int64_t delays[] = {1, 255, 256, 257, 300, 16383, 16384, 16385, 20000, (int64_t(1) << 20) + 7,
+                              (int64_t(1) << 26) - 2, (int64_t(1) << 26) + 5000};
+    const size_t count = sizeof(delays) / sizeof(delays[0]);
+    std::vector<int> fired(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        wheel.Add(origin + std::chrono::milliseconds(delays[i]), [&fired, i] { fired[i]++; });
+    }
+    expect(wheel.Size() == count, "all timers pending after add");
+
+    std::vector<ZrpcTimerWheel::Callback> expired;
+    for (size_t i = 0; i < count; ++i) {
+        // 到期前1毫秒还没有触发
+        wheel.Advance(origin + std::chrono::milliseconds(delays[i] - 1), &expired);
+        run(&expired);
+        expect(fired[i] == 0, "timer " + std::to_string(delays[i]) + "ms not fired early");
+        // 到期后1毫秒内触发，且只触发一次
+        wheel.Advance(origin + std::chrono::milliseconds(delays[i] + 1), &expired);
+        run(&expired);
+        expect(fired[i] == 1, "timer " + std::to_string(delays[i]) + "ms fired once on time");
+        for (size_t j = i + 1; j < count; ++j) {
+            expect(fired[j] == 0, "timer " + std::to_string(delays[j]) + "ms not fired by earlier advance");
+        }
+    }
+    expect(wheel.Size() == 0, "no timers pending after all fired");
+}
+
+// 到期处理期间的取消：回调在锁外执行，可以取消其他定时器，也可以添加新的定时器
+void cancel_during_expiry_test() {
+    ZrpcTimerWheel wheel;
+    auto origin = std::chrono::steady_clock::now();
+    int fired_a = 0, fired_b = 0, fired_c = 0, fired_d = 0, fired_e = 0;
+    bool cancel_b = true, cancel_c = false;
+
+    // a和b在同一个tick到期：a执行时b已经被一起取出，取消失败，b仍会执行
+    // c在更晚的槽（第1层）中，a执行时可以取消成功，之后不再触发
+    ZrpcTimerWheel::TimerId b = 0, c = 0;
+    ZrpcTimerWheel::TimerId a = wheel.Add(origin + std::chrono::milliseconds(10), [&] {
+        fired_a++;
+        cancel_b = wheel.Cancel(b);
+        cancel_c = wheel.Cancel(c);
+        // 回调中添加一个已经过期的定时器，在下一次推进时触发
+        wheel.Add(origin, [&fired_e] { fired_e++; });
+    });
+    b = wheel.Add(origin + std::chrono::milliseconds(10), [&fired_b] { fired_b++; });
+    c = wheel.Add(origin + std::chrono::milliseconds(1000), [&fired_c] { fired_c++; });
+
+    std::vector<ZrpcTimerWheel::Callback> expired;
+    wheel.Advance(origin + std::chrono::milliseconds(11), &expired);
+    expect(expired.size() == 2, "both timers of the same tick expired together");
+    run(&expired);
+    expect(fired_a == 1 && fired_b == 1, "timers of the same tick both fired");
+    expect(!cancel_b, "cancel of an expired timer fails");
+    expect(cancel_c, "cancel of a later timer from a callback succeeds");
+    expect(!wheel.Cancel(a), "cancel after expiry fails");
+
+    // 已经释放的节点被复用后，旧的TimerId不能取消新的定时器
+    ZrpcTimerWheel::TimerId d = wheel.Add(origin + std::chrono::milliseconds(20), [&fired_d] { fired_d++; });
+    expect(d != a && d != b, "reused node gets a new timer id");
+    expect(!wheel.Cancel(a) && !wheel.Cancel(b), "stale timer ids do not cancel reused nodes");
+
+    wheel.Advance(origin + std::chrono::milliseconds(2000), &expired);
+    run(&expired);
+    expect(fired_c == 0, "canceled timer never fires");
+    expect(fired_d == 1, "timer on a reused node fires");
+    expect(fired_e == 1, "timer added during expiry fires on the next advance");
+    expect(wheel.Size() == 0, "no timers pending");
+}
+
+// 推进和取消并发：每个定时器要么触发，要么被取消，恰好一次
+void concurrent_cancel_test() {
+    ZrpcTimerWheel wheel;
+    auto origin = std::chrono::steady_clock::now();
+    const int num_timers = 20000;
+    std::atomic<int> fired(0);
+    std::vector<ZrpcTimerWheel::TimerId> ids;
+    for (int i = 0; i < num_timers; ++i) {
+        ids.push_back(wheel.Add(origin + std::chrono::milliseconds(1 + i % 2000), [&fired] { fired++; }));
+    }
+
+    std::atomic<int> canceled(0);
+    std::thread canceler([&] {
+        for (int i = num_timers - 1; i >= 0; i -= 2) {
+            if (wheel.Cancel(ids[i])) {
+                canceled++;
+            }
+        }
+    });
+    std::vector<ZrpcTimerWheel::Callback> expired;
+    for (int ms = 0; ms <= 2001; ++ms) {
+        wheel.Advance(origin + std::chrono::milliseconds(ms), &expired);
+        run(&expired);
+    }
+    canceler.join();
+    wheel.Advance(origin + std::chrono::milliseconds(2002), &expired);
+    run(&expired);
+
+    expect(fired + canceled == num_timers, "every timer either fired or was canceled");
+    expect(wheel.Size() == 0, "no timers pending");
+}
+
+int main() {
+    std::cout << "开始时间轮测试..." << std::endl;
+    cascade_test();
+    cancel_during_expiry_test();
+    concurrent_cancel_test();
+
+    if (g_failures != 0) {
+        std::cout << "时间轮测试失败: " << g_failures << std::endl;
+        return 1;
+    }
+    std::cout << "时间轮测试通过" << std::endl;
+    return 0;
+}